@@ -0,0 +1,15 @@
+#ifndef RAPID_TRADER_ALLOCATION_COUNTER_H
+#define RAPID_TRADER_ALLOCATION_COUNTER_H
+#include <cstdint>
+
+/**
+ * @return the number of calls to the global operator new made by any thread so far.
+ */
+uint64_t allocationCount();
+
+/**
+ * @return the number of bytes of heap memory in use, including memory that was not allocated
+ *         through operator new.
+ */
+uint64_t heapBytesInUse();
+#endif // RAPID_TRADER_ALLOCATION_COUNTER_H
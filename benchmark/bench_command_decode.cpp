@@ -0,0 +1,122 @@
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "matching/market/binary_command.h"
+#include "convert_commands.h"
+#include "generate_orders.h"
+#include "allocation_counter.h"
+
+using namespace RapidTrader;
+using json = nlohmann::json;
+
+// The number of orders whose commands are decoded per benchmark iteration.
+constexpr uint32_t NUM_ORDERS = 100000;
+
+struct Commands
+{
+    std::vector<std::string> json_commands;
+    std::vector<char> binary_commands;
+};
+
+/**
+ * @return the JSON commands that add generated orders and cancel half of them, and the same
+ *         commands converted to the binary format.
+ */
+static const Commands &commands()
+{
+    static Commands *generated = [] {
+        std::vector<Order> orders;
+        generateOrders(orders, NUM_ORDERS, 100);
+        auto *commands = new Commands;
+        commands->json_commands = generateJsonCommands(orders);
+        commands->binary_commands.resize(commands->json_commands.size() * BINARY_COMMAND_SIZE);
+        for (size_t i = 0; i < commands->json_commands.size(); ++i)
+        {
+            BinaryCommand command;
+            if (!convertCommand(commands->json_commands[i], command))
+            {
+                std::cerr << "Failed to convert: " << commands->json_commands[i] << std::endl;
+                std::abort();
+            }
+            command.encode(commands->binary_commands.data() + i * BINARY_COMMAND_SIZE);
+        }
+        return commands;
+    }();
+    return *generated;
+}
+
+// Decodes a command as exchange_main decoded every command before the binary format.
+static void BM_DecodeJson(benchmark::State &state)
+{
+    const Commands &generated = commands();
+    uint64_t allocations_before = allocationCount();
+    for (auto _ : state)
+    {
+        for (const auto &command : generated.json_commands)
+        {
+            std::string payload_str(command.data(), command.size());
+            json j = json::parse(payload_str);
+            std::string operation = j.value("operation", "");
+            json payload = j.value("payload", json::object());
+            if (operation == "ADD_ORDER")
+            {
+                Order order = payload["order_side"] == "buy"
+                                  ? Order::limitBidOrder(payload["order_id"], std::stoull(payload["instrument_id"].get<std::string>()),
+                                        std::stoull(payload["price"].get<std::string>()),
+                                        std::stoull(payload["quantity_ordered"].get<std::string>()), OrderTimeInForce::GTC)
+                                  : Order::limitAskOrder(payload["order_id"], std::stoull(payload["instrument_id"].get<std::string>()),
+                                        std::stoull(payload["price"].get<std::string>()),
+                                        std::stoull(payload["quantity_ordered"].get<std::string>()), OrderTimeInForce::GTC);
+                benchmark::DoNotOptimize(order);
+            }
+            else
+            {
+                uint64_t order_id = payload["order_id"];
+                uint32_t symbol_id = payload["instrument_id"];
+                benchmark::DoNotOptimize(order_id);
+                benchmark::DoNotOptimize(symbol_id);
+            }
+        }
+    }
+    uint64_t num_commands = state.iterations() * generated.json_commands.size();
+    state.counters["allocs_per_command"] = static_cast<double>(allocationCount() - allocations_before) / static_cast<double>(num_commands);
+    state.SetItemsProcessed(static_cast<int64_t>(num_commands));
+}
+
+static void BM_DecodeBinary(benchmark::State &state)
+{
+    const Commands &generated = commands();
+    uint64_t allocations_before = allocationCount();
+    for (auto _ : state)
+    {
+        for (size_t offset = 0; offset < generated.binary_commands.size(); offset += BINARY_COMMAND_SIZE)
+        {
+            const char *data = generated.binary_commands.data() + offset;
+            BinaryCommand command;
+            if (!BinaryCommand::isBinary(data, BINARY_COMMAND_SIZE) || !BinaryCommand::decode(data, BINARY_COMMAND_SIZE, command))
+                std::abort();
+            if (command.operation == BinaryOperation::AddOrder)
+            {
+                Order order = command.side == OrderSide::Bid
+                                  ? Order::limitBidOrder(command.order_id, command.symbol_id, command.price, command.quantity, command.time_in_force)
+                                  : Order::limitAskOrder(command.order_id, command.symbol_id, command.price, command.quantity, command.time_in_force);
+                benchmark::DoNotOptimize(order);
+            }
+            else
+            {
+                benchmark::DoNotOptimize(command.order_id);
+                benchmark::DoNotOptimize(command.symbol_id);
+            }
+        }
+    }
+    uint64_t num_commands = state.iterations() * (generated.binary_commands.size() / BINARY_COMMAND_SIZE);
+    state.counters["allocs_per_command"] = static_cast<double>(allocationCount() - allocations_before) / static_cast<double>(num_commands);
+    state.SetItemsProcessed(static_cast<int64_t>(num_commands));
+}
+
+BENCHMARK(BM_DecodeJson)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DecodeBinary)->Unit(benchmark::kMillisecond);
+BENCHMARK_MAIN();
@@ -1,9 +1,10 @@
 #include <benchmark/benchmark.h>
 #include <iostream>
 #include <vector>
-#include "generate_orders.h"
 #include "market/concurrent_market.h"
 #include "event_handler/event_handler.h"
+#include "generate_orders.h"
+#include "allocation_counter.h"
 
 using namespace RapidTrader;
 
@@ -12,6 +13,7 @@ static void BM_ConcurrentMarket(benchmark::State &state)
     const uint64_t num_symbols = state.range(0);
     const uint64_t num_orders = state.range(1);
     const uint8_t num_threads = 3;
+    uint64_t allocations = 0;
     std::vector<Order> orders;
     orders.reserve(num_orders);
     generateOrders(orders, num_orders, num_symbols);
@@ -19,18 +21,23 @@ static void BM_ConcurrentMarket(benchmark::State &state)
     {
         // Add all the symbols before adding any orders.
         state.PauseTiming();
-        std::vector<std::unique_ptr<EventHandler>> event_handlers;
+        std::vector<std::unique_ptr<NullEventHandler>> event_handlers;
         event_handlers.reserve(num_threads);
         for (int i = 0; i < num_threads; ++i)
-            event_handlers.push_back(std::make_unique<EventHandler>());
+            event_handlers.push_back(std::make_unique<NullEventHandler>());
         ConcurrentMarket market{event_handlers, num_threads};
         for (int i = 1; i <= num_symbols; ++i)
             market.addSymbol(i, "MARKET BENCH");
+        uint64_t allocations_before = allocationCount();
         state.ResumeTiming();
         // Add all the orders.
         for (const auto &order : orders)
             market.addOrder(order);
+        state.PauseTiming();
+        allocations += allocationCount() - allocations_before;
+        state.ResumeTiming();
     }
+    state.counters["allocs_per_order"] = static_cast<double>(allocations) / static_cast<double>(state.iterations() * num_orders);
 }
 
 BENCHMARK(BM_ConcurrentMarket)
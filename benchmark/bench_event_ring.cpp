@@ -0,0 +1,134 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "market/market.h"
+#include "event_handler/async_event_handler.h"
+#include "generate_orders.h"
+
+using namespace RapidTrader;
+
+// The number of orders submitted per benchmark iteration.
+constexpr uint32_t NUM_ORDERS = 200000;
+// The number of symbols the orders are spread across.
+constexpr uint32_t NUM_SYMBOLS = 10;
+
+/**
+ * Stands in for a handler that serializes each event and hands it to a message broker,
+ * by formatting every order event into a fresh string.
+ */
+class SerializingEventHandler : public EventHandler
+{
+public:
+    size_t bytes = 0;
+
+protected:
+    [[nodiscard]] bool handlesTrades() const override
+    {
+        return true;
+    }
+
+    void handleOrderAdded(const OrderAdded &event) override
+    {
+        serialize("OrderAdded", event.order);
+    }
+
+    void handleOrderDeleted(const OrderDeleted &event) override
+    {
+        serialize("OrderDeleted", event.order);
+    }
+
+    void handleOrderUpdated(const OrderUpdated &event) override
+    {
+        serialize("OrderUpdated", event.order);
+    }
+
+    void handleOrderExecuted(const ExecutedOrder &event) override
+    {
+        serialize("ExecutedOrder", event.order);
+    }
+
+    void handleTrade(const Trade &event) override
+    {
+        std::string payload = std::string{"{\"event_type\":\"Trade\",\"data\":{\"aggressor_id\":"} + std::to_string(event.aggressor_id) +
+            ",\"passive_id\":" + std::to_string(event.passive_id) + ",\"price\":" + std::to_string(event.price) +
+            ",\"quantity\":" + std::to_string(event.quantity) + "}}";
+        bytes += payload.size();
+    }
+
+private:
+    void serialize(const char *event_type, const Order &order)
+    {
+        std::string payload = std::string{"{\"event_type\":\""} + event_type + "\",\"data\":{\"order_id\":" +
+            std::to_string(order.getOrderID()) + ",\"price\":" + std::to_string(order.getPrice()) +
+            ",\"open_quantity\":" + std::to_string(order.getOpenQuantity()) + "}}";
+        bytes += payload.size();
+    }
+};
+
+/**
+ * Submits orders to a market, timing each submission on the matching thread. With an
+ * asynchronous handler the events are serialized on the publisher thread, and the time
+ * to drain the ring afterwards is not counted. Reports the median and 99.9th percentile
+ * submission latency in nanoseconds.
+ */
+template<bool Async>
+static void BM_EventPublishing(benchmark::State &state)
+{
+    std::vector<Order> orders;
+    orders.reserve(NUM_ORDERS);
+    generateOrders(orders, NUM_ORDERS, NUM_SYMBOLS);
+    std::vector<double> latencies(NUM_ORDERS);
+    EventRingConfig config;
+    config.full_ring_policy = static_cast<FullRingPolicy>(state.range(0));
+    uint64_t overflowed_events = 0;
+    uint64_t shed_events = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::unique_ptr<Market> market;
+        AsyncEventHandler *async_handler = nullptr;
+        if constexpr (Async)
+        {
+            auto event_handler = std::make_unique<AsyncEventHandler>(std::make_unique<SerializingEventHandler>(), config);
+            async_handler = event_handler.get();
+            market = std::make_unique<Market>(std::move(event_handler));
+        }
+        else
+        {
+            market = std::make_unique<Market>(std::make_unique<SerializingEventHandler>());
+        }
+        for (uint32_t symbol_id = 1; symbol_id <= NUM_SYMBOLS; ++symbol_id)
+            market->addSymbol(symbol_id, "EVENT RING BENCH");
+        state.ResumeTiming();
+        for (uint32_t i = 0; i < NUM_ORDERS; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            market->addOrder(orders[i]);
+            auto end = std::chrono::steady_clock::now();
+            latencies[i] = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        }
+        state.PauseTiming();
+        if constexpr (Async)
+        {
+            async_handler->flush();
+            EventRingMetrics metrics = async_handler->getMetrics();
+            overflowed_events += metrics.overflowed_events;
+            shed_events += metrics.shed_events;
+        }
+        market.reset();
+        state.ResumeTiming();
+    }
+    std::sort(latencies.begin(), latencies.end());
+    state.counters["p50_ns"] = latencies[NUM_ORDERS / 2];
+    state.counters["p99.9_ns"] = latencies[NUM_ORDERS - 1 - NUM_ORDERS / 1000];
+    state.counters["overflowed_per_iter"] = static_cast<double>(overflowed_events) / static_cast<double>(state.iterations());
+    state.counters["shed_per_iter"] = static_cast<double>(shed_events) / static_cast<double>(state.iterations());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * NUM_ORDERS));
+}
+
+BENCHMARK_TEMPLATE(BM_EventPublishing, false)->Arg(0)->ArgNames({"policy"})->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_EventPublishing, true)->DenseRange(0, 2)->ArgNames({"policy"})->Unit(benchmark::kMillisecond);
+BENCHMARK_MAIN();
@@ -0,0 +1,220 @@
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "market/market.h"
+#include "event_handler/event_serializer.h"
+#include "generate_orders.h"
+#include "allocation_counter.h"
+
+using namespace RapidTrader;
+using json = nlohmann::json;
+
+// The number of orders whose events are serialized per benchmark iteration.
+constexpr uint32_t NUM_ORDERS = 100000;
+
+/**
+ * Collects the order events and trades raised by a market, so that they can be serialized
+ * repeatedly without matching.
+ */
+class CollectingEventHandler : public EventHandler
+{
+public:
+    std::vector<std::pair<EventType, Order>> order_events;
+    std::vector<Trade> trades;
+
+protected:
+    [[nodiscard]] bool handlesTrades() const override
+    {
+        return true;
+    }
+
+    void handleOrderAdded(const OrderAdded &event) override
+    {
+        order_events.emplace_back(EventType::OrderAdded, event.order);
+    }
+
+    void handleOrderDeleted(const OrderDeleted &event) override
+    {
+        order_events.emplace_back(EventType::OrderDeleted, event.order);
+    }
+
+    void handleOrderUpdated(const OrderUpdated &event) override
+    {
+        order_events.emplace_back(EventType::OrderUpdated, event.order);
+    }
+
+    void handleOrderExecuted(const ExecutedOrder &event) override
+    {
+        order_events.emplace_back(EventType::OrderExecuted, event.order);
+    }
+
+    void handleTrade(const Trade &event) override
+    {
+        trades.push_back(event);
+    }
+};
+
+// The serialization that the Kafka event handler used before EventSerializer.
+static json orderToJson(const Order &order)
+{
+    json j;
+    j["order_id"] = order.getOrderID();
+    j["symbol_id"] = order.getSymbolID();
+    j["price"] = order.getPrice();
+    j["quantity"] = order.getQuantity();
+    j["open_quantity"] = order.getOpenQuantity();
+    j["executed_quantity"] = order.getExecutedQuantity();
+    j["last_executed_price"] = order.getLastExecutedPrice();
+    j["last_executed_quantity"] = order.getLastExecutedQuantity();
+    j["side"] = order.isBid() ? "Bid" : "Ask";
+    switch (order.getType())
+    {
+    case OrderType::Limit: j["type"] = "Limit"; break;
+    case OrderType::Market: j["type"] = "Market"; break;
+    case OrderType::Stop: j["type"] = "Stop"; break;
+    case OrderType::StopLimit: j["type"] = "StopLimit"; break;
+    case OrderType::TrailingStop: j["type"] = "TrailingStop"; break;
+    case OrderType::TrailingStopLimit: j["type"] = "TrailingStopLimit"; break;
+    default: j["type"] = "Unknown"; break;
+    }
+    return j;
+}
+
+static std::string jsonEvent(EventType type, const Order &order)
+{
+    static const char *names[] = {"OrderAdded", "OrderDeleted", "OrderUpdated", "ExecutedOrder"};
+    json j_event;
+    j_event["event_type"] = names[static_cast<int>(type)];
+    j_event["data"] = orderToJson(order);
+    return j_event.dump();
+}
+
+static std::string jsonEvent(const Trade &event)
+{
+    json j_event;
+    j_event["event_type"] = "Trade";
+    json j;
+    j["symbol_id"] = event.symbol_id;
+    j["trade_seq"] = event.trade_seq;
+    j["aggressor_id"] = event.aggressor_id;
+    j["passive_id"] = event.passive_id;
+    j["price"] = event.price;
+    j["quantity"] = event.quantity;
+    j["aggressor_open_quantity"] = event.aggressor_open_quantity;
+    j["passive_open_quantity"] = event.passive_open_quantity;
+    j["aggressor_side"] = event.aggressor_side == OrderSide::Bid ? "Bid" : "Ask";
+    j_event["data"] = j;
+    return j_event.dump();
+}
+
+static std::string_view serialize(EventSerializer &serializer, EventType type, const Order &order)
+{
+    switch (type)
+    {
+    case EventType::OrderAdded:
+        return serializer.serialize(OrderAdded{order});
+    case EventType::OrderDeleted:
+        return serializer.serialize(OrderDeleted{order});
+    case EventType::OrderUpdated:
+        return serializer.serialize(OrderUpdated{order});
+    default:
+        return serializer.serialize(ExecutedOrder{order});
+    }
+}
+
+/**
+ * @return the events raised by a market that matches generated orders, after checking that the
+ *         JSON serializer reproduces the previous serialization of every one of them byte for byte.
+ */
+static const CollectingEventHandler &events()
+{
+    static CollectingEventHandler *collected = [] {
+        std::vector<Order> orders;
+        generateOrders(orders, NUM_ORDERS, 1);
+        auto event_handler = std::make_unique<CollectingEventHandler>();
+        CollectingEventHandler *handler = event_handler.get();
+        // The market is leaked along with the handler it owns, so that the events outlive it.
+        auto *market = new Market{std::move(event_handler)};
+        market->addSymbol(1, "SERIALIZER BENCH");
+        for (const auto &order : orders)
+            market->addOrder(order);
+        EventSerializer serializer;
+        for (const auto &[type, order] : handler->order_events)
+        {
+            if (serialize(serializer, type, order) != jsonEvent(type, order))
+            {
+                std::cerr << "JSON mismatch: " << serialize(serializer, type, order) << " vs " << jsonEvent(type, order) << std::endl;
+                std::abort();
+            }
+            if (serializer.key(order.getOrderID()) != std::to_string(order.getOrderID()))
+                std::abort();
+        }
+        for (const auto &trade : handler->trades)
+        {
+            if (serializer.serialize(trade) != jsonEvent(trade))
+            {
+                std::cerr << "JSON mismatch: " << serializer.serialize(trade) << " vs " << jsonEvent(trade) << std::endl;
+                std::abort();
+            }
+        }
+        return handler;
+    }();
+    return *collected;
+}
+
+static void BM_SerializeNlohmann(benchmark::State &state)
+{
+    const CollectingEventHandler &collected = events();
+    uint64_t allocations_before = allocationCount();
+    for (auto _ : state)
+    {
+        for (const auto &[type, order] : collected.order_events)
+        {
+            std::string key = std::to_string(order.getOrderID());
+            std::string payload = jsonEvent(type, order);
+            benchmark::DoNotOptimize(key.data());
+            benchmark::DoNotOptimize(payload.data());
+        }
+        for (const auto &trade : collected.trades)
+        {
+            std::string key = std::to_string(trade.aggressor_id);
+            std::string payload = jsonEvent(trade);
+            benchmark::DoNotOptimize(key.data());
+            benchmark::DoNotOptimize(payload.data());
+        }
+    }
+    uint64_t num_events = state.iterations() * (collected.order_events.size() + collected.trades.size());
+    state.counters["allocs_per_event"] = static_cast<double>(allocationCount() - allocations_before) / static_cast<double>(num_events);
+    state.SetItemsProcessed(static_cast<int64_t>(num_events));
+}
+
+static void BM_SerializeEventSerializer(benchmark::State &state)
+{
+    const CollectingEventHandler &collected = events();
+    EventSerializer serializer{static_cast<EventFormat>(state.range(0))};
+    uint64_t allocations_before = allocationCount();
+    for (auto _ : state)
+    {
+        for (const auto &[type, order] : collected.order_events)
+        {
+            benchmark::DoNotOptimize(serializer.key(order.getOrderID()).data());
+            benchmark::DoNotOptimize(serialize(serializer, type, order).data());
+        }
+        for (const auto &trade : collected.trades)
+        {
+            benchmark::DoNotOptimize(serializer.key(trade.aggressor_id).data());
+            benchmark::DoNotOptimize(serializer.serialize(trade).data());
+        }
+    }
+    uint64_t num_events = state.iterations() * (collected.order_events.size() + collected.trades.size());
+    state.counters["allocs_per_event"] = static_cast<double>(allocationCount() - allocations_before) / static_cast<double>(num_events);
+    state.SetItemsProcessed(static_cast<int64_t>(num_events));
+}
+
+BENCHMARK(BM_SerializeNlohmann)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SerializeEventSerializer)->Arg(0)->Arg(1)->ArgNames({"binary"})->Unit(benchmark::kMillisecond);
+BENCHMARK_MAIN();
@@ -1,9 +1,11 @@
 #include <benchmark/benchmark.h>
 #include <iostream>
 #include <vector>
-#include "generate_orders.h"
 #include "market/market.h"
+#include "market/concurrent_market.h"
 #include "event_handler/event_handler.h"
+#include "generate_orders.h"
+#include "allocation_counter.h"
 
 using namespace RapidTrader;
 
@@ -11,6 +13,7 @@ static void BM_Market(benchmark::State &state)
 {
     const uint64_t num_symbols = state.range(0);
     const uint64_t num_orders = state.range(1);
+    uint64_t allocations = 0;
     std::vector<Order> orders;
     orders.reserve(num_orders);
     generateOrders(orders, num_orders, num_symbols);
@@ -18,14 +21,61 @@ static void BM_Market(benchmark::State &state)
     {
         // Add all the symbols before adding any orders.
         state.PauseTiming();
-        Market market{std::make_unique<EventHandler>()};
+        Market market{std::make_unique<NullEventHandler>()};
         for (int i = 1; i <= num_symbols; ++i)
             market.addSymbol(i, "MARKET BENCH");
+        uint64_t allocations_before = allocationCount();
         state.ResumeTiming();
         // Add all the orders.
         for (const auto &order : orders)
             market.addOrder(order);
+        state.PauseTiming();
+        allocations += allocationCount() - allocations_before;
+        state.ResumeTiming();
+    }
+    state.counters["allocs_per_order"] = static_cast<double>(allocations) / static_cast<double>(state.iterations() * num_orders);
+}
+
+static void BM_MarketChurn(benchmark::State &state)
+{
+    // Steady state add, delete, and re-add of resting orders in a pre-sized book. After
+    // the warm up round the order and level pools should serve every allocation.
+    const uint64_t num_orders = state.range(0);
+    const uint32_t symbol_id = 1;
+    OrderBookConfig config;
+    config.order_capacity = num_orders;
+    config.sequential_order_ids = state.range(1) != 0;
+    config.compact_orders = state.range(2) != 0;
+    std::vector<Order> orders;
+    orders.reserve(num_orders);
+    for (uint64_t i = 1; i <= num_orders; ++i)
+    {
+        // Bids and asks never cross, so every order rests until it is deleted.
+        orders.push_back(i % 2 == 0 ? Order::limitAskOrder(i, symbol_id, 2000 + i % 100, 100, OrderTimeInForce::GTC)
+                                    : Order::limitBidOrder(i, symbol_id, 1000 + i % 100, 100, OrderTimeInForce::GTC));
+    }
+    uint64_t heap_bytes_before = heapBytesInUse();
+    Market market{std::make_unique<NullEventHandler>()};
+    market.addSymbol(symbol_id, "MARKET BENCH", config);
+    // Warm up the pools.
+    for (const auto &order : orders)
+        market.addOrder(order);
+    // Everything the book holds at this point, including its levels and order index, is
+    // attributed to its resting orders.
+    uint64_t heap_bytes = heapBytesInUse() - heap_bytes_before;
+    for (const auto &order : orders)
+        market.deleteOrder(symbol_id, order.getOrderID());
+    uint64_t allocations_before = allocationCount();
+    for (auto _ : state)
+    {
+        for (const auto &order : orders)
+            market.addOrder(order);
+        for (const auto &order : orders)
+            market.deleteOrder(symbol_id, order.getOrderID());
     }
+    uint64_t allocations = allocationCount() - allocations_before;
+    state.counters["allocs_per_op"] = static_cast<double>(allocations) / static_cast<double>(state.iterations() * num_orders * 2);
+    state.counters["bytes_per_order"] = static_cast<double>(heap_bytes) / static_cast<double>(num_orders);
 }
 
 static void BM_ConcurrentMarket(benchmark::State &state)
@@ -40,10 +90,10 @@ static void BM_ConcurrentMarket(benchmark::State &state)
     {
         // Add all the symbols before adding any orders.
         state.PauseTiming();
-        std::vector<std::unique_ptr<EventHandler>> event_handlers;
+        std::vector<std::unique_ptr<NullEventHandler>> event_handlers;
         event_handlers.reserve(num_threads);
         for (int i = 0; i < num_threads; ++i)
-            event_handlers.push_back(std::make_unique<EventHandler>());
+            event_handlers.push_back(std::make_unique<NullEventHandler>());
         ConcurrentMarket market{event_handlers, num_threads};
         for (int i = 1; i <= num_symbols; ++i)
             market.addSymbol(i, "MARKET BENCH");
@@ -82,4 +132,8 @@ BENCHMARK(BM_Market)
     ->Args({2000, 3000000})
     ->Args({2000, 4000000})
     ->ArgNames({"symbols", "orders"});
+BENCHMARK(BM_MarketChurn)
+    ->Unit(benchmark::kMillisecond)
+    ->ArgsProduct({{10000, 100000, 1000000}, {0, 1}, {0, 1}})
+    ->ArgNames({"orders", "sequential_ids", "compact_orders"});
 BENCHMARK_MAIN();
\ No newline at end of file
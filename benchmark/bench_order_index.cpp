@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "matching/orderbook/order_index.h"
+
+using namespace RapidTrader;
+
+// A payload the size of an order wrapper pointer target.
+struct Payload
+{
+    uint64_t value;
+};
+
+using HashMap = robin_hood::unordered_map<uint64_t, Payload *>;
+using HashTable = OrderHashTable<Payload>;
+
+static void insertOrder(HashMap &index, uint64_t order_id, Payload *payload)
+{
+    index.insert({order_id, payload});
+}
+
+static void insertOrder(HashTable &index, uint64_t order_id, Payload *payload)
+{
+    index.insert(order_id, payload);
+}
+
+/**
+ * Grows an index from empty to the number of orders in the range, timing every insert.
+ * Order IDs are scattered, as they are for books that do not index by sequential ID.
+ * Reports the median, 99.9th percentile, and maximum insert latency in nanoseconds.
+ */
+template<typename Index>
+static void BM_InsertLatency(benchmark::State &state)
+{
+    const auto num_orders = static_cast<uint64_t>(state.range(0));
+    std::vector<Payload> payloads(num_orders);
+    std::vector<double> latencies(num_orders);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto index = std::make_unique<Index>();
+        state.ResumeTiming();
+        for (uint64_t i = 0; i < num_orders; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            insertOrder(*index, i * 0x9E3779B97F4A7C15ULL, &payloads[i]);
+            auto end = std::chrono::steady_clock::now();
+            latencies[i] = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        }
+        state.PauseTiming();
+        index.reset();
+        state.ResumeTiming();
+    }
+    std::sort(latencies.begin(), latencies.end());
+    state.counters["p50_ns"] = latencies[num_orders / 2];
+    state.counters["p99.9_ns"] = latencies[num_orders - 1 - num_orders / 1000];
+    state.counters["max_ns"] = latencies.back();
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * num_orders));
+}
+
+BENCHMARK_TEMPLATE(BM_InsertLatency, HashMap)->RangeMultiplier(10)->Range(1000, 10000000)->ArgNames({"orders"})->Iterations(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_InsertLatency, HashTable)->RangeMultiplier(10)->Range(1000, 10000000)->ArgNames({"orders"})->Iterations(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_MAIN();
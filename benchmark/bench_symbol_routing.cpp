@@ -0,0 +1,98 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+#include <vector>
+#include "market/market.h"
+#include "market/symbol_table.h"
+#include "event_handler/event_handler.h"
+
+using namespace RapidTrader;
+
+// The number of commands routed per benchmark iteration.
+constexpr uint64_t NUM_COMMANDS = 1 << 16;
+
+// A payload the size of an orderbook pointer target, so that both tables chase one pointer per lookup.
+struct Payload
+{
+    uint64_t value;
+};
+
+using HashTable = robin_hood::unordered_map<uint32_t, std::unique_ptr<Payload>>;
+using DenseTable = SymbolTable<Payload>;
+
+static void insertSymbol(HashTable &table, uint32_t symbol_id)
+{
+    table.insert({symbol_id, std::make_unique<Payload>(Payload{symbol_id})});
+}
+
+static void insertSymbol(DenseTable &table, uint32_t symbol_id)
+{
+    table.insert(symbol_id, std::make_unique<Payload>(Payload{symbol_id}));
+}
+
+static Payload *findSymbol(const HashTable &table, uint32_t symbol_id)
+{
+    return table.find(symbol_id)->second.get();
+}
+
+static Payload *findSymbol(const DenseTable &table, uint32_t symbol_id)
+{
+    return table.find(symbol_id);
+}
+
+/**
+ * @return symbol IDs between 1 and num_symbols in a random order, one for each command.
+ */
+static std::vector<uint32_t> commandSymbols(uint32_t num_symbols)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<uint32_t> symbol_distribution(1, num_symbols);
+    std::vector<uint32_t> symbol_ids(NUM_COMMANDS);
+    for (auto &symbol_id : symbol_ids)
+        symbol_id = symbol_distribution(generator);
+    return symbol_ids;
+}
+
+template<typename Table>
+static void BM_SymbolLookup(benchmark::State &state)
+{
+    const auto num_symbols = static_cast<uint32_t>(state.range(0));
+    Table table;
+    for (uint32_t symbol_id = 1; symbol_id <= num_symbols; ++symbol_id)
+        insertSymbol(table, symbol_id);
+    std::vector<uint32_t> symbol_ids = commandSymbols(num_symbols);
+    for (auto _ : state)
+    {
+        uint64_t sum = 0;
+        for (uint32_t symbol_id : symbol_ids)
+            sum += findSymbol(table, symbol_id)->value;
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * NUM_COMMANDS));
+}
+
+static void BM_HandlerRouting(benchmark::State &state)
+{
+    // Immediate or cancel orders on empty books do no matching, so the cost per command is
+    // dominated by finding the orderbook and dispatching to it.
+    const auto num_symbols = static_cast<uint32_t>(state.range(0));
+    Market market{std::make_unique<NullEventHandler>()};
+    for (uint32_t symbol_id = 1; symbol_id <= num_symbols; ++symbol_id)
+        market.addSymbol(symbol_id, "ROUTING BENCH");
+    std::vector<Order> orders;
+    orders.reserve(NUM_COMMANDS);
+    std::vector<uint32_t> symbol_ids = commandSymbols(num_symbols);
+    for (uint64_t i = 0; i < NUM_COMMANDS; ++i)
+        orders.push_back(Order::limitBidOrder(i + 1, symbol_ids[i], 100, 1, OrderTimeInForce::IOC));
+    for (auto _ : state)
+    {
+        for (const auto &order : orders)
+            market.addOrder(order);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * NUM_COMMANDS));
+}
+
+BENCHMARK_TEMPLATE(BM_SymbolLookup, HashTable)->Arg(1)->Arg(100)->Arg(1000)->Arg(2000)->ArgNames({"symbols"});
+BENCHMARK_TEMPLATE(BM_SymbolLookup, DenseTable)->Arg(1)->Arg(100)->Arg(1000)->Arg(2000)->ArgNames({"symbols"});
+BENCHMARK(BM_HandlerRouting)->Arg(1)->Arg(100)->Arg(1000)->Arg(2000)->ArgNames({"symbols"});
+BENCHMARK_MAIN();
@@ -0,0 +1,121 @@
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <vector>
+#include "concurrent/thread_pool.h"
+
+using namespace RapidTrader::Concurrent;
+
+// A counter on its own cache line, so that workers do not contend on each other's counters.
+struct alignas(CACHE_LINE_SIZE) PaddedCounter
+{
+    uint64_t value = 0;
+};
+
+template<typename Pool>
+static void BM_ThreadPool(benchmark::State &state)
+{
+    const auto num_workers = static_cast<uint32_t>(state.range(0));
+    const uint64_t num_tasks = state.range(1);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto pool = std::make_unique<Pool>(num_workers);
+        std::vector<PaddedCounter> counters(num_workers);
+        state.ResumeTiming();
+        // Submit the tasks round robin from a single thread.
+        for (uint64_t i = 0; i < num_tasks; ++i)
+        {
+            uint32_t worker = i % num_workers;
+            uint64_t *counter = &counters[worker].value;
+            pool->submitTask(worker, [counter] { ++*counter; });
+        }
+        // Destroying the pool waits for the workers to drain their queues.
+        pool.reset();
+        benchmark::DoNotOptimize(counters.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * num_tasks));
+}
+
+static void BM_WakeUpLatency(benchmark::State &state)
+{
+    // Measures the time from submitting a task to an idle worker until the task starts running.
+    auto wait_strategy = static_cast<WaitStrategy>(state.range(0));
+    ThreadPool pool{1, wait_strategy};
+    std::atomic<int64_t> started_at{0};
+    for (auto _ : state)
+    {
+        // Give the worker time to go idle.
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        started_at.store(0, std::memory_order_relaxed);
+        auto submitted_at = std::chrono::steady_clock::now();
+        pool.submitTask(0, [&started_at] { started_at.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_release); });
+        int64_t started_at_ticks;
+        // Yield rather than spin so that the worker can run even on a host with a single core.
+        while ((started_at_ticks = started_at.load(std::memory_order_acquire)) == 0)
+            std::this_thread::yield();
+        auto latency = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(started_at_ticks)) - submitted_at;
+        state.SetIterationTime(std::chrono::duration<double>(latency).count());
+    }
+}
+
+static void BM_IdleCpu(benchmark::State &state)
+{
+    // Measures how many cores a pool of idle workers keeps busy.
+    auto wait_strategy = static_cast<WaitStrategy>(state.range(0));
+    const auto num_workers = static_cast<uint32_t>(state.range(1));
+    double cpu_seconds = 0;
+    double wall_seconds = 0;
+    for (auto _ : state)
+    {
+        ThreadPool pool{num_workers, wait_strategy};
+        timespec cpu_before{};
+        timespec cpu_after{};
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_before);
+        auto wall_before = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_after);
+        wall_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_before).count();
+        cpu_seconds += static_cast<double>(cpu_after.tv_sec - cpu_before.tv_sec) + static_cast<double>(cpu_after.tv_nsec - cpu_before.tv_nsec) * 1e-9;
+    }
+    state.counters["idle_cpu_cores"] = cpu_seconds / wall_seconds;
+}
+
+BENCHMARK_TEMPLATE(BM_ThreadPool, LockingThreadPool)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1, 1000000})
+    ->Args({2, 1000000})
+    ->Args({4, 1000000})
+    ->Args({8, 1000000})
+    ->ArgNames({"workers", "tasks"})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ThreadPool, ThreadPool)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1, 1000000})
+    ->Args({2, 1000000})
+    ->Args({4, 1000000})
+    ->Args({8, 1000000})
+    ->ArgNames({"workers", "tasks"})
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ThreadPool, SingleProducerThreadPool)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1, 1000000})
+    ->Args({2, 1000000})
+    ->Args({4, 1000000})
+    ->Args({8, 1000000})
+    ->ArgNames({"workers", "tasks"})
+    ->UseRealTime();
+// Wait strategies: 0 = busy spin, 1 = backoff, 2 = block.
+BENCHMARK(BM_WakeUpLatency)->Unit(benchmark::kMicrosecond)->UseManualTime()->Iterations(1000)->Arg(0)->Arg(1)->Arg(2)->ArgName("strategy");
+BENCHMARK(BM_IdleCpu)
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(3)
+    ->Args({0, 1})
+    ->Args({1, 1})
+    ->Args({2, 1})
+    ->Args({0, 4})
+    ->Args({1, 4})
+    ->Args({2, 4})
+    ->ArgNames({"strategy", "workers"});
+BENCHMARK_MAIN();
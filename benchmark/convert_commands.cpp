@@ -0,0 +1,83 @@
+#include <nlohmann/json.hpp>
+#include "convert_commands.h"
+
+using json = nlohmann::json;
+
+// Captures hold numeric fields either as strings or as numbers.
+static uint64_t toNumber(const json &value)
+{
+    return value.is_string() ? std::stoull(value.get<std::string>()) : value.get<uint64_t>();
+}
+
+static bool toOrderType(const std::string &name, OrderType &type)
+{
+    static const std::pair<const char *, OrderType> names[] = {{"limit", OrderType::Limit}, {"market", OrderType::Market},
+        {"stop", OrderType::Stop}, {"stop_limit", OrderType::StopLimit}, {"trailing_stop", OrderType::TrailingStop},
+        {"trailing_stop_limit", OrderType::TrailingStopLimit}};
+    for (const auto &[type_name, order_type] : names)
+    {
+        if (name == type_name)
+        {
+            type = order_type;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool convertCommand(const std::string &line, BinaryCommand &command)
+{
+    try
+    {
+        json j = json::parse(line);
+        std::string operation = j.value("operation", "");
+        json payload = j.value("payload", json::object());
+        command = BinaryCommand{};
+        command.symbol_id = static_cast<uint32_t>(toNumber(payload.at("instrument_id")));
+        command.order_id = toNumber(payload.at("order_id"));
+        if (operation == "CANCEL_ORDER")
+        {
+            command.operation = BinaryOperation::CancelOrder;
+            return true;
+        }
+        if (operation != "ADD_ORDER" || !toOrderType(payload.value("order_type", "limit"), command.order_type))
+            return false;
+        command.operation = BinaryOperation::AddOrder;
+        // Sides and times in force are mapped as exchange_main maps them.
+        command.side = payload.at("order_side") == "buy" ? OrderSide::Bid : OrderSide::Ask;
+        std::string time_in_force = payload.value("time_in_force", "GTC");
+        command.time_in_force = time_in_force == "IOC" ? OrderTimeInForce::IOC
+                                : time_in_force == "FOK" ? OrderTimeInForce::FOK
+                                                         : OrderTimeInForce::GTC;
+        command.price = toNumber(payload.at("price"));
+        command.quantity = toNumber(payload.at("quantity_ordered"));
+        return true;
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+}
+
+std::vector<std::string> generateJsonCommands(const std::vector<Order> &orders)
+{
+    std::vector<std::string> commands;
+    for (const auto &order : orders)
+    {
+        json payload;
+        payload["order_type"] = "limit";
+        payload["order_side"] = order.isBid() ? "buy" : "sell";
+        payload["order_id"] = order.getOrderID();
+        payload["instrument_id"] = std::to_string(order.getSymbolID());
+        payload["price"] = std::to_string(order.getPrice());
+        payload["quantity_ordered"] = std::to_string(order.getQuantity());
+        payload["time_in_force"] = "GTC";
+        commands.push_back(json{{"operation", "ADD_ORDER"}, {"payload", payload}}.dump());
+    }
+    for (size_t i = 0; i < orders.size(); i += 2)
+    {
+        json payload{{"order_id", orders[i].getOrderID()}, {"instrument_id", orders[i].getSymbolID()}};
+        commands.push_back(json{{"operation", "CANCEL_ORDER"}, {"payload", payload}}.dump());
+    }
+    return commands;
+}
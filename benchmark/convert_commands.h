@@ -0,0 +1,22 @@
+#ifndef RAPID_TRADER_CONVERT_COMMANDS_H
+#define RAPID_TRADER_CONVERT_COMMANDS_H
+#include <string>
+#include <vector>
+#include "matching/market/binary_command.h"
+using namespace RapidTrader;
+
+/**
+ * Converts a JSON command, in the format consumed by exchange_main, to a binary command.
+ *
+ * @param line the JSON command.
+ * @param command set to the converted command.
+ * @return true if the command was converted, and false if it is not a well-formed command.
+ */
+bool convertCommand(const std::string &line, BinaryCommand &command);
+
+/**
+ * @param orders the orders to add, followed by a cancel of every other order.
+ * @return the JSON commands in the format consumed by exchange_main.
+ */
+std::vector<std::string> generateJsonCommands(const std::vector<Order> &orders);
+#endif // RAPID_TRADER_CONVERT_COMMANDS_H
@@ -0,0 +1,47 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "convert_commands.h"
+
+/**
+ * Converts a capture of JSON commands, one per line, to binary commands for benchmarking.
+ * Binary commands have a fixed size, so they are written back to back without framing.
+ *
+ * Usage: convert_commands <JSON capture> <binary output>
+ */
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <JSON capture> <binary output>" << std::endl;
+        return 1;
+    }
+    std::ifstream in{argv[1]};
+    std::ofstream out{argv[2], std::ios::binary};
+    if (!in || !out)
+    {
+        std::cerr << "Failed to open " << (!in ? argv[1] : argv[2]) << std::endl;
+        return 1;
+    }
+    std::string line;
+    uint64_t converted = 0;
+    uint64_t skipped = 0;
+    char buffer[BINARY_COMMAND_SIZE];
+    for (uint64_t line_number = 1; std::getline(in, line); ++line_number)
+    {
+        if (line.empty())
+            continue;
+        BinaryCommand command;
+        if (!convertCommand(line, command))
+        {
+            std::cerr << "Skipped malformed command on line " << line_number << std::endl;
+            ++skipped;
+            continue;
+        }
+        command.encode(buffer);
+        out.write(buffer, BINARY_COMMAND_SIZE);
+        ++converted;
+    }
+    std::cout << "Converted " << converted << " commands, skipped " << skipped << std::endl;
+    return skipped == 0 ? 0 : 2;
+}
@@ -14,6 +14,8 @@ template<typename T>
 class Queue
 {
 public:
+    using value_type = T;
+
     Queue() = default;
 
     Queue(const Queue &other)
@@ -29,6 +31,24 @@ public:
         c.notify_one();
     }
 
+    /**
+     * Pushes objects onto the queue under a single lock.
+     *
+     * @param data the objects to push, they are moved from.
+     * @param count the number of objects to push.
+     * @return the number of objects pushed, which is always count.
+     */
+    size_t tryPushBatch(T *data, size_t count)
+    {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            for (size_t i = 0; i < count; ++i)
+                queue.push(std::move(data[i]));
+        }
+        c.notify_one();
+        return count;
+    }
+
     T waitAndPop()
     {
         std::unique_lock<std::mutex> lk(m);
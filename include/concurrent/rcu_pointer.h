@@ -0,0 +1,169 @@
+#ifndef RAPID_TRADER_RCU_POINTER_H
+#define RAPID_TRADER_RCU_POINTER_H
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include "concurrent/ring_queue.h"
+
+namespace RapidTrader::Concurrent {
+/**
+ * A pointer to a read-mostly object that readers access without locks and writers
+ * replace with a new copy (read-copy-update).
+ *
+ * Readers announce themselves in one of two reader counts, selected by the parity
+ * of an epoch. Each count is striped over cache lines by thread, so readers on
+ * different threads rarely write the same line. A writer publishes the new object,
+ * then flips the epoch twice, each time waiting for the readers that entered with
+ * the old parity to leave. New readers always enter with the current parity, so a
+ * writer waits only for readers that started before it and readers never wait.
+ *
+ * @tparam T type of the object, require that T is copy constructible if modify is used.
+ */
+template<typename T>
+class RcuPointer
+{
+public:
+    class ReadGuard;
+
+    /**
+     * A constructor for the pointer.
+     *
+     * @param value_ the initial object, require that value_ is not null.
+     */
+    explicit RcuPointer(std::unique_ptr<T> value_)
+        : value(value_.release())
+    {
+        assert(value.load(std::memory_order_relaxed) && "The initial object must not be null!");
+    }
+
+    RcuPointer(const RcuPointer &) = delete;
+    RcuPointer &operator=(const RcuPointer &) = delete;
+
+    ~RcuPointer()
+    {
+        delete value.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Enters a read-side critical section. The object that the guard refers to is not
+     * deleted until the guard is destroyed. Guards must not be held across a call to update
+     * on the same thread.
+     *
+     * @return a guard that refers to the current object.
+     */
+    ReadGuard read() const
+    {
+        return ReadGuard(*this);
+    }
+
+    /**
+     * Replaces the object, then waits for every reader that may still refer to the old
+     * object before deleting it. Must not be called concurrently with update or modify.
+     *
+     * @param new_value the object that replaces the current one, require that new_value is not null.
+     */
+    void update(std::unique_ptr<T> new_value)
+    {
+        assert(new_value && "The new object must not be null!");
+        T *old_value = value.exchange(new_value.release(), std::memory_order_seq_cst);
+        synchronize();
+        delete old_value;
+    }
+
+    /**
+     * Replaces the object with a modified copy of it. Must not be called concurrently
+     * with update or modify.
+     *
+     * @param modifier the function that modifies the copy.
+     */
+    void modify(const std::function<void(T &)> &modifier)
+    {
+        auto new_value = std::make_unique<T>(*value.load(std::memory_order_relaxed));
+        modifier(*new_value);
+        update(std::move(new_value));
+    }
+
+    /**
+     * Waits for every reader that started before the call to leave its critical section.
+     */
+    void synchronize()
+    {
+        for (uint32_t flip = 0; flip < 2; ++flip)
+        {
+            uint64_t old_epoch = epoch.fetch_add(1, std::memory_order_seq_cst);
+            for (auto &stripe : reader_counts[old_epoch & 1])
+            {
+                while (stripe.count.load(std::memory_order_seq_cst) != 0)
+                    std::this_thread::yield();
+            }
+        }
+    }
+
+    /**
+     * Refers to the object of an RcuPointer for as long as it exists.
+     */
+    class ReadGuard
+    {
+    public:
+        ReadGuard(const ReadGuard &) = delete;
+        ReadGuard &operator=(const ReadGuard &) = delete;
+
+        ~ReadGuard()
+        {
+            count.fetch_sub(1, std::memory_order_release);
+        }
+
+        const T &operator*() const
+        {
+            return *value;
+        }
+
+        const T *operator->() const
+        {
+            return value;
+        }
+
+    private:
+        friend class RcuPointer;
+
+        explicit ReadGuard(const RcuPointer &pointer)
+            : count(pointer.reader_counts[pointer.epoch.load(std::memory_order_seq_cst) & 1][readerStripe()].count)
+        {
+            count.fetch_add(1, std::memory_order_seq_cst);
+            value = pointer.value.load(std::memory_order_seq_cst);
+        }
+
+        std::atomic<int64_t> &count;
+        const T *value;
+    };
+
+private:
+    // The number of cache lines that each reader count is striped over.
+    static constexpr size_t NUM_READER_STRIPES = 32;
+
+    struct alignas(CACHE_LINE_SIZE) ReaderStripe
+    {
+        std::atomic<int64_t> count{0};
+    };
+
+    /**
+     * @return the stripe of the reader counts that the calling thread uses.
+     */
+    static size_t readerStripe()
+    {
+        static thread_local const size_t stripe = std::hash<std::thread::id>{}(std::this_thread::get_id()) % NUM_READER_STRIPES;
+        return stripe;
+    }
+
+    std::atomic<T *> value;
+    // Incremented twice by every synchronize, its parity selects the reader count that new readers use.
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> epoch{0};
+    // The number of readers in a critical section for each parity of the epoch.
+    mutable ReaderStripe reader_counts[2][NUM_READER_STRIPES];
+};
+} // namespace RapidTrader::Concurrent
+#endif // RAPID_TRADER_RCU_POINTER_H
@@ -0,0 +1,328 @@
+#ifndef RAPID_TRADER_RING_QUEUE_H
+#define RAPID_TRADER_RING_QUEUE_H
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace RapidTrader::Concurrent {
+// The size of a cache line. Indices that are written by different threads are
+// aligned to it so that they never share a line.
+constexpr size_t CACHE_LINE_SIZE = 64;
+// The number of slots a ring queue has if no capacity is provided.
+constexpr size_t DEFAULT_RING_QUEUE_CAPACITY = 16384;
+
+/**
+ * @param capacity the requested capacity.
+ * @return the smallest power of two that is at least capacity.
+ */
+constexpr size_t ringQueueCapacity(size_t capacity)
+{
+    size_t rounded = 1;
+    while (rounded < capacity)
+        rounded <<= 1;
+    return rounded;
+}
+
+/**
+ * A bounded, lock-free, single-producer single-consumer queue.
+ *
+ * Exactly one thread may push and exactly one thread may pop at any time. The head
+ * and tail indices live on their own cache lines, and each side keeps a cached copy
+ * of the other side's index so that it only touches the other side's cache line
+ * when the queue looks full or empty.
+ *
+ * @tparam T type of the objects that will be stored in the queue, require that T is
+ *           default constructible and move assignable.
+ */
+template<typename T>
+class SPSCQueue
+{
+public:
+    using value_type = T;
+
+    /**
+     * A constructor for the queue.
+     *
+     * @param capacity_ the number of objects the queue can hold, rounded up to a power of two.
+     */
+    explicit SPSCQueue(size_t capacity_ = DEFAULT_RING_QUEUE_CAPACITY)
+        : capacity(ringQueueCapacity(capacity_))
+        , mask(capacity - 1)
+        , slots(std::make_unique<T[]>(capacity))
+    {}
+
+    SPSCQueue(const SPSCQueue &) = delete;
+    SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+    /**
+     * Pushes an object onto the queue, yielding until there is space for it.
+     *
+     * @param data the object to push.
+     */
+    void push(T data)
+    {
+        while (!tryPush(data))
+            std::this_thread::yield();
+    }
+
+    /**
+     * Pushes an object onto the queue if there is space for it.
+     *
+     * @param data the object to push, it is only moved from if the push succeeds.
+     * @return true if the object was pushed and false if the queue is full.
+     */
+    bool tryPush(T &data)
+    {
+        size_t tail = producer.index.load(std::memory_order_relaxed);
+        if (tail - producer.cached_index == capacity)
+        {
+            producer.cached_index = consumer.index.load(std::memory_order_acquire);
+            if (tail - producer.cached_index == capacity)
+                return false;
+        }
+        slots[tail & mask] = std::move(data);
+        producer.index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Pushes as many of the objects onto the queue as there is space for, and publishes
+     * them to the consumer at once.
+     *
+     * @param data the objects to push, only the pushed objects are moved from.
+     * @param count the number of objects to push.
+     * @return the number of objects pushed, zero if the queue is full.
+     */
+    size_t tryPushBatch(T *data, size_t count)
+    {
+        size_t tail = producer.index.load(std::memory_order_relaxed);
+        if (capacity - (tail - producer.cached_index) < count)
+            producer.cached_index = consumer.index.load(std::memory_order_acquire);
+        size_t pushed = std::min(capacity - (tail - producer.cached_index), count);
+        for (size_t i = 0; i < pushed; ++i)
+            slots[(tail + i) & mask] = std::move(data[i]);
+        if (pushed > 0)
+            producer.index.store(tail + pushed, std::memory_order_release);
+        return pushed;
+    }
+
+    /**
+     * Pops an object from the queue if there is one.
+     *
+     * @param data set to the popped object.
+     * @return true if an object was popped and false if the queue is empty.
+     */
+    bool tryPop(T &data)
+    {
+        size_t head = consumer.index.load(std::memory_order_relaxed);
+        if (head == consumer.cached_index)
+        {
+            consumer.cached_index = producer.index.load(std::memory_order_acquire);
+            if (head == consumer.cached_index)
+                return false;
+        }
+        data = std::move(slots[head & mask]);
+        consumer.index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @return true if the queue is empty and false otherwise.
+     */
+    bool empty() const
+    {
+        return consumer.index.load(std::memory_order_acquire) == producer.index.load(std::memory_order_acquire);
+    }
+
+    /**
+     * May be called from any thread. The consumer sees at least the returned number of
+     * objects, and the producer sees at most the returned number of objects.
+     *
+     * @return the number of objects in the queue.
+     */
+    size_t size() const
+    {
+        // The head is read first, and never passes the tail, so the difference cannot wrap.
+        size_t head = consumer.index.load(std::memory_order_acquire);
+        size_t tail = producer.index.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    /**
+     * @return the number of objects the queue can hold.
+     */
+    size_t maxSize() const
+    {
+        return capacity;
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Index
+    {
+        // The index owned by this side of the queue.
+        std::atomic<size_t> index{0};
+        // The last value of the other side's index that this side has seen.
+        size_t cached_index{0};
+    };
+
+    const size_t capacity;
+    const size_t mask;
+    std::unique_ptr<T[]> slots;
+    // The tail of the queue and the producer's copy of the head.
+    Index producer;
+    // The head of the queue and the consumer's copy of the tail.
+    Index consumer;
+};
+
+/**
+ * A bounded, lock-free, multi-producer single-consumer queue.
+ *
+ * Any number of threads may push, and exactly one thread may pop at any time.
+ * Producers claim a slot by advancing the tail with a compare-and-swap, and each
+ * slot carries a sequence number that tells the consumer when the object in it
+ * has been published and tells producers when the slot is free again.
+ *
+ * @tparam T type of the objects that will be stored in the queue, require that T is
+ *           default constructible and move assignable.
+ */
+template<typename T>
+class MPSCQueue
+{
+public:
+    using value_type = T;
+
+    /**
+     * A constructor for the queue.
+     *
+     * @param capacity_ the number of objects the queue can hold, rounded up to a power of two
+     *                  and to at least two. With a single slot, the sequence of a freed slot
+     *                  would equal the sequence of an occupied one.
+     */
+    explicit MPSCQueue(size_t capacity_ = DEFAULT_RING_QUEUE_CAPACITY)
+        : capacity(ringQueueCapacity(std::max<size_t>(capacity_, 2)))
+        , mask(capacity - 1)
+        , slots(std::make_unique<Slot[]>(capacity))
+    {
+        for (size_t i = 0; i < capacity; ++i)
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MPSCQueue(const MPSCQueue &) = delete;
+    MPSCQueue &operator=(const MPSCQueue &) = delete;
+
+    /**
+     * Pushes an object onto the queue, yielding until there is space for it.
+     *
+     * @param data the object to push.
+     */
+    void push(T data)
+    {
+        while (!tryPush(data))
+            std::this_thread::yield();
+    }
+
+    /**
+     * Pushes an object onto the queue if there is space for it.
+     *
+     * @param data the object to push, it is only moved from if the push succeeds.
+     * @return true if the object was pushed and false if the queue is full.
+     */
+    bool tryPush(T &data)
+    {
+        size_t tail = tail_index.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Slot &slot = slots[tail & mask];
+            auto difference = static_cast<intptr_t>(slot.sequence.load(std::memory_order_acquire) - tail);
+            if (difference == 0)
+            {
+                // The slot is free, try to claim it.
+                if (tail_index.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+                {
+                    slot.data = std::move(data);
+                    slot.sequence.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The slot still holds an object from the previous lap.
+                return false;
+            }
+            else
+            {
+                // Another producer claimed the slot first.
+                tail = tail_index.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Pushes as many of the objects onto the queue as there is space for. Objects pushed
+     * by other producers may be interleaved with them.
+     *
+     * @param data the objects to push, only the pushed objects are moved from.
+     * @param count the number of objects to push.
+     * @return the number of objects pushed, zero if the queue is full.
+     */
+    size_t tryPushBatch(T *data, size_t count)
+    {
+        size_t pushed = 0;
+        while (pushed < count && tryPush(data[pushed]))
+            ++pushed;
+        return pushed;
+    }
+
+    /**
+     * Pops an object from the queue if there is one. Must only be called by the consumer.
+     *
+     * @param data set to the popped object.
+     * @return true if an object was popped and false if the queue is empty.
+     */
+    bool tryPop(T &data)
+    {
+        size_t head = head_index.load(std::memory_order_relaxed);
+        Slot &slot = slots[head & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1)
+            return false;
+        data = std::move(slot.data);
+        // Hand the slot back to the producers for the next lap.
+        slot.sequence.store(head + capacity, std::memory_order_release);
+        head_index.store(head + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Must only be called by the consumer. Objects whose push is still in progress are
+     * not counted.
+     *
+     * @return true if the queue is empty and false otherwise.
+     */
+    bool empty() const
+    {
+        size_t head = head_index.load(std::memory_order_relaxed);
+        return slots[head & mask].sequence.load(std::memory_order_acquire) != head + 1;
+    }
+
+private:
+    struct Slot
+    {
+        // Equal to the position of the slot when it is free, one past it when it holds an object.
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    const size_t capacity;
+    const size_t mask;
+    std::unique_ptr<Slot[]> slots;
+    // The next position producers will claim.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_index{0};
+    // The next position the consumer will pop.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_index{0};
+};
+} // namespace RapidTrader::Concurrent
+#endif // RAPID_TRADER_RING_QUEUE_H
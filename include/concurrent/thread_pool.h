@@ -4,44 +4,115 @@
 #include <vector>
 #include <atomic>
 #include <cassert>
+#include <functional>
 #include <future>
+#ifdef __linux__
+#    include <pthread.h>
+#    include <sched.h>
+#endif
 #include "concurrent/thread_joiner.h"
 #include "concurrent/queue.h"
+#include "concurrent/ring_queue.h"
+#include "concurrent/wait_strategy.h"
 
 namespace RapidTrader::Concurrent {
-class ThreadPool
+/**
+ * A thread pool where each worker thread draws tasks from its own queue.
+ *
+ * @tparam TaskQueue the type of the worker queues, require that it is a default
+ *                   constructible queue of callable tasks that provides value_type,
+ *                   push, tryPushBatch, tryPop and empty. submitTask and submitWaitableTask require
+ *                   that the tasks are std::function<void()>.
+ */
+template<typename TaskQueue>
+class BasicThreadPool
 {
 public:
+    using Task = typename TaskQueue::value_type;
     /**
      * A constructor for the thread pool.
      *
      * @param num_threads_ the number of worker threads that will be spawned by
      *                     the thread pool, require that num_threads_ is positive.
+     * @param wait_strategy_ how worker threads wait for tasks when their queue is empty.
+     * @param worker_cores_ the CPU core that each worker thread is pinned to, require that
+     *                      worker_cores_ is either empty, in which case workers are not pinned,
+     *                      or has one existing core for each worker thread.
+     * @param queue_capacity_ the number of tasks each worker queue can hold, only used by
+     *                        bounded queues that are constructible from a capacity.
      */
-    explicit ThreadPool(uint32_t num_threads_ = std::thread::hardware_concurrency())
-        : num_threads(num_threads_)
-        , running(true)
+    explicit BasicThreadPool(uint32_t num_threads_ = std::thread::hardware_concurrency(),
+        WaitStrategy wait_strategy_ = WaitStrategy::Backoff, std::vector<uint32_t> worker_cores_ = {},
+        size_t queue_capacity_ = DEFAULT_RING_QUEUE_CAPACITY)
+        : running(true)
+        , num_threads(num_threads_)
+        , wait_strategy(wait_strategy_)
+        , worker_cores(std::move(worker_cores_))
+        , queue_capacity(queue_capacity_)
+        , ready_workers(0)
         , thread_joiner(threads)
     {
         assert(num_threads > 0 && "Thread pool requires at least one thread!");
+        assert((worker_cores.empty() || worker_cores.size() == num_threads) && "Each worker thread requires a core!");
 
-        thread_queues.reserve(num_threads);
+        // Each worker creates its own queue and signal, so the vectors are sized up front
+        // and never reallocated while the workers are reading them.
+        thread_queues.resize(num_threads);
+        thread_signals.resize(num_threads);
         threads.reserve(num_threads);
 
         // Try to spawn the threads for the pool.
         try
         {
-            for (auto i = 0; i < num_threads; ++i)
-            {
-                thread_queues.push_back(std::make_unique<Queue<std::function<void()>>>());
-                threads.emplace_back(&ThreadPool::workerThread, this, i);
-            }
+            for (uint32_t i = 0; i < num_threads; ++i)
+                threads.emplace_back(&BasicThreadPool::workerThread, this, i);
         }
         catch (...)
         {
             running = false;
             throw;
         }
+        // Tasks cannot be submitted until every worker has created its queue.
+        while (ready_workers.load(std::memory_order_acquire) < num_threads)
+            std::this_thread::yield();
+    }
+
+    /**
+     * Submits a task to the thread pool for execution.
+     *
+     * @param queue_index the index of the queue that the task will be submitted to,
+     *                    require that 0 <= queue_index < number of workers.
+     * @param task the task that will be executed.
+     */
+    void submit(uint32_t queue_index, Task task)
+    {
+        thread_queues[queue_index]->push(std::move(task));
+        notifyWorker(queue_index);
+    }
+
+    /**
+     * Submits tasks to the thread pool for execution, publishing them to the worker
+     * in as few pushes as the queue allows and waking the worker once per push.
+     *
+     * @param queue_index the index of the queue that the tasks will be submitted to,
+     *                    require that 0 <= queue_index < number of workers.
+     * @param tasks the tasks that will be executed in order, they are moved from.
+     * @param num_tasks the number of tasks.
+     */
+    void submitBatch(uint32_t queue_index, Task *tasks, size_t num_tasks)
+    {
+        while (num_tasks > 0)
+        {
+            size_t pushed = thread_queues[queue_index]->tryPushBatch(tasks, num_tasks);
+            if (pushed == 0)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            notifyWorker(queue_index);
+            tasks += pushed;
+            num_tasks -= pushed;
+        }
     }
 
     /**
@@ -60,6 +131,7 @@ public:
     {
         std::function<void()> task = std::bind(std::forward<F>(f), std::forward<Args>(args)...);
         thread_queues[queue_index]->push(task);
+        notifyWorker(queue_index);
     }
 
     /**
@@ -98,6 +170,7 @@ public:
                 task_promise->set_exception(std::current_exception());
             }
         });
+        notifyWorker(queue_index);
         return task_promise->get_future();
     }
 
@@ -111,8 +184,8 @@ public:
         // Try to spawn the threads for the pool.
         try
         {
-            for (auto i = 0; i < num_threads; ++i)
-                threads[i] = std::thread(&ThreadPool::workerThread, this, i);
+            for (uint32_t i = 0; i < num_threads; ++i)
+                threads[i] = std::thread(&BasicThreadPool::workerThread, this, i);
         }
         catch (...)
         {
@@ -128,6 +201,7 @@ public:
     {
         assert(running && "Thread pool has not been started!");
         running = false;
+        notifyWorkers();
     }
 
     /**
@@ -149,9 +223,10 @@ public:
     /**
      * A destructor for the thread pool. Notifies worker threads that they are finished.
      */
-    ~ThreadPool()
+    ~BasicThreadPool()
     {
         running = false;
+        notifyWorkers();
     };
 
 private:
@@ -164,19 +239,122 @@ private:
     void workerThread(uint32_t queue_id)
     {
         assert(queue_id < thread_queues.size() && "Invalid queue index!");
+        if (!thread_queues[queue_id])
+        {
+            // Pin the worker before it allocates its queue, so that the queue is placed on the
+            // NUMA node of the worker's core by the first touch of its memory.
+            if (!worker_cores.empty())
+                pinToCore(worker_cores[queue_id]);
+            if constexpr (std::is_constructible_v<TaskQueue, size_t>)
+                thread_queues[queue_id] = std::make_unique<TaskQueue>(queue_capacity);
+            else
+                thread_queues[queue_id] = std::make_unique<TaskQueue>();
+            thread_signals[queue_id] = std::make_unique<WorkerSignal>();
+            ready_workers.fetch_add(1, std::memory_order_release);
+        }
+        TaskQueue &queue = *thread_queues[queue_id];
+        WorkerSignal &signal = *thread_signals[queue_id];
+        // The number of consecutive times the queue has been found empty.
+        uint32_t idle_rounds = 0;
         // Keep processing tasks until the running flag is set to false and the queue is empty.
         // Otherwise, there may be unfinished tasks left in the queue.
-        while (running || !thread_queues[queue_id]->empty())
+        while (running || !queue.empty())
         {
-            std::function<void()> task;
-            bool empty = false;
-            if (thread_queues[queue_id]->tryPop(task))
+            Task task;
+            if (queue.tryPop(task))
+            {
                 task();
+                idle_rounds = 0;
+            }
             else
+            {
+                waitForTask(queue, signal, idle_rounds++);
+            }
+        }
+    }
+
+    /**
+     * Waits for a task according to the wait strategy of the pool. May return before a task
+     * has been submitted.
+     *
+     * @param queue the queue of the worker thread.
+     * @param signal the signal of the worker thread.
+     * @param idle_rounds the number of consecutive times the queue has been found empty.
+     */
+    void waitForTask(const TaskQueue &queue, WorkerSignal &signal, uint32_t idle_rounds)
+    {
+        switch (wait_strategy)
+        {
+        case WaitStrategy::BusySpin:
+            cpuRelax();
+            return;
+        case WaitStrategy::Backoff:
+            if (idle_rounds < BACKOFF_SPIN_ROUNDS)
+            {
+                cpuRelax();
+                return;
+            }
+            if (idle_rounds < BACKOFF_SPIN_ROUNDS + BACKOFF_YIELD_ROUNDS)
+            {
                 std::this_thread::yield();
+                return;
+            }
+            break;
+        case WaitStrategy::Block:
+            break;
+        }
+        uint32_t key = signal.prepareWait();
+        // Check again now that producers can see that the worker is parking.
+        if (!running || !queue.empty())
+        {
+            signal.cancelWait();
+            return;
         }
+        signal.wait(key);
     }
 
+    /**
+     * Pins the calling thread to a CPU core. Only supported on Linux, elsewhere threads are
+     * left unpinned.
+     *
+     * @param core the core to pin the thread to, require that the core exists.
+     */
+    static void pinToCore(uint32_t core)
+    {
+#ifdef __linux__
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(core, &cpu_set);
+        [[maybe_unused]] int result = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+        assert(result == 0 && "Failed to pin worker thread to core!");
+#endif
+    }
+
+    /**
+     * Wakes a worker thread if it is parked.
+     *
+     * @param queue_index the index of the queue of the worker thread.
+     */
+    void notifyWorker(uint32_t queue_index)
+    {
+        // Busy spinning workers never park.
+        if (wait_strategy != WaitStrategy::BusySpin)
+            thread_signals[queue_index]->notify();
+    }
+
+    /**
+     * Wakes all parked worker threads.
+     */
+    void notifyWorkers()
+    {
+        for (uint32_t i = 0; i < thread_signals.size(); ++i)
+            notifyWorker(i);
+    }
+
+    // The number of idle rounds a backoff worker spins for, and then yields for, before parking.
+    static constexpr uint32_t BACKOFF_SPIN_ROUNDS = 256;
+    static constexpr uint32_t BACKOFF_YIELD_ROUNDS = 64;
+
     // IMPORTANT: The running flag and the work queues must be declared
     // before the vector containing the threads. Otherwise, the queue and
     // the flag would be destroyed before the threads have finished their work.
@@ -185,12 +363,31 @@ private:
     std::atomic_bool running;
     // The number of worker threads in the thread pool - must be at least 1.
     uint32_t num_threads;
+    // How worker threads wait for tasks.
+    WaitStrategy wait_strategy;
+    // The core that each worker thread is pinned to, empty if the worker threads are not pinned.
+    std::vector<uint32_t> worker_cores;
+    // The number of tasks each bounded worker queue can hold.
+    size_t queue_capacity;
+    // The number of worker threads that have created their queues.
+    std::atomic<uint32_t> ready_workers;
     // Thread-safe queue for each worker thread.
-    std::vector<std::unique_ptr<Queue<std::function<void()>>>> thread_queues;
+    std::vector<std::unique_ptr<TaskQueue>> thread_queues;
+    // Wakes each worker thread when it is parked.
+    std::vector<std::unique_ptr<WorkerSignal>> thread_signals;
     // The worker threads and their corresponding queues - each thread gets its own queue.
     std::vector<std::thread> threads;
     // Handles cleaning up the worker threads when the thread pool is destroyed.
     ThreadJoiner thread_joiner;
 };
+
+// Tasks may be submitted from any number of threads concurrently, each worker queue is a
+// lock-free multi-producer single-consumer ring.
+using ThreadPool = BasicThreadPool<MPSCQueue<std::function<void()>>>;
+// Tasks must be submitted from one thread at a time, each worker queue is a lock-free
+// single-producer single-consumer ring.
+using SingleProducerThreadPool = BasicThreadPool<SPSCQueue<std::function<void()>>>;
+// Tasks may be submitted from any number of threads concurrently, each worker queue is guarded by a mutex.
+using LockingThreadPool = BasicThreadPool<Queue<std::function<void()>>>;
 } // namespace RapidTrader::Concurrent
 #endif // RAPID_TRADER_THREAD_POOL_H
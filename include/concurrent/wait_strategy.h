@@ -0,0 +1,135 @@
+#ifndef RAPID_TRADER_WAIT_STRATEGY_H
+#define RAPID_TRADER_WAIT_STRATEGY_H
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#ifdef __linux__
+#    include <linux/futex.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#else
+#    include <condition_variable>
+#    include <mutex>
+#endif
+
+namespace RapidTrader::Concurrent {
+/**
+ * Supported strategies for idle worker threads.
+ *
+ * BusySpin: the worker polls its queue in a tight loop. Lowest wake up latency,
+ * but each idle worker keeps a core fully busy. Intended for workers pinned to
+ * dedicated cores.
+ *
+ * Backoff: the worker spins for a short while, then yields for a short while,
+ * then parks until a task is submitted. Suitable for hosts where workers share
+ * cores with other threads.
+ *
+ * Block: the worker parks as soon as its queue is empty. Idle workers use no
+ * CPU, at the cost of a wake up on every task that arrives at an idle worker.
+ */
+enum class WaitStrategy
+{
+    BusySpin = 0,
+    Backoff = 1,
+    Block = 2
+};
+
+/**
+ * Tells the processor that the thread is spinning.
+ */
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/**
+ * Parks a single worker thread until another thread notifies it.
+ *
+ * The worker announces that it is about to park with prepareWait, checks its
+ * queue once more, and then either cancels or commits with wait. Producers call
+ * notify after every push, which only makes a system call if the worker has
+ * announced that it is parking. The announcement and the producer's check are
+ * both sequentially consistent, so a task pushed after the worker's last check
+ * of its queue always wakes the worker.
+ */
+class WorkerSignal
+{
+public:
+    /**
+     * Announces that the worker is about to park.
+     *
+     * @return the key that must be passed to wait.
+     */
+    uint32_t prepareWait()
+    {
+        uint32_t key = epoch.load(std::memory_order_acquire);
+        waiting.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return key;
+    }
+
+    /**
+     * Withdraws an announcement made by prepareWait.
+     */
+    void cancelWait()
+    {
+        waiting.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * Parks the worker until notify is called after the prepareWait call that returned
+     * key. May return spuriously.
+     *
+     * @param key the key returned by prepareWait.
+     */
+    void wait(uint32_t key)
+    {
+#ifdef __linux__
+        if (epoch.load(std::memory_order_acquire) == key)
+            syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch), FUTEX_WAIT_PRIVATE, key, nullptr, nullptr, 0);
+#else
+        std::unique_lock<std::mutex> lk(m);
+        c.wait(lk, [&] { return epoch.load(std::memory_order_acquire) != key; });
+#endif
+        waiting.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * Wakes the worker if it is parked or about to park. Must be called after the
+     * task that the worker should see has been pushed.
+     */
+    void notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!waiting.load(std::memory_order_relaxed))
+            return;
+#ifdef __linux__
+        epoch.fetch_add(1, std::memory_order_release);
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+        {
+            std::lock_guard<std::mutex> lk(m);
+            epoch.fetch_add(1, std::memory_order_release);
+        }
+        c.notify_one();
+#endif
+    }
+
+private:
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "The epoch must be usable as a futex word!");
+
+    // Incremented by every notify that finds the worker waiting.
+    std::atomic<uint32_t> epoch{0};
+    // True while the worker is between prepareWait and the end of wait or cancelWait.
+    std::atomic_bool waiting{false};
+#ifndef __linux__
+    std::mutex m;
+    std::condition_variable c;
+#endif
+};
+} // namespace RapidTrader::Concurrent
+#endif // RAPID_TRADER_WAIT_STRATEGY_H
@@ -0,0 +1,400 @@
+#ifndef RAPID_TRADER_ASYNC_EVENT_HANDLER_H
+#define RAPID_TRADER_ASYNC_EVENT_HANDLER_H
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "concurrent/ring_queue.h"
+#include "concurrent/wait_strategy.h"
+#include "event_handler/event_handler.h"
+
+namespace RapidTrader {
+/**
+ * Supported behaviours of an asynchronous event handler whose ring is full.
+ *
+ * Block: the matching thread waits until the publisher frees a slot. No events are
+ * lost, but a slow publisher stalls matching.
+ *
+ * Overflow: the event is appended to an unbounded overflow buffer guarded by a mutex,
+ * and later events follow it there until the publisher drains the buffer. No events
+ * are lost and matching never waits on the publisher, at the cost of an allocation
+ * and a lock while the ring is full.
+ *
+ * Shed: the event is dropped and counted. Matching never waits on the publisher.
+ */
+enum class FullRingPolicy
+{
+    Block = 0,
+    Overflow = 1,
+    Shed = 2
+};
+
+/**
+ * Describes the ring of an asynchronous event handler.
+ */
+struct EventRingConfig
+{
+    // The number of event records the ring holds, rounded up to a power of two.
+    size_t capacity = Concurrent::DEFAULT_RING_QUEUE_CAPACITY;
+    // What happens to events that arrive while the ring is full.
+    FullRingPolicy full_ring_policy = FullRingPolicy::Block;
+    // How the publisher thread waits for events when the ring is empty.
+    Concurrent::WaitStrategy wait_strategy = Concurrent::WaitStrategy::Backoff;
+};
+
+/**
+ * A snapshot of the counters of an asynchronous event handler.
+ */
+struct EventRingMetrics
+{
+    // The number of event records the ring holds.
+    size_t capacity;
+    // The number of event records in the ring when the snapshot was taken.
+    size_t occupancy;
+    // The largest number of event records the publisher has found in the ring at once.
+    size_t max_occupancy;
+    // The number of events handed to the downstream handler.
+    uint64_t published_events;
+    // The number of events that found the ring full and waited for a slot.
+    uint64_t blocked_events;
+    // The number of events that found the ring full or non-empty overflow buffer and were
+    // appended to the overflow buffer.
+    uint64_t overflowed_events;
+    // The number of events that found the ring full and were dropped.
+    uint64_t shed_events;
+};
+
+/**
+ * A fixed-size, trivially copyable copy of an event, so that events can be passed
+ * between threads through a ring without allocating.
+ */
+struct EventRecord
+{
+    struct OrderFields
+    {
+        uint64_t id;
+        uint64_t price;
+        uint64_t quantity;
+        uint64_t open_quantity;
+        uint64_t executed_quantity;
+        uint64_t last_executed_price;
+        uint64_t last_executed_quantity;
+        uint64_t stop_price;
+        uint64_t trail_amount;
+    };
+
+    struct TradeFields
+    {
+        uint64_t trade_seq;
+        uint64_t aggressor_id;
+        uint64_t passive_id;
+        uint64_t price;
+        uint64_t quantity;
+        uint64_t aggressor_open_quantity;
+        uint64_t passive_open_quantity;
+    };
+
+    // The header of an execution report, which is followed by a record for each order of
+    // the report and then a record for each fill.
+    struct ReportFields
+    {
+        uint32_t num_orders;
+        uint32_t num_fills;
+    };
+
+    EventType type;
+    // The side of the order, or the side of the aggressor of a trade.
+    OrderSide side;
+    OrderType order_type;
+    OrderTimeInForce time_in_force;
+    uint32_t symbol_id;
+    union
+    {
+        OrderFields order;
+        TradeFields trade;
+        ReportFields report;
+        // The name of the symbol of a symbol event. Owned by the record until it is published
+        // or dropped, symbol events are rare enough that their names are allocated.
+        std::string *symbol_name;
+    };
+
+    /**
+     * @param type_ the type of the order event.
+     * @param order_ the order of the event.
+     * @return a record of the order event.
+     */
+    static EventRecord fromOrder(EventType type_, const Order &order_)
+    {
+        EventRecord record{};
+        record.type = type_;
+        record.side = order_.side;
+        record.order_type = order_.type;
+        record.time_in_force = order_.time_in_force;
+        record.symbol_id = order_.symbol_id;
+        record.order = {order_.id, order_.price, order_.quantity, order_.open_quantity, order_.executed_quantity,
+            order_.last_executed_price, order_.last_executed_quantity, order_.stop_price, order_.trail_amount};
+        return record;
+    }
+
+    /**
+     * @param trade_ the trade.
+     * @return a record of the trade.
+     */
+    static EventRecord fromTrade(const Trade &trade_)
+    {
+        EventRecord record{};
+        record.type = EventType::Trade;
+        record.side = trade_.aggressor_side;
+        record.symbol_id = trade_.symbol_id;
+        record.trade = {trade_.trade_seq, trade_.aggressor_id, trade_.passive_id, trade_.price, trade_.quantity,
+            trade_.aggressor_open_quantity, trade_.passive_open_quantity};
+        return record;
+    }
+
+    /**
+     * @param type_ the type of the symbol event.
+     * @param symbol_id_ the symbol ID of the event.
+     * @param name the name of the symbol.
+     * @return a record of the symbol event that owns a copy of the symbol name.
+     */
+    static EventRecord fromSymbol(EventType type_, uint32_t symbol_id_, const std::string &name)
+    {
+        EventRecord record{};
+        record.type = type_;
+        record.symbol_id = symbol_id_;
+        record.symbol_name = new std::string(name);
+        return record;
+    }
+
+    /**
+     * @param report_ the execution report.
+     * @return the header record of the execution report.
+     */
+    static EventRecord fromReport(const ExecutionReport &report_)
+    {
+        EventRecord record{};
+        record.type = EventType::ExecutionReport;
+        record.symbol_id = report_.symbol_id;
+        record.report = {static_cast<uint32_t>(report_.orders.size()), static_cast<uint32_t>(report_.fills.size())};
+        return record;
+    }
+
+    /**
+     * @return the order of an order event record.
+     */
+    [[nodiscard]] Order toOrder() const;
+
+    /**
+     * @return the trade of a trade record.
+     */
+    [[nodiscard]] Trade toTrade() const;
+};
+
+static_assert(std::is_trivially_copyable_v<EventRecord>, "Event records must be copyable between threads without allocating!");
+
+/**
+ * An event handler that moves event handling off the matching thread.
+ *
+ * The matching thread copies each event into a fixed-size record on a single-producer
+ * single-consumer ring, and a publisher thread owned by the handler pops the records and
+ * hands the events to a downstream handler, such as one that serializes them and sends
+ * them to a message broker. Events reach the downstream handler in the order they were
+ * raised. The handler is final, so that orderbooks bound to it inline the copy into the
+ * ring.
+ *
+ * An execution report is copied into a header record followed by a record for each of its
+ * orders and fills, and is reassembled on the publisher thread. Under the shed policy, a
+ * report is shed whole unless the ring has space for all of its records.
+ *
+ * Events must be raised by one thread at a time, as they are by the orderbooks of a single
+ * market or concurrent market worker.
+ */
+class AsyncEventHandler final : public EventHandler
+{
+public:
+    /**
+     * A constructor for the AsyncEventHandler. Starts the publisher thread.
+     *
+     * @param downstream_ handles the events on the publisher thread.
+     * @param config_ describes the ring.
+     */
+    explicit AsyncEventHandler(std::unique_ptr<EventHandler> downstream_, const EventRingConfig &config_ = {});
+
+    /**
+     * Publishes every event that has been raised, then stops the publisher thread.
+     */
+    ~AsyncEventHandler() override;
+
+    /**
+     * Waits until every event raised so far, that has not been shed, has been handed to the
+     * downstream handler. Must be called by the thread that raises events.
+     */
+    void flush();
+
+    /**
+     * May be called from any thread.
+     *
+     * @return a snapshot of the counters of the handler.
+     */
+    [[nodiscard]] EventRingMetrics getMetrics() const;
+
+    friend class OrderBookHandler;
+    template<typename Handler, typename Price, typename Quantity>
+    friend class BasicMapOrderBook;
+    template<typename Handler>
+    friend class BasicArrayOrderBook;
+
+protected:
+    [[nodiscard]] bool handlesTrades() const override
+    {
+        return handles_trades;
+    }
+
+    [[nodiscard]] bool handlesExecutionReports() const override
+    {
+        return handles_execution_reports;
+    }
+
+    void handleOrderAdded(const OrderAdded &event) override
+    {
+        push(EventRecord::fromOrder(EventType::OrderAdded, event.order));
+    }
+
+    void handleOrderDeleted(const OrderDeleted &event) override
+    {
+        push(EventRecord::fromOrder(EventType::OrderDeleted, event.order));
+    }
+
+    void handleOrderUpdated(const OrderUpdated &event) override
+    {
+        push(EventRecord::fromOrder(EventType::OrderUpdated, event.order));
+    }
+
+    void handleOrderExecuted(const ExecutedOrder &event) override
+    {
+        push(EventRecord::fromOrder(EventType::OrderExecuted, event.order));
+    }
+
+    void handleTrade(const Trade &event) override
+    {
+        push(EventRecord::fromTrade(event));
+    }
+
+    void handleSymbolAdded(const SymbolAdded &event) override
+    {
+        push(EventRecord::fromSymbol(EventType::SymbolAdded, event.symbol_id, event.name));
+    }
+
+    void handleSymbolDeleted(const SymbolDeleted &event) override
+    {
+        push(EventRecord::fromSymbol(EventType::SymbolDeleted, event.symbol_id, event.name));
+    }
+
+    void handleExecutionReport(const ExecutionReport &event) override;
+
+private:
+    /**
+     * Pushes a record onto the ring, applying the full ring policy if there is no space.
+     *
+     * @param record the record to push.
+     */
+    void push(EventRecord record)
+    {
+        if (overflow_size.load(std::memory_order_acquire) == 0 && ring.tryPush(record))
+        {
+            pushed_events.store(pushed_events.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            notifyPublisher();
+            return;
+        }
+        pushFull(record);
+    }
+
+    /**
+     * Applies the full ring policy to a record that could not be pushed onto the ring.
+     *
+     * @param record the record.
+     */
+    void pushFull(EventRecord &record);
+
+    /**
+     * Pops records and hands them to the downstream handler until the handler is destroyed.
+     */
+    void publisherThread();
+
+    /**
+     * Hands the event of a record to the downstream handler.
+     *
+     * @param record the record.
+     */
+    void publish(const EventRecord &record);
+
+    /**
+     * Adds a record that follows the header of an execution report to the report that is being
+     * reassembled, and hands the report to the downstream handler once it is complete.
+     *
+     * @param record the record.
+     */
+    void publishReportRecord(const EventRecord &record);
+
+    /**
+     * Waits for records according to the wait strategy of the ring. May return before a record
+     * has been pushed.
+     *
+     * @param idle_rounds the number of consecutive times the ring has been found empty.
+     */
+    void waitForRecords(uint32_t idle_rounds);
+
+    /**
+     * Wakes the publisher thread if it is parked.
+     */
+    void notifyPublisher()
+    {
+        // Busy spinning publishers never park.
+        if (wait_strategy != Concurrent::WaitStrategy::BusySpin)
+            publisher_signal.notify();
+    }
+
+    // Frees the symbol name of a record that will not be published.
+    static void dropRecord(EventRecord &record);
+
+    // The number of idle rounds a backoff publisher spins for, and then yields for, before parking.
+    static constexpr uint32_t BACKOFF_SPIN_ROUNDS = 256;
+    static constexpr uint32_t BACKOFF_YIELD_ROUNDS = 64;
+
+    std::unique_ptr<EventHandler> downstream;
+    const bool handles_trades;
+    const bool handles_execution_reports;
+    const FullRingPolicy full_ring_policy;
+    const Concurrent::WaitStrategy wait_strategy;
+    Concurrent::SPSCQueue<EventRecord> ring;
+    Concurrent::WorkerSignal publisher_signal;
+    // Records that arrived while the ring was full, in the order they arrived. Only used by
+    // the overflow policy.
+    std::mutex overflow_mutex;
+    std::vector<EventRecord> overflow;
+    // The number of records in the overflow buffer. While it is positive every record goes to
+    // the overflow buffer, so that records stay in order.
+    std::atomic<size_t> overflow_size{0};
+    // Counters written by the thread that raises events.
+    alignas(Concurrent::CACHE_LINE_SIZE) std::atomic<uint64_t> pushed_events{0};
+    std::atomic<uint64_t> blocked_events{0};
+    std::atomic<uint64_t> overflowed_events{0};
+    std::atomic<uint64_t> shed_events{0};
+    // Counters written by the publisher thread.
+    alignas(Concurrent::CACHE_LINE_SIZE) std::atomic<uint64_t> published_events{0};
+    std::atomic<size_t> max_occupancy{0};
+    // The execution report that is being reassembled by the publisher thread, and the number of
+    // its records that have yet to be published.
+    ExecutionReport report{0};
+    size_t remaining_report_records = 0;
+    // Cleared when the handler is destroyed.
+    std::atomic_bool running{true};
+    // IMPORTANT: The publisher thread must be declared last, so that it is started after, and
+    // joined before, everything it uses.
+    std::thread publisher;
+};
+} // namespace RapidTrader
+#endif // RAPID_TRADER_ASYNC_EVENT_HANDLER_H
@@ -0,0 +1,215 @@
+#ifndef RAPID_TRADER_BATCHING_EVENT_HANDLER_H
+#define RAPID_TRADER_BATCHING_EVENT_HANDLER_H
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "event_handler/event_handler.h"
+#include "event_handler/event_serializer.h"
+#include "event_handler/message_producer.h"
+#include "utils/buffer_pool.h"
+
+namespace RapidTrader {
+/**
+ * Describes how a batching event handler coalesces events into messages.
+ */
+struct BatchConfig
+{
+    // The format that events are serialized to. JSON events in a batch are separated by a
+    // newline, binary events have a fixed size and are simply concatenated.
+    EventFormat format = EventFormat::Json;
+    // The most events a message holds. If one, every event is sent in its own message keyed
+    // by its order ID, exactly as events were sent before they were batched.
+    size_t max_batch_events = 64;
+    // The longest time an event waits in a batch that is not full before the batch is sent.
+    std::chrono::microseconds max_batch_delay{500};
+    // The number of messages that may be waiting for their delivery to be reported. Once they
+    // are all in flight, events wait for a delivery report.
+    size_t max_in_flight_batches = 256;
+    // If true, orderbooks report each fill as a single trade instead of as an executed order
+    // event for each of the two orders. Off by default, which keeps the published events.
+    bool trade_events = false;
+    // If true, orderbooks report each command as a single execution report instead of as the
+    // order events and trades it caused.
+    bool execution_reports = false;
+    // The key of every batch message. Batches that share a key are sent to the same partition,
+    // so a handler that always uses the same key keeps its events in order.
+    std::string batch_key;
+};
+
+/**
+ * A snapshot of the counters of a batching event handler.
+ */
+struct BatchMetrics
+{
+    // The number of events that have been added to a batch.
+    uint64_t batched_events;
+    // The number of messages that have been produced.
+    uint64_t produced_messages;
+    // The number of messages whose delivery has been reported as failed.
+    uint64_t failed_messages;
+};
+
+/**
+ * An event handler that serializes order events and trades, coalesces them into batches,
+ * and hands each batch to a message producer as a single message.
+ *
+ * A batch is sent once it holds max_batch_events events, or once its first event has waited
+ * max_batch_delay, whichever comes first. An execution report counts as one event, and a
+ * report too large for a buffer is copied into a message of its own. Batches are serialized
+ * into buffers from a pool that is allocated up front, the producer is given the buffer
+ * without copying it, and the buffer is returned to the pool when the producer reports the
+ * delivery of the message. A delivery thread owned by the handler serves the delivery reports
+ * of the producer and sends batches that have waited long enough.
+ *
+ * Events must be raised by one thread at a time, such as the publisher thread of an
+ * asynchronous event handler.
+ */
+class BatchingEventHandler : public EventHandler
+{
+public:
+    /**
+     * A constructor for the BatchingEventHandler. Starts the delivery thread.
+     *
+     * @param producer_ sends the batches.
+     * @param config_ describes how events are batched, require that max_batch_events and
+     *                max_in_flight_batches are positive.
+     */
+    explicit BatchingEventHandler(std::unique_ptr<MessageProducer> producer_, BatchConfig config_ = {});
+
+    /**
+     * Sends the batch that is being filled, waits for the producer to deliver every message,
+     * and stops the delivery thread.
+     */
+    ~BatchingEventHandler() override;
+
+    /**
+     * Sends the batch that is being filled now, without waiting for it to fill up or age.
+     */
+    void flush();
+
+    /**
+     * May be called from any thread.
+     *
+     * @return a snapshot of the counters of the handler.
+     */
+    [[nodiscard]] BatchMetrics getMetrics() const;
+
+protected:
+    [[nodiscard]] bool handlesTrades() const override
+    {
+        return config.trade_events;
+    }
+
+    [[nodiscard]] bool handlesExecutionReports() const override
+    {
+        return config.execution_reports;
+    }
+
+    void handleOrderAdded(const OrderAdded &event) override
+    {
+        append(serializer.key(event.order.getOrderID()), serializer.serialize(event));
+    }
+
+    void handleOrderDeleted(const OrderDeleted &event) override
+    {
+        append(serializer.key(event.order.getOrderID()), serializer.serialize(event));
+    }
+
+    void handleOrderUpdated(const OrderUpdated &event) override
+    {
+        append(serializer.key(event.order.getOrderID()), serializer.serialize(event));
+    }
+
+    void handleOrderExecuted(const ExecutedOrder &event) override
+    {
+        append(serializer.key(event.order.getOrderID()), serializer.serialize(event));
+    }
+
+    void handleTrade(const Trade &event) override
+    {
+        append(serializer.key(event.aggressor_id), serializer.serialize(event));
+    }
+
+    void handleExecutionReport(const ExecutionReport &event) override
+    {
+        // A report is keyed by the order that its command was for.
+        append(serializer.key(event.orders.empty() ? 0 : event.orders.front().order.getOrderID()), serializer.serialize(event));
+    }
+
+private:
+    /**
+     * Adds a serialized event to the batch that is being filled, starting a new batch if there is
+     * none, and sends the batch if it is full.
+     *
+     * Takes the batch mutex for each event. The delivery thread must be able to send a batch that
+     * has aged while no events arrive, so it shares the batch with the thread raising events.
+     * The delivery thread only takes the mutex once per poll interval, so the lock is almost
+     * never contended and costs an uncontended atomic exchange.
+     *
+     * @param key the key of the event, only used if every event is sent in its own message.
+     * @param event the serialized event.
+     */
+    void append(std::string_view key, std::string_view event);
+
+    /**
+     * Sends the batch that is being filled as a single message, require that the caller holds
+     * the batch mutex and that there is a batch.
+     *
+     * @param key the key of the message.
+     */
+    void sendBatch(std::string_view key);
+
+    /**
+     * Sends an event that does not fit in a buffer of the pool as a message of its own, from a
+     * copy that is freed when its delivery is reported. Require that the caller holds the batch
+     * mutex and that there is no batch.
+     *
+     * @param key the key of the message.
+     * @param event the serialized event.
+     */
+    void sendOversized(std::string_view key, std::string_view event);
+
+    /**
+     * Serves delivery reports, and sends batches that have waited long enough, until the
+     * handler is destroyed.
+     */
+    void deliveryThread();
+
+    // The longest time the delivery thread waits between polls for delivery reports.
+    static constexpr std::chrono::milliseconds DELIVERY_POLL_INTERVAL{1};
+    // The longest time the destructor waits for the producer to deliver every message.
+    static constexpr int FLUSH_TIMEOUT_MS = 5000;
+
+    const BatchConfig config;
+    EventSerializer serializer;
+    // IMPORTANT: The pool must be declared before the producer, so that buffers that are still
+    // in flight when the producer is destroyed remain valid until it reports their delivery.
+    BufferPool pool;
+    std::unique_ptr<MessageProducer> producer;
+    // Guards the batch that is being filled, which is sent by the thread that raises events when
+    // it fills up and by the delivery thread when it ages.
+    std::mutex batch_mutex;
+    // Woken when a batch is started or the handler is destroyed.
+    std::condition_variable batch_started;
+    // The buffer of the batch that is being filled, nullptr if there is none.
+    char *batch;
+    size_t batch_size;
+    size_t batch_events;
+    // When the first event was added to the batch that is being filled.
+    std::chrono::steady_clock::time_point batch_start;
+    std::atomic<uint64_t> batched_events{0};
+    std::atomic<uint64_t> produced_messages{0};
+    std::atomic<uint64_t> failed_messages{0};
+    // Cleared when the handler is destroyed.
+    bool running;
+    // IMPORTANT: The delivery thread must be declared last, so that it is started after, and
+    // joined before, everything it uses.
+    std::thread delivery;
+};
+} // namespace RapidTrader
+#endif // RAPID_TRADER_BATCHING_EVENT_HANDLER_H
@@ -3,8 +3,25 @@
 #define RAPID_TRADER_EVENT_H
 #include "matching/orderbook/order.h"
 #include <utility>
+#include <vector>
 
 namespace RapidTrader {
+/**
+ * Identifies the type of an event once it has been copied out of its event struct, for
+ * example into a ring or onto the wire.
+ */
+enum class EventType : uint8_t
+{
+    OrderAdded = 0,
+    OrderDeleted = 1,
+    OrderUpdated = 2,
+    OrderExecuted = 3,
+    Trade = 4,
+    SymbolAdded = 5,
+    SymbolDeleted = 6,
+    ExecutionReport = 7
+};
+
 struct Event
 {
     virtual ~Event() = default;
@@ -83,5 +100,134 @@ struct OrderUpdated : public OrderEvent
 
     friend std::ostream &operator<<(std::ostream &os, const OrderUpdated &notification);
 };
+
+/**
+ * A single fill between an incoming order and an order resting in the book. Only
+ * emitted to event handlers that opt in to trade events, in place of the two
+ * ExecutedOrder events that would otherwise describe the fill.
+ */
+struct Trade : public MarketEvent
+{
+    // The sequence number of the trade, starting from one for each symbol.
+    uint64_t trade_seq;
+    // The ID of the incoming order.
+    uint64_t aggressor_id;
+    // The ID of the resting order.
+    uint64_t passive_id;
+    uint64_t price;
+    uint64_t quantity;
+    // The open quantities of the orders after the fill.
+    uint64_t aggressor_open_quantity;
+    uint64_t passive_open_quantity;
+    // The side of the incoming order.
+    OrderSide aggressor_side;
+
+    template<typename Price, typename Quantity>
+    Trade(uint32_t symbol_id_, uint64_t trade_seq_, const BasicOrder<Price, Quantity> &aggressor, const BasicOrder<Price, Quantity> &passive)
+        : MarketEvent(symbol_id_)
+        , trade_seq(trade_seq_)
+        , aggressor_id(aggressor.getOrderID())
+        , passive_id(passive.getOrderID())
+        , price(passive.getLastExecutedPrice())
+        , quantity(passive.getLastExecutedQuantity())
+        , aggressor_open_quantity(aggressor.getOpenQuantity())
+        , passive_open_quantity(passive.getOpenQuantity())
+        , aggressor_side(aggressor.getSide())
+    {}
+
+    Trade(uint32_t symbol_id_, uint64_t trade_seq_, uint64_t aggressor_id_, uint64_t passive_id_, uint64_t price_, uint64_t quantity_,
+        uint64_t aggressor_open_quantity_, uint64_t passive_open_quantity_, OrderSide aggressor_side_)
+        : MarketEvent(symbol_id_)
+        , trade_seq(trade_seq_)
+        , aggressor_id(aggressor_id_)
+        , passive_id(passive_id_)
+        , price(price_)
+        , quantity(quantity_)
+        , aggressor_open_quantity(aggressor_open_quantity_)
+        , passive_open_quantity(passive_open_quantity_)
+        , aggressor_side(aggressor_side_)
+    {}
+
+    friend std::ostream &operator<<(std::ostream &os, const Trade &notification);
+};
+
+/**
+ * The state of an order once a command has completed.
+ */
+struct OrderReport
+{
+    Order order;
+    // True if the order rests in the book once the command has completed, and false if it
+    // was filled, deleted, or never rested.
+    bool resting;
+};
+
+/**
+ * Everything that a single command caused in an orderbook. Only emitted to event handlers
+ * that opt in to execution reports, once for each command, in place of the order events
+ * and trades that would otherwise describe the command.
+ */
+struct ExecutionReport : public MarketEvent
+{
+    // The orders that the command added, updated, executed, deleted, or triggered, in the
+    // order they were first affected, so the order that the command was for comes first.
+    // Each order appears once. Resting orders that were only filled against by the command
+    // are described by their fills alone.
+    std::vector<OrderReport> orders;
+    // Every fill caused by the command, in the order they occurred.
+    std::vector<Trade> fills;
+
+    explicit ExecutionReport(uint32_t symbol_id_)
+        : MarketEvent(symbol_id_)
+    {}
+
+    /**
+     * Records the state of an order affected by the command, replacing any state recorded
+     * for the order earlier in the command.
+     *
+     * @param order the order.
+     */
+    void recordOrder(const Order &order)
+    {
+        if (!updateOrder(order))
+            orders.push_back(OrderReport{order, false});
+    }
+
+    /**
+     * Replaces the state recorded for an order earlier in the command.
+     *
+     * @param order the order.
+     * @return true if a state was recorded for the order, and false otherwise.
+     */
+    bool updateOrder(const Order &order)
+    {
+        // Commands affect a handful of orders, so a linear search beats hashing.
+        for (OrderReport &order_report : orders)
+        {
+            if (order_report.order.getOrderID() == order.getOrderID())
+            {
+                order_report.order = order;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Clears the report for the next command, keeping the memory of its vectors.
+     */
+    void clear()
+    {
+        orders.clear();
+        fills.clear();
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return orders.empty() && fills.empty();
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const ExecutionReport &notification);
+};
 } // namespace RapidTrader
 #endif // RAPID_TRADER_EVENT_H
\ No newline at end of file
@@ -7,7 +7,11 @@
 
 namespace RapidTrader {
 class OrderBookHandler;
-class MapOrderBook;
+class AsyncEventHandler;
+template<typename Handler, typename Price, typename Quantity>
+class BasicMapOrderBook;
+template<typename Handler>
+class BasicArrayOrderBook;
 
 class EventHandler
 {
@@ -20,16 +24,81 @@ public:
     virtual ~EventHandler() = default;
 
     friend class OrderBookHandler;
-    friend class MapOrderBook;
+    friend class AsyncEventHandler;
+    template<typename Handler, typename Price, typename Quantity>
+    friend class BasicMapOrderBook;
+    template<typename Handler>
+    friend class BasicArrayOrderBook;
 
 protected:
+    /**
+     * Handlers that return true receive a single Trade event for each fill between an
+     * incoming and a resting order, instead of an ExecutedOrder event for each of the two
+     * orders. Executions of a single order through executeOrder are still reported as
+     * ExecutedOrder events. Orderbooks query this once, when they are created.
+     *
+     * @return true if the handler handles trade events and false otherwise.
+     */
+    [[nodiscard]] virtual bool handlesTrades() const
+    {
+        return false;
+    }
+
+    /**
+     * Handlers that return true receive a single ExecutionReport for each command that an
+     * orderbook processes, instead of the order events, executions, and trades caused by the
+     * command. Symbol events are still reported individually. Orderbooks query this once,
+     * when they are created.
+     *
+     * @return true if the handler handles execution reports and false otherwise.
+     */
+    [[nodiscard]] virtual bool handlesExecutionReports() const
+    {
+        return false;
+    }
+
     // LCOV_EXCL_START
     virtual void handleOrderAdded(const OrderAdded &event) {}
     virtual void handleOrderDeleted(const OrderDeleted &event) {}
     virtual void handleOrderUpdated(const OrderUpdated &event) {}
     virtual void handleOrderExecuted(const ExecutedOrder &event) {}
+    virtual void handleTrade(const Trade &event) {}
     virtual void handleSymbolAdded(const SymbolAdded &event) {}
     virtual void handleSymbolDeleted(const SymbolDeleted &event) {}
+    virtual void handleExecutionReport(const ExecutionReport &event) {}
+    // LCOV_EXCL_STOP
+};
+
+/**
+ * An event handler that ignores all events. It is final, so orderbooks that are bound
+ * to it at compile time inline its handle methods away entirely.
+ *
+ * Any final event handler can be bound at compile time in the same way, provided it
+ * grants the orderbook templates access to its handle methods like this class does.
+ */
+class NullEventHandler final : public EventHandler
+{
+    friend class OrderBookHandler;
+    template<typename Handler, typename Price, typename Quantity>
+    friend class BasicMapOrderBook;
+    template<typename Handler>
+    friend class BasicArrayOrderBook;
+
+protected:
+    [[nodiscard]] bool handlesTrades() const override
+    {
+        return true;
+    }
+
+    // LCOV_EXCL_START
+    void handleOrderAdded(const OrderAdded &event) override {}
+    void handleOrderDeleted(const OrderDeleted &event) override {}
+    void handleOrderUpdated(const OrderUpdated &event) override {}
+    void handleOrderExecuted(const ExecutedOrder &event) override {}
+    void handleTrade(const Trade &event) override {}
+    void handleSymbolAdded(const SymbolAdded &event) override {}
+    void handleSymbolDeleted(const SymbolDeleted &event) override {}
+    void handleExecutionReport(const ExecutionReport &event) override {}
     // LCOV_EXCL_STOP
 };
 } // namespace RapidTrader
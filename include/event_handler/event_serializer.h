@@ -0,0 +1,121 @@
+#ifndef RAPID_TRADER_EVENT_SERIALIZER_H
+#define RAPID_TRADER_EVENT_SERIALIZER_H
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "event_handler/event.h"
+
+namespace RapidTrader {
+/**
+ * Supported wire formats of serialized events.
+ *
+ * Json: {"data":{...},"event_type":"..."} with the keys of each object in lexicographic
+ * order, the schema that the Kafka event handler has always published.
+ *
+ * Binary: a fixed-layout little-endian record of BINARY_EVENT_SIZE bytes. Byte 0 is
+ * BINARY_EVENT_MAGIC and byte 1 is the EventType. For order events, byte 2 is the side,
+ * byte 3 the order type, bytes 4-7 the symbol ID, and bytes 8-63 the order ID, price,
+ * quantity, open quantity, executed quantity, last executed price, and last executed
+ * quantity. For trades, byte 2 is the side of the aggressor, byte 3 is zero, bytes 4-7 the
+ * symbol ID, and bytes 8-63 the trade sequence number, aggressor ID, passive ID, price,
+ * quantity, open quantity of the aggressor, and open quantity of the passive order. An
+ * execution report is a header record, in which bytes 4-7 are the symbol ID, bytes 8-11 the
+ * number of orders, and bytes 12-15 the number of fills, followed by an order record for each
+ * order and a trade record for each fill. The type of an order record of a report is
+ * OrderUpdated if the order rests in the book, and OrderDeleted otherwise.
+ */
+enum class EventFormat
+{
+    Json = 0,
+    Binary = 1
+};
+
+// The first byte of every binary event, which no JSON event starts with.
+constexpr uint8_t BINARY_EVENT_MAGIC = 0xEB;
+// The size in bytes of every binary event.
+constexpr size_t BINARY_EVENT_SIZE = 64;
+
+/**
+ * Serializes order and trade events into a buffer owned by the serializer, without allocating.
+ * Each serialized event, and each key, is valid until the next call that serializes into the
+ * same buffer, so a serializer must only be used by one thread at a time.
+ */
+class EventSerializer
+{
+public:
+    /**
+     * A constructor for the EventSerializer.
+     *
+     * @param format_ the format that events are serialized to.
+     */
+    explicit EventSerializer(EventFormat format_ = EventFormat::Json)
+        : format(format_)
+    {}
+
+    /**
+     * @param event an order event.
+     * @return the serialized event.
+     */
+    std::string_view serialize(const OrderAdded &event)
+    {
+        return serializeOrder(EventType::OrderAdded, event.order);
+    }
+
+    std::string_view serialize(const OrderDeleted &event)
+    {
+        return serializeOrder(EventType::OrderDeleted, event.order);
+    }
+
+    std::string_view serialize(const OrderUpdated &event)
+    {
+        return serializeOrder(EventType::OrderUpdated, event.order);
+    }
+
+    std::string_view serialize(const ExecutedOrder &event)
+    {
+        return serializeOrder(EventType::OrderExecuted, event.order);
+    }
+
+    /**
+     * @param event a trade.
+     * @return the serialized trade.
+     */
+    std::string_view serialize(const Trade &event);
+
+    /**
+     * Serializes a report into a buffer that grows to fit the largest report serialized so
+     * far, so only reports larger than any before them allocate.
+     *
+     * @param event an execution report.
+     * @return the serialized report.
+     */
+    std::string_view serialize(const ExecutionReport &event);
+
+    /**
+     * @param order_id the ID of an order.
+     * @return the decimal representation of the ID, used as the message key of its events.
+     */
+    std::string_view key(uint64_t order_id);
+
+    /**
+     * @return the format that events are serialized to.
+     */
+    [[nodiscard]] EventFormat getFormat() const
+    {
+        return format;
+    }
+
+    // Longer than the longest JSON event, in which every number has 20 digits.
+    static constexpr size_t MAX_EVENT_SIZE = 512;
+
+private:
+    std::string_view serializeOrder(EventType type, const Order &order);
+
+    EventFormat format;
+    std::array<char, MAX_EVENT_SIZE> buffer;
+    std::vector<char> report_buffer;
+    std::array<char, 20> key_buffer;
+};
+} // namespace RapidTrader
+#endif // RAPID_TRADER_EVENT_SERIALIZER_H
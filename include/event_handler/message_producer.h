@@ -0,0 +1,140 @@
+#ifndef RAPID_TRADER_MESSAGE_PRODUCER_H
+#define RAPID_TRADER_MESSAGE_PRODUCER_H
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace RapidTrader {
+/**
+ * Sends messages to a message broker without copying their payloads.
+ *
+ * A payload must stay valid until the producer reports its delivery. Delivery reports are
+ * served by poll and flush, on the thread that calls them, by invoking the delivery callback
+ * with the opaque pointer that the message was produced with.
+ */
+class MessageProducer
+{
+public:
+    /**
+     * Called once for every produced message, when the producer no longer needs its payload.
+     * The first argument is the opaque pointer of the message, and the second is true if the
+     * message was delivered and false if delivery failed.
+     */
+    using DeliveryCallback = std::function<void(void *, bool)>;
+
+    virtual ~MessageProducer() = default;
+
+    /**
+     * Sets the callback that delivery reports are passed to. Must be called before the
+     * first message is produced.
+     *
+     * @param delivery_callback_ the callback.
+     */
+    void setDeliveryCallback(DeliveryCallback delivery_callback_)
+    {
+        delivery_callback = std::move(delivery_callback_);
+    }
+
+    /**
+     * Queues a message for delivery. Does not copy the payload.
+     *
+     * @param key the key of the message, it is copied.
+     * @param payload the payload of the message, require that it stays valid until the
+     *                delivery of the message is reported.
+     * @param opaque passed to the delivery callback when the delivery of the message is reported.
+     * @return true if the message was queued, or failed and its delivery was reported as
+     *         failed, false if the producer's queue is full and the message should be produced
+     *         again after polling. The delivery of messages that are not queued is not reported.
+     */
+    virtual bool produce(std::string_view key, std::string_view payload, void *opaque) = 0;
+
+    /**
+     * Serves delivery reports.
+     *
+     * @param timeout_ms the longest time to wait for a delivery report in milliseconds.
+     */
+    virtual void poll(int timeout_ms) = 0;
+
+    /**
+     * Waits for every queued message to be delivered, serving delivery reports.
+     *
+     * @param timeout_ms the longest time to wait in milliseconds.
+     * @return true if every message was delivered within the timeout and false otherwise.
+     */
+    virtual bool flush(int timeout_ms) = 0;
+
+protected:
+    /**
+     * Reports the delivery of a message to the delivery callback.
+     *
+     * @param opaque the opaque pointer the message was produced with.
+     * @param delivered true if the message was delivered and false if delivery failed.
+     */
+    void reportDelivery(void *opaque, bool delivered)
+    {
+        if (delivery_callback)
+            delivery_callback(opaque, delivered);
+    }
+
+private:
+    DeliveryCallback delivery_callback;
+};
+
+/**
+ * A message producer that appends messages to a file instead of sending them to a broker,
+ * so that publishing can be run and checked without a broker. Each message is written as
+ * the 4-byte little-endian size of its key, the 4-byte little-endian size of its payload,
+ * the key, and the payload. Messages are delivered as soon as they are written, and their
+ * deliveries are reported by the next call to poll or flush. Poll waits for a message to be
+ * written if there is no delivery to report, flush never has to wait.
+ */
+class FileMessageProducer : public MessageProducer
+{
+public:
+    /**
+     * A constructor for the FileMessageProducer. Creates a new file, or truncates an
+     * existing one.
+     *
+     * @param path the path of the file.
+     */
+    explicit FileMessageProducer(const std::string &path);
+
+    FileMessageProducer(const FileMessageProducer &) = delete;
+    FileMessageProducer &operator=(const FileMessageProducer &) = delete;
+
+    /**
+     * Reports any undelivered messages and closes the file.
+     */
+    ~FileMessageProducer() override;
+
+    bool produce(std::string_view key, std::string_view payload, void *opaque) override;
+
+    void poll(int timeout_ms) override;
+
+    bool flush(int timeout_ms) override;
+
+    /**
+     * Reads back the messages written by a file message producer.
+     *
+     * @param path the path of the file.
+     * @return the key and payload of each message in the order they were produced.
+     */
+    static std::vector<std::pair<std::string, std::string>> readMessages(const std::string &path);
+
+private:
+    // Guards the file and the undelivered messages, since messages may be produced and
+    // polled from different threads.
+    std::mutex mutex;
+    std::FILE *file;
+    // Woken when a message is written.
+    std::condition_variable produced;
+    // The opaque pointers of messages that have been written but whose delivery has not been reported.
+    std::vector<void *> undelivered;
+};
+} // namespace RapidTrader
+#endif // RAPID_TRADER_MESSAGE_PRODUCER_H
@@ -0,0 +1,129 @@
+// //match_engine/include/matching/market/binary_command.h
+#ifndef RAPID_TRADER_BINARY_COMMAND_H
+#define RAPID_TRADER_BINARY_COMMAND_H
+#include <cstddef>
+#include <cstdint>
+#include "matching/orderbook/order.h"
+
+namespace RapidTrader {
+/**
+ * Supported operations of inbound binary commands.
+ *
+ * AddOrder: adds an order to the book of a symbol.
+ *
+ * CancelOrder: deletes an order from the book of a symbol. Only the symbol ID and
+ * order ID of the command are used.
+ */
+enum class BinaryOperation : uint8_t
+{
+    AddOrder = 1,
+    CancelOrder = 2
+};
+
+// The first byte of every binary command, which no JSON command starts with.
+constexpr uint8_t BINARY_COMMAND_MAGIC = 0xCB;
+// The size in bytes of every binary command.
+constexpr size_t BINARY_COMMAND_SIZE = 40;
+
+/**
+ * An inbound command in a fixed-layout little-endian format, decoded without allocating.
+ *
+ * Byte 0 is BINARY_COMMAND_MAGIC, byte 1 the operation, byte 2 the side, byte 3 the order
+ * type, byte 4 the time in force, and bytes 5-7 are zero. Bytes 8-11 are the symbol ID and
+ * bytes 12-15 are zero. Bytes 16-39 are the order ID, price, and quantity. Enumerations
+ * are encoded by their underlying values.
+ */
+struct BinaryCommand
+{
+    BinaryOperation operation;
+    OrderSide side;
+    OrderType order_type;
+    OrderTimeInForce time_in_force;
+    uint32_t symbol_id;
+    uint64_t order_id;
+    uint64_t price;
+    uint64_t quantity;
+
+    /**
+     * @param data the payload of a message.
+     * @param size the size of the payload in bytes.
+     * @return true if the payload is a binary command, and false if it should be parsed as JSON.
+     */
+    static bool isBinary(const char *data, size_t size)
+    {
+        return size > 0 && static_cast<uint8_t>(data[0]) == BINARY_COMMAND_MAGIC;
+    }
+
+    /**
+     * Decodes a binary command.
+     *
+     * @param data the payload of a message, require that isBinary is true for the payload.
+     * @param size the size of the payload in bytes.
+     * @param command set to the decoded command.
+     * @return true if the payload is a well-formed command, and false otherwise.
+     */
+    static bool decode(const char *data, size_t size, BinaryCommand &command)
+    {
+        if (size != BINARY_COMMAND_SIZE)
+            return false;
+        uint8_t operation = static_cast<uint8_t>(data[1]);
+        uint8_t side = static_cast<uint8_t>(data[2]);
+        uint8_t order_type = static_cast<uint8_t>(data[3]);
+        uint8_t time_in_force = static_cast<uint8_t>(data[4]);
+        if (operation < static_cast<uint8_t>(BinaryOperation::AddOrder) || operation > static_cast<uint8_t>(BinaryOperation::CancelOrder) ||
+            side > static_cast<uint8_t>(OrderSide::Ask) || order_type > static_cast<uint8_t>(OrderType::TrailingStopLimit) ||
+            time_in_force > static_cast<uint8_t>(OrderTimeInForce::IOC))
+            return false;
+        command.operation = static_cast<BinaryOperation>(operation);
+        command.side = static_cast<OrderSide>(side);
+        command.order_type = static_cast<OrderType>(order_type);
+        command.time_in_force = static_cast<OrderTimeInForce>(time_in_force);
+        command.symbol_id = readLittleEndian<uint32_t>(data + 8);
+        command.order_id = readLittleEndian<uint64_t>(data + 16);
+        command.price = readLittleEndian<uint64_t>(data + 24);
+        command.quantity = readLittleEndian<uint64_t>(data + 32);
+        return true;
+    }
+
+    /**
+     * Encodes the command.
+     *
+     * @param out where the command is written, require that there is space for
+     *            BINARY_COMMAND_SIZE bytes.
+     */
+    void encode(char *out) const
+    {
+        for (size_t i = 0; i < BINARY_COMMAND_SIZE; ++i)
+            out[i] = 0;
+        out[0] = static_cast<char>(BINARY_COMMAND_MAGIC);
+        out[1] = static_cast<char>(operation);
+        out[2] = static_cast<char>(side);
+        out[3] = static_cast<char>(order_type);
+        out[4] = static_cast<char>(time_in_force);
+        writeLittleEndian(out + 8, symbol_id);
+        writeLittleEndian(out + 16, order_id);
+        writeLittleEndian(out + 24, price);
+        writeLittleEndian(out + 32, quantity);
+    }
+
+private:
+    // Fields are assembled byte by byte, so decoding does not depend on the byte order or the
+    // alignment requirements of the host.
+    template<typename T>
+    static T readLittleEndian(const char *in)
+    {
+        T value = 0;
+        for (size_t i = 0; i < sizeof(T); ++i)
+            value |= static_cast<T>(static_cast<uint8_t>(in[i])) << (8 * i);
+        return value;
+    }
+
+    template<typename T>
+    static void writeLittleEndian(char *out, T value)
+    {
+        for (size_t i = 0; i < sizeof(T); ++i)
+            out[i] = static_cast<char>(value >> (8 * i));
+    }
+};
+} // namespace RapidTrader
+#endif // RAPID_TRADER_BINARY_COMMAND_H
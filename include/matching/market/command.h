@@ -0,0 +1,172 @@
+// //match_engine/include/matching/market/command.h
+#ifndef RAPID_TRADER_COMMAND_H
+#define RAPID_TRADER_COMMAND_H
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include "matching/market/market.h"
+#include "matching/orderbook/order.h"
+
+namespace RapidTrader {
+/**
+ * Supported commands.
+ *
+ * AddOrder, DeleteOrder, CancelOrder, ReplaceOrder, ExecuteOrder, and
+ * ExecuteOrderAtPrice: forward an order operation to an orderbook handler.
+ *
+ * Callback: runs an arbitrary function. Used for infrequent operations such as
+ * adding symbols, where the cost of allocating the function does not matter.
+ */
+enum class CommandType : uint8_t
+{
+    AddOrder = 0,
+    DeleteOrder = 1,
+    CancelOrder = 2,
+    ReplaceOrder = 3,
+    ExecuteOrder = 4,
+    ExecuteOrderAtPrice = 5,
+    Callback = 6
+};
+
+/**
+ * A fixed-size, trivially copyable record of an operation that a concurrent
+ * market worker should perform. Commands are copied into preallocated queue
+ * slots, so submitting an order operation never allocates.
+ */
+struct Command
+{
+    /**
+     * @param orderbook_handler_ the handler that will process the order.
+     * @param order the order to add, only the unexecuted state of the order is recorded.
+     * @return a command that adds the order.
+     */
+    static Command addOrder(OrderBookHandler *orderbook_handler_, const Order &order)
+    {
+        Command command = orderCommand(CommandType::AddOrder, orderbook_handler_, order.getSymbolID(), order.getOrderID(), order.getPrice(), order.getQuantity());
+        command.order_type = order.getType();
+        command.side = order.getSide();
+        command.time_in_force = order.getTimeInForce();
+        command.stop_price = order.getStopPrice();
+        command.trail_amount = order.getTrailAmount();
+        return command;
+    }
+
+    static Command deleteOrder(OrderBookHandler *orderbook_handler_, uint32_t symbol_id_, uint64_t order_id_)
+    {
+        return orderCommand(CommandType::DeleteOrder, orderbook_handler_, symbol_id_, order_id_);
+    }
+
+    static Command cancelOrder(OrderBookHandler *orderbook_handler_, uint32_t symbol_id_, uint64_t order_id_, uint64_t cancelled_quantity)
+    {
+        return orderCommand(CommandType::CancelOrder, orderbook_handler_, symbol_id_, order_id_, 0, cancelled_quantity);
+    }
+
+    static Command replaceOrder(OrderBookHandler *orderbook_handler_, uint32_t symbol_id_, uint64_t order_id_, uint64_t new_order_id_, uint64_t new_price)
+    {
+        Command command = orderCommand(CommandType::ReplaceOrder, orderbook_handler_, symbol_id_, order_id_, new_price);
+        command.new_order_id = new_order_id_;
+        return command;
+    }
+
+    static Command executeOrder(OrderBookHandler *orderbook_handler_, uint32_t symbol_id_, uint64_t order_id_, uint64_t quantity_, uint64_t price_)
+    {
+        return orderCommand(CommandType::ExecuteOrderAtPrice, orderbook_handler_, symbol_id_, order_id_, price_, quantity_);
+    }
+
+    static Command executeOrder(OrderBookHandler *orderbook_handler_, uint32_t symbol_id_, uint64_t order_id_, uint64_t quantity_)
+    {
+        return orderCommand(CommandType::ExecuteOrder, orderbook_handler_, symbol_id_, order_id_, 0, quantity_);
+    }
+
+    /**
+     * @param function the function to run. The command owns it until the command is run, and it
+     *                 is destroyed once it has run, even if it throws.
+     * @return a command that runs the function, require that it is run exactly once. Thread pools
+     *         run every queued command before their workers exit, so submitted commands are never
+     *         dropped.
+     */
+    static Command callback(std::function<void()> function)
+    {
+        Command command;
+        command.type = CommandType::Callback;
+        command.function = new std::function<void()>(std::move(function));
+        return command;
+    }
+
+    /**
+     * Performs the command. Must be called exactly once for callback commands.
+     */
+    void operator()() const
+    {
+        switch (type)
+        {
+        case CommandType::AddOrder:
+            orderbook_handler->addOrder(Order{order_type, side, time_in_force, symbol_id, price, stop_price, trail_amount, quantity, order_id});
+            break;
+        case CommandType::DeleteOrder:
+            orderbook_handler->deleteOrder(symbol_id, order_id);
+            break;
+        case CommandType::CancelOrder:
+            orderbook_handler->cancelOrder(symbol_id, order_id, quantity);
+            break;
+        case CommandType::ReplaceOrder:
+            orderbook_handler->replaceOrder(symbol_id, order_id, new_order_id, price);
+            break;
+        case CommandType::ExecuteOrder:
+            orderbook_handler->executeOrder(symbol_id, order_id, quantity);
+            break;
+        case CommandType::ExecuteOrderAtPrice:
+            orderbook_handler->executeOrder(symbol_id, order_id, quantity, price);
+            break;
+        case CommandType::Callback:
+        {
+            std::unique_ptr<std::function<void()>> owned_function{function};
+            (*owned_function)();
+            break;
+        }
+        }
+    }
+
+    /**
+     * @return a command of the given type with the fields shared by order commands set.
+     */
+    static Command orderCommand(CommandType type_, OrderBookHandler *orderbook_handler_, uint32_t symbol_id_, uint64_t order_id_,
+        uint64_t price_ = 0, uint64_t quantity_ = 0)
+    {
+        Command command;
+        command.type = type_;
+        command.orderbook_handler = orderbook_handler_;
+        command.symbol_id = symbol_id_;
+        command.order_id = order_id_;
+        command.price = price_;
+        command.quantity = quantity_;
+        return command;
+    }
+
+    CommandType type{};
+    // The handler that processes order commands.
+    OrderBookHandler *orderbook_handler{nullptr};
+    uint32_t symbol_id{0};
+    uint64_t order_id{0};
+    // The price of the order, the new price of the order, or the price to execute the order at.
+    uint64_t price{0};
+    // The quantity of the order, or the quantity to cancel or execute.
+    uint64_t quantity{0};
+    // Only used by add order commands.
+    OrderType order_type{};
+    OrderSide side{};
+    OrderTimeInForce time_in_force{};
+    uint64_t stop_price{0};
+    uint64_t trail_amount{0};
+    union
+    {
+        // Only used by replace order commands.
+        uint64_t new_order_id{0};
+        // Only used by callback commands.
+        std::function<void()> *function;
+    };
+};
+
+static_assert(std::is_trivially_copyable_v<Command>, "Commands must be trivially copyable!");
+} // namespace RapidTrader
+#endif // RAPID_TRADER_COMMAND_H
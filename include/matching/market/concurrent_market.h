@@ -3,9 +3,13 @@
 #define RAPID_TRADER_CONCURRENT_MARKET_H
 #include <iostream>
 #include <fstream>
+#include <future>
 #include <memory>
+#include <mutex>
 #include "utils/robin_hood.h"
+#include "concurrent/rcu_pointer.h"
 #include "concurrent/thread_pool.h"
+#include "matching/market/command.h"
 #include "matching/orderbook/order.h"      // Corrected path
 #include "matching/orderbook/orderbook.h"  // Corrected path
 #include "matching/orderbook/symbol.h"     // Corrected path
@@ -16,6 +20,13 @@ using namespace Concurrent;
 class EventHandler;
 class OrderBookHandler;
 
+/**
+ * A market that processes the orderbooks of its symbols on a pool of worker threads. Each
+ * symbol is processed by one worker thread at a time. Orders can be submitted from any
+ * number of threads concurrently, and adding, removing, or migrating symbols never blocks
+ * order submission. Commands submitted by one thread are processed in the order they were
+ * submitted, commands submitted by different threads for the same symbol may interleave.
+ */
 class ConcurrentMarket
 {
 public:
@@ -25,12 +36,21 @@ public:
     /**
      * A constructor for the concurrent market.
      *
+     * @tparam Handler the type of the event handlers, see OrderBookHandler. Orderbooks are only
+     *                 bound to the handlers at compile time if Handler is a final class.
      * @param event_handlers a vector of event handlers, require that the size of the
      *                       vector is equal to the number of threads that will be used.
      * @param num_threads the number of worker threads that will be used, require that
      *                    num_threads is positive.
+     * @param wait_strategy how worker threads wait for commands when they are idle.
+     * @param worker_cores the CPU core that each worker thread is pinned to, require that worker_cores
+     *                     is either empty or has one core for each worker thread. Each worker's orderbook
+     *                     handler and orderbooks are allocated by the worker, so pinned workers keep their
+     *                     state on their own NUMA node.
      */
-    explicit ConcurrentMarket(std::vector<std::unique_ptr<EventHandler>> &event_handlers, uint8_t num_threads = 1);
+    template<typename Handler>
+    explicit ConcurrentMarket(std::vector<std::unique_ptr<Handler>> &event_handlers, uint8_t num_threads = 1,
+        WaitStrategy wait_strategy = WaitStrategy::Backoff, std::vector<uint32_t> worker_cores = {});
 
     /**
      * Adds a new symbol to market asynchronously.
@@ -38,8 +58,9 @@ public:
      * @param symbol_id the ID that the symbol is identified by, require that
      *                  the symbol associated with symbol ID does not already exist.
      * @param symbol_name the name of the symbol.
+     * @param config describes the orderbook that will be created for the symbol.
      */
-    void addSymbol(uint32_t symbol_id, const std::string &symbol_name);
+    void addSymbol(uint32_t symbol_id, const std::string &symbol_name, const OrderBookConfig &config = {});
 
     /**
      * Removes the symbol from the market asynchronously.
@@ -102,6 +123,48 @@ public:
      */
     void executeOrder(uint32_t symbol_id, uint64_t order_id, uint64_t quantity);
 
+    /**
+     * Submits a batch of order commands to the market asynchronously. The commands are
+     * grouped by the worker thread that processes their symbol, and each group is pushed
+     * to the queue of its worker at once. Commands for the same symbol are processed in
+     * the order they appear in the batch.
+     *
+     * @param commands the commands to submit, require that none of them are callback commands.
+     *                 The market sets the orderbook handler of each command, so commands can be
+     *                 created with a null orderbook handler.
+     * @param num_commands the number of commands.
+     */
+    void submitBatch(const Command *commands, size_t num_commands);
+
+    /**
+     * Moves the orderbook of a symbol to another worker thread. Commands for the symbol
+     * that were submitted before the migration are processed by the old worker, and
+     * commands submitted after it are processed by the new worker once the orderbook has
+     * been handed over. Returns once the old worker has released the orderbook. Neither
+     * worker waits for the other, so other symbols are not stopped.
+     *
+     * @param symbol_id the ID that the symbol is identified by, require that
+     *                  the symbol associated with symbol ID exists.
+     * @param worker_index the index of the worker thread the orderbook will be moved to,
+     *                     require that worker_index is less than the number of threads.
+     */
+    void migrateSymbol(uint32_t symbol_id, uint32_t worker_index);
+
+    /**
+     * Moves at most one symbol from the most loaded worker thread to the least loaded
+     * one, if doing so reduces the difference between their loads. The load of a symbol is
+     * the number of commands submitted for it, decayed by half on every call, so that
+     * rebalancing follows recent activity.
+     */
+    void rebalance();
+
+    /**
+     * @param symbol_id the ID that the symbol is identified by, require that
+     *                  the symbol associated with symbol ID exists.
+     * @return the index of the worker thread that processes commands for the symbol.
+     */
+    [[nodiscard]] uint32_t getWorkerIndex(uint32_t symbol_id) const;
+
     /**
      * @return the string representation of the market.
      */
@@ -118,15 +181,48 @@ public:
     friend std::ostream &operator<<(std::ostream &os, ConcurrentMarket &concurrent_market);
 
 private:
+    struct SymbolRoute
+    {
+        // The submission index corresponds to the thread pool queue that a task (that is
+        // associated with the symbol) should be submitted to. Additionally, the submission
+        // index corresponds to the orderbook handler that is associated with the symbol.
+        uint32_t submission_index;
+        // True while the orderbook of the symbol is being moved to another worker thread.
+        // Commands for the symbol are held back until the move is complete.
+        bool migrating;
+        // The number of tasks submitted for the symbol since the last rebalance, plus
+        // half of its load before the last rebalance. Owned by id_to_load.
+        std::atomic<uint64_t> *load;
+    };
+
+    // Maps symbol IDs to their routes.
+    using RoutingTable = robin_hood::unordered_map<uint32_t, SymbolRoute>;
+
     /**
      * Gets the index that that corresponds to the queue in the thread pool
      * that the new task should be submitted to as well the index of the orderbook
-     * handler that the task should use.
+     * handler that the task should use. Counts the task towards the load of the symbol.
+     *
+     * @param routing_table the routing table to look the symbol up in.
+     * @param symbol_id the symbol ID to get the submission index for.
+     * @param submission_index set to the submission index associated with the symbol ID.
+     * @return false if the symbol is migrating, in which case the task must not be submitted
+     *         until the migration is complete, and true otherwise.
+     */
+    static bool getSubmissionIndex(const RoutingTable &routing_table, uint32_t symbol_id, uint32_t &submission_index);
+
+    /**
+     * Submits an order command to the worker thread of its symbol.
      *
-     * @param symbol_id the symbol ID to get the submission index for
-     * @return the submission index associated with the symbol ID.
+     * @param command the command to submit.
      */
-    uint32_t getSubmissionIndex(uint32_t symbol_id);
+    void submitCommand(Command command);
+
+    /**
+     * Moves the orderbook of a symbol to another worker thread, see migrateSymbol. Must be
+     * called with routing_mutex held.
+     */
+    void moveSymbol(uint32_t symbol_id, uint32_t worker_index);
 
     /**
      * Increments the symbol submission index modulo the number of orderbook handlers.
@@ -135,18 +231,50 @@ private:
 
     // The number of orderbook handlers is equivalent to the number of worker threads in the thread pool.
     std::vector<std::unique_ptr<OrderBookHandler>> orderbook_handlers;
-    // Maps symbol IDs to symbols.
+    // Serializes the operations that change the routing table.
+    std::mutex routing_mutex;
+    // Maps symbol IDs to symbols. Guarded by routing_mutex.
     robin_hood::unordered_map<uint32_t, std::unique_ptr<Symbol>> id_to_symbol;
-    // Maps symbol IDs to the submission indices. A submission index
-    // corresponds to the thread pool queue that a task (that is associated with the symbol ID)
-    // should be submitted to. Additionally, the submission index corresponds to the orderbook
-    // handler that is associated with the symbol ID.
-    robin_hood::unordered_map<uint32_t, uint32_t> id_to_submission_index;
-    // The thread pool that order operations will be submitted to.
-    ThreadPool thread_pool;
+    // Maps symbol IDs to their load counters, which are shared by every version of the
+    // routing table. Guarded by routing_mutex.
+    robin_hood::unordered_node_map<uint32_t, std::atomic<uint64_t>> id_to_load;
+    // The routing table that orders are submitted with. Submitting threads read it without
+    // locks, and symbol operations replace it with an updated copy.
+    RcuPointer<RoutingTable> routes;
+    // The thread pool that commands will be submitted to. Its worker queues are
+    // multi-producer, so commands can be submitted from any number of threads.
+    BasicThreadPool<MPSCQueue<Command>> thread_pool;
     // The index of the thread pool queue and orderbook handler that will be associated
-    // with a newly added symbol.
+    // with a newly added symbol. Guarded by routing_mutex.
     uint32_t symbol_submission_index;
 };
+
+template<typename Handler>
+ConcurrentMarket::ConcurrentMarket(std::vector<std::unique_ptr<Handler>> &event_handlers, uint8_t num_threads,
+    WaitStrategy wait_strategy, std::vector<uint32_t> worker_cores)
+    : routes(std::make_unique<RoutingTable>())
+    , thread_pool(num_threads, wait_strategy, std::move(worker_cores))
+    , symbol_submission_index(0)
+{
+    assert(num_threads > 0 && "The number of threads must be positive!");
+    assert(event_handlers.size() == num_threads && "The number of event handlers must be equal to the number of threads!");
+    // Each worker allocates its own orderbook handler, so that the handler is first touched by the worker.
+    orderbook_handlers.resize(num_threads);
+    std::vector<std::future<void>> futures(num_threads);
+    for (uint32_t i = 0; i < num_threads; ++i)
+    {
+        auto promise = std::make_shared<std::promise<void>>();
+        futures[i] = promise->get_future();
+        std::unique_ptr<OrderBookHandler> *orderbook_handler = &orderbook_handlers[i];
+        // The handler keeps its static type, so that orderbooks can be bound to it.
+        Handler *event_handler = event_handlers[i].release();
+        thread_pool.submit(i, Command::callback([=] {
+            *orderbook_handler = std::make_unique<OrderBookHandler>(std::unique_ptr<Handler>(event_handler));
+            promise->set_value();
+        }));
+    }
+    for (auto &future : futures)
+        future.get();
+}
 } // namespace RapidTrader
 #endif // RAPID_TRADER_CONCURRENT_MARKET_H
\ No newline at end of file
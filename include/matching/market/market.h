@@ -4,26 +4,60 @@
 #include <iostream>
 #include <fstream>
 #include <memory>
+#include <type_traits>
 #include "utils/log.h"
 #include "utils/robin_hood.h"
 #include "matching/orderbook/order.h"      // Corrected path
 #include "matching/orderbook/orderbook.h"  // Corrected path
+#include "matching/orderbook/orderbook_factory.h"
+#include "matching/market/symbol_table.h"
 #include "matching/orderbook/symbol.h"     // Corrected path
 #include "event_handler/event_handler.h"
 
 namespace RapidTrader {
 class EventHandler;
+struct Command;
 
 // A struct for the shared logic between market and concurrent market.
 // Necessary to prevent race condition in concurrent market.
 struct OrderBookHandler
 {
-    explicit OrderBookHandler(std::unique_ptr<EventHandler> event_handler);
+    /**
+     * A constructor for the OrderBookHandler. If Handler is a final class, orderbooks
+     * are bound to it at compile time, otherwise they dispatch events virtually.
+     *
+     * @tparam Handler the type of the event handler.
+     * @param event_handler_ handles orderbook events.
+     */
+    template<typename Handler>
+    explicit OrderBookHandler(std::unique_ptr<Handler> event_handler_)
+        : event_handler(std::move(event_handler_))
+        , make_orderbook(&makeOrderBook<std::conditional_t<std::is_final_v<Handler>, Handler, EventHandler>>)
+    {}
 
-    void addOrderBook(uint32_t symbol_id, std::string symbol_name);
+    void addOrderBook(uint32_t symbol_id, std::string symbol_name, const OrderBookConfig &config = {});
 
     void deleteOrderBook(uint32_t symbol_id, std::string symbol_name);
 
+    /**
+     * Removes an orderbook from the handler without deleting it, so that it can be adopted
+     * by another handler.
+     *
+     * @param symbol_id the symbol ID of the orderbook, require that the orderbook exists.
+     * @return the orderbook.
+     */
+    std::unique_ptr<OrderBook> releaseOrderBook(uint32_t symbol_id);
+
+    /**
+     * Takes ownership of an orderbook released by another handler and binds it to the
+     * event handler of this handler.
+     *
+     * @param orderbook the orderbook, require that the handler does not already have an orderbook
+     *                  with the same symbol ID and that the orderbook is bound to the same type of
+     *                  event handler as the orderbooks of this handler.
+     */
+    void adoptOrderBook(std::unique_ptr<OrderBook> orderbook);
+
     void addOrder(const Order &order);
 
     void deleteOrder(uint32_t symbol_id, uint64_t order_id);
@@ -40,9 +74,11 @@ struct OrderBookHandler
 
 private:
     // Maps symbol IDs to order books.
-    robin_hood::unordered_map<uint32_t, std::unique_ptr<OrderBook>> id_to_book;
+    SymbolTable<OrderBook> id_to_book;
     // Handles orderbook events.
     std::unique_ptr<EventHandler> event_handler;
+    // Creates orderbooks bound to the type of the event handler.
+    std::unique_ptr<OrderBook> (*make_orderbook)(uint32_t, EventHandler &, const OrderBookConfig &);
 };
 
 class Market
@@ -54,9 +90,13 @@ public:
     /**
      * A constructor for the Market.
      *
-     * @param outgoing_messages_ the event handler that will be used by the market.
+     * @tparam Handler the type of the event handler, see OrderBookHandler.
+     * @param event_handler the event handler that will be used by the market.
      */
-    explicit Market(std::unique_ptr<EventHandler> event_handler);
+    template<typename Handler>
+    explicit Market(std::unique_ptr<Handler> event_handler)
+        : orderbook_handler(std::make_unique<OrderBookHandler>(std::move(event_handler)))
+    {}
 
     /**
      * Adds a new symbol and a corresponding orderbook to market.
@@ -64,8 +104,9 @@ public:
      * @param symbol_id the ID that the symbol is identified by, require that
      *                  the symbol associated with symbol ID does not already exist.
      * @param symbol_name the name of the symbol.
+     * @param config describes the orderbook that will be created for the symbol.
      */
-    void addSymbol(uint32_t symbol_id, const std::string &symbol_name);
+    void addSymbol(uint32_t symbol_id, const std::string &symbol_name, const OrderBookConfig &config = {});
 
     /**
      * Removes the symbol and the corresponding orderbook from the market.
@@ -134,6 +175,16 @@ public:
      */
     void executeOrder(uint32_t symbol_id, uint64_t order_id, uint64_t quantity);
 
+    /**
+     * Performs a batch of order commands in order.
+     *
+     * @param commands the commands to perform, require that none of them are callback commands.
+     *                 The market sets the orderbook handler of each command, so commands can be
+     *                 created with a null orderbook handler.
+     * @param num_commands the number of commands.
+     */
+    void submitBatch(const Command *commands, size_t num_commands);
+
     /**
      * @return the string representation of the market.
      */
@@ -0,0 +1,120 @@
+// //match_engine/include/matching/market/symbol_table.h
+#ifndef RAPID_TRADER_SYMBOL_TABLE_H
+#define RAPID_TRADER_SYMBOL_TABLE_H
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "utils/robin_hood.h"
+
+namespace RapidTrader {
+// Symbols with an ID below this are stored in the directly indexed part of a symbol table.
+constexpr uint32_t MAX_DENSE_SYMBOL_ID = 1 << 16;
+
+/**
+ * Maps symbol IDs to owned objects. Symbol IDs are expected to be small and dense, so
+ * objects with an ID below MAX_DENSE_SYMBOL_ID are found by indexing an array with
+ * the ID. Objects with larger IDs are found by hashing.
+ *
+ * @tparam T type of the objects owned by the table.
+ */
+template<typename T>
+class SymbolTable
+{
+public:
+    /**
+     * @param symbol_id the ID of the symbol to find the object of.
+     * @return the object of the symbol if it is in the table and null otherwise.
+     */
+    [[nodiscard]] T *find(uint32_t symbol_id) const
+    {
+        if (symbol_id < dense_objects.size())
+            return dense_objects[symbol_id].get();
+        if (symbol_id < MAX_DENSE_SYMBOL_ID)
+            return nullptr;
+        auto it = sparse_objects.find(symbol_id);
+        return it == sparse_objects.end() ? nullptr : it->second.get();
+    }
+
+    /**
+     * Adds the object of a symbol to the table.
+     *
+     * @param symbol_id the ID of the symbol, require that the symbol is not in the table.
+     * @param object the object, require that object is not null.
+     */
+    void insert(uint32_t symbol_id, std::unique_ptr<T> object)
+    {
+        assert(!find(symbol_id) && "Symbol already exists!");
+        assert(object && "Object must not be null!");
+        if (symbol_id < MAX_DENSE_SYMBOL_ID)
+        {
+            if (symbol_id >= dense_objects.size())
+                dense_objects.resize(symbol_id + 1);
+            dense_objects[symbol_id] = std::move(object);
+        }
+        else
+        {
+            sparse_objects.insert({symbol_id, std::move(object)});
+        }
+        ++num_objects;
+    }
+
+    /**
+     * Removes the object of a symbol from the table.
+     *
+     * @param symbol_id the ID of the symbol, require that the symbol is in the table.
+     * @return the object.
+     */
+    std::unique_ptr<T> remove(uint32_t symbol_id)
+    {
+        assert(find(symbol_id) && "Symbol does not exist!");
+        std::unique_ptr<T> object;
+        if (symbol_id < MAX_DENSE_SYMBOL_ID)
+        {
+            object = std::move(dense_objects[symbol_id]);
+        }
+        else
+        {
+            auto it = sparse_objects.find(symbol_id);
+            object = std::move(it->second);
+            sparse_objects.erase(it);
+        }
+        --num_objects;
+        return object;
+    }
+
+    /**
+     * Calls a function on every object in the table, in ascending order of symbol ID
+     * for symbols in the directly indexed part of the table.
+     *
+     * @param f the function, called with the symbol ID and a reference to the object.
+     */
+    template<typename F>
+    void forEach(F &&f) const
+    {
+        for (uint32_t symbol_id = 0; symbol_id < dense_objects.size(); ++symbol_id)
+        {
+            if (dense_objects[symbol_id])
+                f(symbol_id, *dense_objects[symbol_id]);
+        }
+        for (const auto &[symbol_id, object] : sparse_objects)
+            f(symbol_id, *object);
+    }
+
+    /**
+     * @return the number of symbols in the table.
+     */
+    [[nodiscard]] size_t size() const
+    {
+        return num_objects;
+    }
+
+private:
+    // The objects of symbols with an ID below MAX_DENSE_SYMBOL_ID, indexed by symbol ID.
+    std::vector<std::unique_ptr<T>> dense_objects;
+    // The objects of symbols with larger IDs.
+    robin_hood::unordered_map<uint32_t, std::unique_ptr<T>> sparse_objects;
+    size_t num_objects = 0;
+};
+} // namespace RapidTrader
+#endif // RAPID_TRADER_SYMBOL_TABLE_H
@@ -0,0 +1,590 @@
+// //match_engine/include/matching/orderbook/array_orderbook.h
+#ifndef RAPID_TRADER_ARRAY_ORDERBOOK_H
+#define RAPID_TRADER_ARRAY_ORDERBOOK_H
+#include <map>
+#include <vector>
+#include <limits>
+#include <memory_resource>
+#include "utils/robin_hood.h"
+#include "utils/object_pool.h"
+#include "matching/orderbook/level.h"
+#include "matching/orderbook/order_index.h"
+#include "matching/orderbook/price_ladder.h"
+#include "matching/orderbook/orderbook.h"
+#include "matching/orderbook/order.h"
+#include "event_handler/event_handler.h"
+
+namespace RapidTrader {
+// Only validate orderbook in debug mode.
+#ifndef NDEBUG
+#    define VALIDATE_ORDERBOOK validateOrderBook()
+#else
+#    define VALIDATE_ORDERBOOK
+#endif
+
+struct ArrayOrderWrapper
+{
+    // The level that the order is stored in. Limit levels live in the pages of
+    // the price ladders and are never moved or destroyed while the book exists. Stop levels
+    // live in STL maps, so the pointer remains valid until the level is erased.
+    Level *level;
+    // Placed right after the level pointer, which lands the pointer next to the hook and the hot
+    // fields at the front of the order.
+    Order order;
+};
+
+static_assert(sizeof(ArrayOrderWrapper) == sizeof(Level *) + sizeof(Order), "The order must directly follow its level pointer!");
+
+/**
+ * An orderbook for symbols that trade inside a bounded price band. Limit
+ * levels are stored in a price ladder indexed by (price - min price) / tick size,
+ * and the best bid and best ask indices are kept up to date on each change using
+ * the occupancy bitmap of the ladder. Stop and trailing stop levels are rare and
+ * are kept in ordered maps.
+ *
+ * Limit orders may match at any price, but the unfilled remainder of a limit
+ * order whose price is outside of the price band or not a multiple of the tick
+ * size cannot rest in the book and is deleted.
+ *
+ * @tparam Handler the type of the event handler that the book reports to, see BasicMapOrderBook.
+ */
+template<typename Handler>
+class BasicArrayOrderBook : public OrderBook
+{
+public:
+    /**
+     * A constructor for the BasicArrayOrderBook.
+     *
+     * @param symbol_id_ the symbol ID that will be associated with the book.
+     * @param event_handler_ handles updates from the book.
+     * @param min_price_ the lowest limit price that can rest in the book, require that min_price_ is positive.
+     * @param max_price_ the highest limit price that can rest in the book, require that
+     *                   max_price_ >= min_price_ and that max_price_ - min_price_ is a
+     *                   multiple of tick_size_.
+     * @param tick_size_ the minimum price increment, require that tick_size_ is positive.
+     * @param order_capacity the number of resting orders to allocate space for up front.
+     * @param sequential_order_ids true if order IDs are nearly monotonic, in which case resting
+     *                             orders are indexed directly by ID instead of hashing them.
+     */
+    BasicArrayOrderBook(uint32_t symbol_id_, Handler &event_handler_, uint64_t min_price_, uint64_t max_price_, uint64_t tick_size_,
+        size_t order_capacity = 0, bool sequential_order_ids = false);
+
+    /**
+     * A destructor for the BasicArrayOrderBook. Returns all resting orders to the order pool.
+     */
+    ~BasicArrayOrderBook() override;
+
+    /**
+     * @inheritdoc
+     */
+    void addOrder(Order order) override;
+
+    /**
+     * @inheritdoc
+     */
+    void executeOrder(uint64_t order_id, uint64_t quantity, uint64_t price) override;
+
+    /**
+     * @inheritdoc
+     */
+    void executeOrder(uint64_t order_id, uint64_t quantity) override;
+
+    /**
+     * @inheritdoc
+     */
+    void deleteOrder(uint64_t order_id) override;
+
+    /**
+     * @inheritdoc
+     */
+    void cancelOrder(uint64_t order_id, uint64_t quantity) override;
+
+    /**
+     * @inheritdoc
+     */
+    void replaceOrder(uint64_t order_id, uint64_t new_order_id, uint64_t new_price) override;
+
+    /**
+     * @inheritdoc
+     */
+    [[nodiscard]] bool hasOrder(uint64_t order_id) const override
+    {
+        return orders.find(order_id) != nullptr;
+    }
+
+    /**
+     * @inheritdoc
+     */
+    [[nodiscard]] Order getOrder(uint64_t order_id) const override
+    {
+        ArrayOrderWrapper *wrapper = orders.find(order_id);
+        refreshTrailingStopPrice(*wrapper);
+        return wrapper->order;
+    }
+
+    /**
+     * @inheritdoc
+     */
+    [[nodiscard]] bool empty() const override
+    {
+        return orders.empty();
+    }
+
+    /**
+     * @inheritdoc
+     */
+    [[nodiscard]] uint32_t getSymbolID() const override
+    {
+        return symbol_id;
+    }
+
+    /**
+     * @inheritdoc
+     */
+    [[nodiscard]] uint64_t bestBid() const override
+    {
+        return best_bid_index == NO_LEVEL ? 0 : indexToPrice(best_bid_index);
+    }
+
+    /**
+     * @inheritdoc
+     */
+    [[nodiscard]] uint64_t bestAsk() const override
+    {
+        return best_ask_index == NO_LEVEL ? std::numeric_limits<uint64_t>::max() : indexToPrice(best_ask_index);
+    }
+
+    /**
+     * @inheritdoc
+     */
+    [[nodiscard]] uint64_t lastTradedPrice() const override
+    {
+        return last_traded_price;
+    }
+
+    /**
+     * @inheritdoc
+     */
+    [[nodiscard]] uint64_t volumeAtOrBetter(OrderSide side, uint64_t price) const override;
+
+    /**
+     * @inheritdoc
+     */
+    void setEventHandler(EventHandler &event_handler_) override
+    {
+        event_handler = &static_cast<Handler &>(event_handler_);
+        trade_events = event_handler->handlesTrades();
+        execution_reports = event_handler->handlesExecutionReports();
+    }
+
+    /**
+     * @param price a limit price.
+     * @return true if a limit order with the provided price can rest in the book and false otherwise.
+     */
+    [[nodiscard]] bool inBand(uint64_t price) const
+    {
+        return price >= min_price && price <= max_price && (price - min_price) % tick_size == 0;
+    }
+
+    /**
+     * @inheritdoc
+     */
+    void dumpBook(const std::string &path) const override;
+
+    /**
+     * @inheritdoc
+     */
+    [[nodiscard]] std::string toString() const override;
+
+    friend std::ostream &operator<<(std::ostream &os, const BasicArrayOrderBook &book)
+    {
+        os << book.toString();
+        return os;
+    }
+
+private:
+    // Indicates that a side of the book has no limit levels.
+    static constexpr size_t NO_LEVEL = PriceLadder::NOT_FOUND;
+
+    /**
+     * @param price a price, require that the price is in the price band.
+     * @return the ladder index associated with the price.
+     */
+    [[nodiscard]] size_t priceToIndex(uint64_t price) const
+    {
+        return (price - min_price) / tick_size;
+    }
+
+    /**
+     * @param index a ladder index, require that the index is in the ladder.
+     * @return the price associated with the ladder index.
+     */
+    [[nodiscard]] uint64_t indexToPrice(size_t index) const
+    {
+        return min_price + index * tick_size;
+    }
+
+    /**
+     * Deletes an order from the book. Does not match orders.
+     *
+     * @param order_id the ID of the order, require that there exists
+     *                 an order with order_id in the book.
+     * @param notification true if a notification should be sent
+     *                     indicating that the order was deleted and
+     *                     false otherwise.
+     */
+    void deleteOrder(uint64_t order_id, bool notification);
+
+    /**
+     * Deletes a resting order that has been filled by an incoming order.
+     *
+     * @param order the order, require that the order is in the book and filled.
+     */
+    void deleteFilledOrder(Order &order);
+
+    /**
+     * Records the state of an order in the execution report of the current command, if the
+     * event handler handles execution reports.
+     *
+     * @param order the order.
+     * @return true if the order was recorded, and false if the event that describes the
+     *         change to the order should be raised instead.
+     */
+    bool recordOrder(const Order &order)
+    {
+        if (!execution_reports)
+            return false;
+        report.recordOrder(order);
+        return true;
+    }
+
+    /**
+     * Completes the execution report of the current command with the final state of each
+     * order in it, raises it, and clears it for the next command. Does nothing if the event
+     * handler does not handle execution reports or the command did not change the book.
+     */
+    void raiseExecutionReport();
+
+    /**
+     * Submits a limit order to the book.
+     *
+     * @param order the limit order to add to the book, require that the order
+     *              does not already exist in the book.
+     */
+    void addLimitOrder(Order &order);
+
+    /**
+     * Inserts a limit order into the price ladder.
+     *
+     * @param order the order to insert, require that the price of the order is in the price band.
+     */
+    void insertLimitOrder(const Order &order);
+
+    /**
+     * Submits a market order to the book.
+     *
+     * @param order the market order to add to the book.
+     */
+    void addMarketOrder(Order &order);
+
+    /**
+     * Submits a stop order to the book.
+     *
+     * @param order the stop order to submit to the book.
+     */
+    void addStopOrder(Order &order);
+
+    /**
+     * Inserts a stop order into the book.
+     *
+     * @param order the stop order to insert.
+     */
+    void insertStopOrder(const Order &order);
+
+    /**
+     * Inserts a trailing stop order into the book.
+     *
+     * @param order the trailing stop order to insert.
+     */
+    void insertTrailingStopOrder(const Order &order);
+
+    /**
+     * Calculates the stop price of a trailing stop
+     * order and sets the order's stop price to that price.
+     *
+     * @param order the order to set the stop price of, require that
+     *              order is a trailing stop or trailing stop limit order.
+     * @return the new stop price of the order.
+     */
+    uint64_t calculateStopPrice(Order &order);
+
+    /**
+     * Moves the reference price of trailing stop orders on the bid side if the market
+     * price has fallen, re-anchoring orders whose offset differs from their trail amount.
+     */
+    void updateBidStopOrders();
+
+    /**
+     * Moves the reference price of trailing stop orders on the ask side if the market
+     * price has risen, re-anchoring orders whose offset differs from their trail amount.
+     */
+    void updateAskStopOrders();
+
+    /**
+     * Moves trailing stop orders whose offset from the reference price differs from their
+     * trail amount to the level keyed by their trail amount. Each order is moved at most once.
+     *
+     * @param unanchored_orders the IDs of the orders to re-anchor, cleared on return.
+     * @param trailing_levels the trailing stop levels that the orders are in.
+     * @param side the side of the book that the trailing stop levels are on.
+     */
+    void anchorTrailingStopOrders(
+        std::vector<uint64_t> &unanchored_orders, std::pmr::map<uint64_t, Level> &trailing_levels, LevelSide side);
+
+    /**
+     * Records a trailing stop order whose offset from the reference price differs from
+     * its trail amount. Stale IDs are dropped before the list has to grow.
+     *
+     * @param unanchored_orders the IDs of the unanchored orders on the side of the order.
+     * @param order_id the ID of the order, require that the order is in the book.
+     */
+    void addUnanchoredTrailingStopOrder(std::vector<uint64_t> &unanchored_orders, uint64_t order_id);
+
+    /**
+     * @param wrapper the wrapper of a trailing stop order in the book.
+     * @return true if the offset of the order from the reference price is not its trail amount.
+     */
+    [[nodiscard]] static bool isUnanchored(const ArrayOrderWrapper &wrapper)
+    {
+        return wrapper.level->getPrice() != wrapper.order.getTrailAmount();
+    }
+
+    /**
+     * @param offset the offset of a bid side trailing stop level from the reference price.
+     * @return the stop price of the orders in the level.
+     */
+    [[nodiscard]] uint64_t trailingBidStopPrice(uint64_t offset) const
+    {
+        return trailing_bid_reference < (std::numeric_limits<uint64_t>::max() - offset) ? trailing_bid_reference + offset
+                                                                                         : std::numeric_limits<uint64_t>::max();
+    }
+
+    /**
+     * @param offset the offset of an ask side trailing stop level from the reference price.
+     * @return the stop price of the orders in the level.
+     */
+    [[nodiscard]] uint64_t trailingAskStopPrice(uint64_t offset) const
+    {
+        return trailing_ask_reference > offset ? trailing_ask_reference - offset : 0;
+    }
+
+    /**
+     * Sets the stop price of a trailing stop order to the price derived from the
+     * reference price. Does nothing for other orders.
+     *
+     * @param wrapper the wrapper of an order in the book.
+     */
+    void refreshTrailingStopPrice(ArrayOrderWrapper &wrapper) const
+    {
+        Order &order = wrapper.order;
+        if (order.isTrailingStop() || order.isTrailingStopLimit())
+            order.setStopPrice(
+                order.isAsk() ? trailingAskStopPrice(wrapper.level->getPrice()) : trailingBidStopPrice(wrapper.level->getPrice()));
+    }
+
+    /**
+     * Activates stop, stop limit, trailing stop, and trailing stop limit orders if the
+     * last traded price has moved since stop orders were last checked. Does nothing
+     * if there have been no trades since the last check.
+     */
+    void activateStopOrders();
+
+    /**
+     * Activates stop, stop limit, trailing stop, and trailing stop limit
+     * orders on the bid side that are triggered by the last traded price.
+     */
+    void activateBidStopOrders();
+
+    /**
+     * Activates stop, stop limit, trailing stop, and trailing stop limit
+     * orders on the ask side that are triggered by the last traded price.
+     */
+    void activateAskStopOrders();
+
+    /**
+     * Copies the orders of a triggered stop level onto the triggered order work list.
+     * The level must be erased by the caller before the orders are activated.
+     *
+     * @param level the triggered stop level.
+     */
+    void addTriggeredOrders(const Level &level);
+
+    /**
+     * Removes the orders on the triggered order work list from the book and activates
+     * them in the order that they were added. Empties the work list.
+     */
+    void activateTriggeredOrders();
+
+    /**
+     * Converts a triggered stop order that has been removed from the book into
+     * a market or limit order, and submits it for matching.
+     *
+     * @param order the order to activate, require that order is a stop, stop limit,
+     *              trailing stop, or trailing stop limit order.
+     */
+    void activateStopOrder(Order order);
+
+    /**
+     * Matches the order against the opposite side of the book. Orders that are filled
+     * are removed from the book.
+     *
+     * @param order the order to match.
+     */
+    void match(Order &order);
+
+    /**
+     * Reduces the volume of the level that an order rests in, and the volume
+     * recorded in the depth index of the ladder if the order is a limit order.
+     *
+     * @param wrapper the wrapper of an order in the book.
+     * @param amount the volume to remove, require that amount <= the open quantity of the order
+     *               before it was reduced.
+     */
+    void reduceRestingVolume(ArrayOrderWrapper &wrapper, uint64_t amount)
+    {
+        wrapper.level->reduceVolume(amount);
+        if (wrapper.order.isLimit())
+            (wrapper.order.isAsk() ? ask_ladder : bid_ladder).removeVolume(priceToIndex(wrapper.order.getPrice()), amount);
+    }
+
+    /**
+     * Indicates whether an order is able to completely filled
+     * or not.
+     *
+     * @param order an order.
+     * @return true if the order can be completely filled and false
+     *         otherwise.
+     */
+    [[nodiscard]] bool canMatchOrder(const Order &order) const;
+
+    /**
+     * Matches two orders.
+     *
+     * @param aggressor the incoming order to execute.
+     * @param passive the resting order to execute, require that passive is on the
+     *                opposite side of the book to aggressor.
+     * @param executing_price price at which orders are executed, require that
+     *                        ask price <= executing_price <= bid price.
+     */
+    void executeOrders(Order &aggressor, Order &passive, uint64_t executing_price);
+
+    /**
+     * Moves the best bid index to the next occupied bid level at or below the current best bid.
+     */
+    void updateBestBid()
+    {
+        best_bid_index = best_bid_index == 0 ? NO_LEVEL : bid_ladder.findPrev(best_bid_index - 1);
+    }
+
+    /**
+     * Moves the best ask index to the next occupied ask level at or above the current best ask.
+     */
+    void updateBestAsk()
+    {
+        best_ask_index = ask_ladder.findNext(best_ask_index + 1);
+    }
+
+    /**
+     * @returns the last traded price if any trades have been made and the max
+     *          64-bit unsigned integer value otherwise.
+     */
+    [[nodiscard]] uint64_t lastTradedPriceAsk() const
+    {
+        return last_traded_price == 0 ? std::numeric_limits<uint64_t>::max() : last_traded_price;
+    }
+
+    /**
+     * @returns the last traded price if any trades have been made and zero otherwise.
+     */
+    [[nodiscard]] uint64_t lastTradedPriceBid() const
+    {
+        return last_traded_price;
+    }
+
+    /*
+     * Validates the orderbook.
+     *
+     * @throws Error if the best bid meets or exceeds the best ask, a best price
+     *               index does not point at the best non-empty level, or a stop
+     *               level is in an invalid state.
+     */
+    void validateOrderBook() const;
+
+    // IMPORTANT: Note that the pools MUST be declared before the declaration
+    // of orders and the price levels, and orders MUST be declared before the
+    // price levels. Class members are destroyed in the reverse order of their
+    // declaration, so the price levels will be destroyed before orders, and
+    // both are destroyed before the memory backing them is released. This is
+    // required for the intrusive list.
+
+    // Slab of order wrappers for resting orders.
+    ObjectPool<ArrayOrderWrapper> order_pool;
+    // Pooled memory for the nodes of the stop level maps.
+    std::pmr::unsynchronized_pool_resource level_resource;
+    // Maps order IDs to order wrappers.
+    OrderIndex<ArrayOrderWrapper> orders;
+    // Limit levels indexed by (price - min_price) / tick_size.
+    PriceLadder ask_ladder;
+    PriceLadder bid_ladder;
+    // Maps prices to stop levels.
+    std::pmr::map<uint64_t, Level> stop_ask_levels;
+    std::pmr::map<uint64_t, Level> stop_bid_levels;
+    // Maps offsets from the reference prices to trailing stop levels.
+    std::pmr::map<uint64_t, Level> trailing_stop_ask_levels;
+    std::pmr::map<uint64_t, Level> trailing_stop_bid_levels;
+    // IDs of trailing stop orders that are keyed by an offset other than their trail amount.
+    std::vector<uint64_t> unanchored_trailing_ask_orders;
+    std::vector<uint64_t> unanchored_trailing_bid_orders;
+    // Handles any trade events.
+    Handler *event_handler;
+    // True if fills are reported to the event handler as Trade events.
+    bool trade_events;
+    // True if each command is reported to the event handler as a single ExecutionReport.
+    bool execution_reports;
+    // Collects the orders and fills of the current command if execution_reports is set.
+    ExecutionReport report;
+    // The sequence number of the last trade, zero if no trades have occurred.
+    uint64_t trade_seq;
+    // The price band and tick size of the ladders.
+    uint64_t min_price;
+    uint64_t max_price;
+    uint64_t tick_size;
+    // Ladder indices of the best bid and best ask levels, NO_LEVEL if the side is empty.
+    size_t best_bid_index;
+    size_t best_ask_index;
+    // The current price of the symbol - based off the price that the
+    // symbol was last traded at. Initially zero.
+    uint64_t last_traded_price;
+    // Tracks increases and decreases in market price.
+    uint64_t trailing_bid_price;
+    uint64_t trailing_ask_price;
+    // The market prices that ask and bid trailing stop orders trail.
+    uint64_t trailing_ask_reference;
+    uint64_t trailing_bid_reference;
+    // The last traded price that stop orders were last checked against, max 64-bit
+    // integer value if they have never been checked.
+    uint64_t stop_check_price;
+    // Work list of triggered stop orders that are waiting to be activated.
+    std::vector<Order> triggered_orders;
+    // The symbol ID associated with the book.
+    uint32_t symbol_id;
+};
+
+// Orderbooks that dispatch events through the virtual event handler interface.
+using ArrayOrderBook = BasicArrayOrderBook<EventHandler>;
+
+// Instantiated in array_orderbook.cpp. Include "matching/orderbook/array_orderbook_impl.h" to bind other handler types.
+extern template class BasicArrayOrderBook<EventHandler>;
+extern template class BasicArrayOrderBook<NullEventHandler>;
+} // namespace RapidTrader
+#endif // RAPID_TRADER_ARRAY_ORDERBOOK_H
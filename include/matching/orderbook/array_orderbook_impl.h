@@ -0,0 +1,720 @@
+// //match_engine/include/matching/orderbook/array_orderbook_impl.h
+#ifndef RAPID_TRADER_ARRAY_ORDERBOOK_IMPL_H
+#define RAPID_TRADER_ARRAY_ORDERBOOK_IMPL_H
+#include "matching/orderbook/array_orderbook.h"
+#include "event_handler/event.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace RapidTrader {
+template<typename Handler>
+BasicArrayOrderBook<Handler>::BasicArrayOrderBook(uint32_t symbol_id_, Handler &event_handler_, uint64_t min_price_, uint64_t max_price_,
+    uint64_t tick_size_, size_t order_capacity, bool sequential_order_ids)
+    : order_pool(order_capacity)
+    , orders(sequential_order_ids)
+    , ask_ladder((max_price_ - min_price_) / tick_size_ + 1, min_price_, tick_size_, LevelSide::Ask, symbol_id_)
+    , bid_ladder((max_price_ - min_price_) / tick_size_ + 1, min_price_, tick_size_, LevelSide::Bid, symbol_id_)
+    , stop_ask_levels(&level_resource)
+    , stop_bid_levels(&level_resource)
+    , trailing_stop_ask_levels(&level_resource)
+    , trailing_stop_bid_levels(&level_resource)
+    , event_handler(&event_handler_)
+    , trade_events(event_handler_.handlesTrades())
+    , execution_reports(event_handler_.handlesExecutionReports())
+    , report(symbol_id_)
+    , trade_seq(0)
+    , min_price(min_price_)
+    , max_price(max_price_)
+    , tick_size(tick_size_)
+    , best_bid_index(NO_LEVEL)
+    , best_ask_index(NO_LEVEL)
+    , last_traded_price(0)
+    , trailing_bid_price(0)
+    , trailing_ask_price(std::numeric_limits<uint64_t>::max())
+    , trailing_ask_reference(0)
+    , trailing_bid_reference(0)
+    , stop_check_price(std::numeric_limits<uint64_t>::max())
+    , symbol_id(symbol_id_)
+{
+    assert(min_price > 0 && "Minimum price must be positive!");
+    assert(tick_size > 0 && "Tick size must be positive!");
+    assert(max_price >= min_price && "Maximum price must not be lower than minimum price!");
+    assert((max_price - min_price) % tick_size == 0 && "Price band must be a multiple of the tick size!");
+    orders.reserve(order_capacity);
+}
+
+template<typename Handler>
+BasicArrayOrderBook<Handler>::~BasicArrayOrderBook()
+{
+    // Unlink the orders from their levels before the orders are destroyed.
+    ask_ladder.clear();
+    bid_ladder.clear();
+    stop_ask_levels.clear();
+    stop_bid_levels.clear();
+    trailing_stop_ask_levels.clear();
+    trailing_stop_bid_levels.clear();
+    orders.forEach([&](ArrayOrderWrapper *wrapper) { order_pool.destroy(wrapper); });
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::addOrder(Order order)
+{
+    if (!recordOrder(order))
+        event_handler->handleOrderAdded(OrderAdded{order});
+    switch (order.getType())
+    {
+    case OrderType::Limit:
+        addLimitOrder(order);
+        break;
+    case OrderType::Market:
+        addMarketOrder(order);
+        break;
+    case OrderType::Stop:
+    case OrderType::StopLimit:
+    case OrderType::TrailingStop:
+    case OrderType::TrailingStopLimit:
+        addStopOrder(order);
+        break;
+    }
+    activateStopOrders();
+    raiseExecutionReport();
+    VALIDATE_ORDERBOOK;
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::executeOrder(uint64_t order_id, uint64_t quantity, uint64_t price)
+{
+    ArrayOrderWrapper *wrapper = orders.find(order_id);
+    Order &executing_order = wrapper->order;
+    uint64_t executing_quantity = std::min(quantity, executing_order.getOpenQuantity());
+    executing_order.execute(price, executing_quantity);
+    last_traded_price = price;
+    if (!recordOrder(executing_order))
+        event_handler->handleOrderExecuted(ExecutedOrder{executing_order});
+    reduceRestingVolume(*wrapper, executing_order.getLastExecutedQuantity());
+    if (executing_order.isFilled())
+        deleteOrder(order_id, true);
+    activateStopOrders();
+    raiseExecutionReport();
+    VALIDATE_ORDERBOOK;
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::executeOrder(uint64_t order_id, uint64_t quantity)
+{
+    ArrayOrderWrapper *wrapper = orders.find(order_id);
+    Order &executing_order = wrapper->order;
+    uint64_t executing_quantity = std::min(quantity, executing_order.getOpenQuantity());
+    uint64_t executing_price = executing_order.getPrice();
+    executing_order.execute(executing_price, executing_quantity);
+    last_traded_price = executing_price;
+    if (!recordOrder(executing_order))
+        event_handler->handleOrderExecuted(ExecutedOrder{executing_order});
+    reduceRestingVolume(*wrapper, executing_order.getLastExecutedQuantity());
+    if (executing_order.isFilled())
+        deleteOrder(order_id, true);
+    activateStopOrders();
+    raiseExecutionReport();
+    VALIDATE_ORDERBOOK;
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::cancelOrder(uint64_t order_id, uint64_t quantity)
+{
+    ArrayOrderWrapper *wrapper = orders.find(order_id);
+    Order &cancelling_order = wrapper->order;
+    uint64_t pre_cancellation_quantity = cancelling_order.getOpenQuantity();
+    cancelling_order.setQuantity(quantity);
+    if (!recordOrder(cancelling_order))
+        event_handler->handleOrderUpdated(OrderUpdated{cancelling_order});
+    reduceRestingVolume(*wrapper, pre_cancellation_quantity - cancelling_order.getOpenQuantity());
+    if (cancelling_order.isFilled())
+        deleteOrder(order_id, true);
+    activateStopOrders();
+    raiseExecutionReport();
+    VALIDATE_ORDERBOOK;
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::deleteOrder(uint64_t order_id)
+{
+    deleteOrder(order_id, true);
+    activateStopOrders();
+    raiseExecutionReport();
+    VALIDATE_ORDERBOOK;
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::deleteOrder(uint64_t order_id, bool notification)
+{
+    ArrayOrderWrapper *wrapper = orders.find(order_id);
+    Level &level = *wrapper->level;
+    Order &deleting_order = wrapper->order;
+    refreshTrailingStopPrice(*wrapper);
+    if (notification && !recordOrder(deleting_order))
+        event_handler->handleOrderDeleted(OrderDeleted{deleting_order});
+    if (deleting_order.isLimit())
+        (deleting_order.isAsk() ? ask_ladder : bid_ladder).removeVolume(priceToIndex(level.getPrice()), deleting_order.getOpenQuantity());
+    level.deleteOrder(deleting_order);
+    if (level.empty())
+    {
+        switch (deleting_order.getType())
+        {
+        case OrderType::Limit:
+        {
+            // Limit levels stay in the ladder, only the occupancy and the best price indices change.
+            size_t index = priceToIndex(level.getPrice());
+            if (deleting_order.isAsk())
+            {
+                ask_ladder.release(index);
+                if (index == best_ask_index)
+                    updateBestAsk();
+            }
+            else
+            {
+                bid_ladder.release(index);
+                if (index == best_bid_index)
+                    updateBestBid();
+            }
+            break;
+        }
+        case OrderType::Stop:
+        case OrderType::StopLimit:
+            deleting_order.isAsk() ? stop_ask_levels.erase(level.getPrice()) : stop_bid_levels.erase(level.getPrice());
+            break;
+        case OrderType::TrailingStop:
+        case OrderType::TrailingStopLimit:
+            deleting_order.isAsk() ? trailing_stop_ask_levels.erase(level.getPrice()) : trailing_stop_bid_levels.erase(level.getPrice());
+            break;
+        default:
+            assert(false && "Invalid order type!");
+        }
+    }
+    order_pool.destroy(wrapper);
+    orders.erase(order_id);
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::replaceOrder(uint64_t order_id, uint64_t new_order_id, uint64_t new_price)
+{
+    ArrayOrderWrapper *wrapper = orders.find(order_id);
+    refreshTrailingStopPrice(*wrapper);
+    Order new_order = wrapper->order;
+    new_order.setOrderID(new_order_id);
+    new_order.setPrice(new_price);
+    deleteOrder(order_id, true);
+    // The execution report raised by addOrder includes the deletion of the replaced order.
+    addOrder(new_order);
+    activateStopOrders();
+    raiseExecutionReport();
+    VALIDATE_ORDERBOOK;
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::deleteFilledOrder(Order &order)
+{
+    if (!execution_reports)
+    {
+        deleteOrder(order.getOrderID(), true);
+        return;
+    }
+    // Resting orders that are filled are described by their last fill, unless the command
+    // had already affected them.
+    report.updateOrder(order);
+    deleteOrder(order.getOrderID(), false);
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::raiseExecutionReport()
+{
+    if (!execution_reports || report.empty())
+        return;
+    // Orders that are still in the book have changed since they were recorded if they were
+    // matched after they were added or activated.
+    for (OrderReport &order_report : report.orders)
+    {
+        ArrayOrderWrapper *wrapper = orders.find(order_report.order.getOrderID());
+        order_report.resting = wrapper != nullptr;
+        if (wrapper)
+        {
+            refreshTrailingStopPrice(*wrapper);
+            order_report.order = wrapper->order;
+        }
+    }
+    event_handler->handleExecutionReport(report);
+    report.clear();
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::addLimitOrder(Order &order)
+{
+    match(order);
+    if (!order.isFilled() && !order.isIoc() && !order.isFok() && inBand(order.getPrice()))
+        insertLimitOrder(order);
+    else if (!recordOrder(order))
+        event_handler->handleOrderDeleted(OrderDeleted{order});
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::insertLimitOrder(const Order &order)
+{
+    size_t index = priceToIndex(order.getPrice());
+    if (order.isAsk())
+    {
+        Level &level = ask_ladder.occupy(index);
+        ArrayOrderWrapper *wrapper = order_pool.construct(ArrayOrderWrapper{&level, order});
+        orders.insert(order.getOrderID(), wrapper);
+        level.addOrder(wrapper->order);
+        ask_ladder.addVolume(index, order.getOpenQuantity());
+        if (best_ask_index == NO_LEVEL || index < best_ask_index)
+            best_ask_index = index;
+    }
+    else
+    {
+        Level &level = bid_ladder.occupy(index);
+        ArrayOrderWrapper *wrapper = order_pool.construct(ArrayOrderWrapper{&level, order});
+        orders.insert(order.getOrderID(), wrapper);
+        level.addOrder(wrapper->order);
+        bid_ladder.addVolume(index, order.getOpenQuantity());
+        if (best_bid_index == NO_LEVEL || index > best_bid_index)
+            best_bid_index = index;
+    }
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::addMarketOrder(Order &order)
+{
+    order.setPrice(order.isAsk() ? 0 : std::numeric_limits<uint64_t>::max());
+    match(order);
+    if (!recordOrder(order))
+        event_handler->handleOrderDeleted(OrderDeleted{order});
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::addStopOrder(Order &order)
+{
+    if (order.isTrailingStop() || order.isTrailingStopLimit())
+        calculateStopPrice(order);
+    uint64_t market_price = order.isAsk() ? lastTradedPriceBid() : lastTradedPriceAsk();
+    uint64_t order_stop_price = order.getStopPrice();
+    uint8_t match = (order.isAsk() && market_price <= order_stop_price) + (order.isBid() && market_price >= order_stop_price);
+    if (match)
+    {
+        order.setType((order.isStop() || order.isTrailingStop()) ? OrderType::Market : OrderType::Limit);
+        order.setStopPrice(0);
+        order.setTrailAmount(0);
+        if (!recordOrder(order))
+            event_handler->handleOrderUpdated(OrderUpdated{order});
+        order.isMarket() ? addMarketOrder(order) : addLimitOrder(order);
+        return;
+    }
+    order.isTrailingStop() || order.isTrailingStopLimit() ? insertTrailingStopOrder(order) : insertStopOrder(order);
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::insertStopOrder(const Order &order)
+{
+    auto &levels = order.isAsk() ? stop_ask_levels : stop_bid_levels;
+    LevelSide side = order.isAsk() ? LevelSide::Ask : LevelSide::Bid;
+    auto level_it = levels
+                        .emplace(std::piecewise_construct, std::make_tuple(order.getStopPrice()),
+                            std::make_tuple(order.getStopPrice(), side, symbol_id))
+                        .first;
+    ArrayOrderWrapper *wrapper = order_pool.construct(ArrayOrderWrapper{&level_it->second, order});
+    orders.insert(order.getOrderID(), wrapper);
+    level_it->second.addOrder(wrapper->order);
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::insertTrailingStopOrder(const Order &order)
+{
+    auto &levels = order.isAsk() ? trailing_stop_ask_levels : trailing_stop_bid_levels;
+    LevelSide side = order.isAsk() ? LevelSide::Ask : LevelSide::Bid;
+    uint64_t offset;
+    if (order.isAsk())
+    {
+        // An empty side has no reference price yet, so anchor it to the present market price.
+        if (levels.empty())
+            trailing_ask_reference = lastTradedPriceBid();
+        assert(order.getStopPrice() <= trailing_ask_reference && "Ask trailing stop price cannot exceed the reference price!");
+        offset = trailing_ask_reference - order.getStopPrice();
+    }
+    else
+    {
+        if (levels.empty())
+            trailing_bid_reference = lastTradedPriceAsk();
+        assert(order.getStopPrice() >= trailing_bid_reference && "Bid trailing stop price cannot be below the reference price!");
+        offset = order.getStopPrice() - trailing_bid_reference;
+    }
+    auto level_it = levels.emplace(std::piecewise_construct, std::make_tuple(offset), std::make_tuple(offset, side, symbol_id)).first;
+    ArrayOrderWrapper *wrapper = order_pool.construct(ArrayOrderWrapper{&level_it->second, order});
+    orders.insert(order.getOrderID(), wrapper);
+    level_it->second.addOrder(wrapper->order);
+    if (isUnanchored(*wrapper))
+        addUnanchoredTrailingStopOrder(order.isAsk() ? unanchored_trailing_ask_orders : unanchored_trailing_bid_orders, order.getOrderID());
+}
+
+template<typename Handler>
+uint64_t BasicArrayOrderBook<Handler>::calculateStopPrice(Order &order)
+{
+    if (order.isAsk())
+    {
+        uint64_t market_price = lastTradedPriceBid();
+        uint64_t trail_amount = order.getTrailAmount();
+        // Set the new stop price to zero if the trail amount meets or exceeds the market price.
+        uint64_t new_stop_price = market_price > trail_amount ? market_price - trail_amount : 0;
+        order.setStopPrice(new_stop_price);
+        return new_stop_price;
+    }
+    else
+    {
+        uint64_t market_price = lastTradedPriceAsk();
+        uint64_t trail_amount = order.getTrailAmount();
+        // Set the new stop price to max 64-bit integer value if the sum of trail amount and the market
+        // price exceeds the max 64-bit integer value.
+        uint64_t new_stop_price = market_price < (std::numeric_limits<uint64_t>::max() - trail_amount)
+                                      ? market_price + trail_amount
+                                      : std::numeric_limits<uint64_t>::max();
+        order.setStopPrice(new_stop_price);
+        return new_stop_price;
+    }
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::activateStopOrders()
+{
+    // Stop orders are only triggered by trades. Activating stop orders may result in trades
+    // which may trigger more stop orders, so continue until the last traded price settles.
+    while (last_traded_price != stop_check_price)
+    {
+        stop_check_price = last_traded_price;
+        activateBidStopOrders();
+        updateAskStopOrders();
+        activateAskStopOrders();
+        updateBidStopOrders();
+    }
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::activateBidStopOrders()
+{
+    uint64_t last_ask_price = lastTradedPriceAsk();
+    auto stop_levels_end = stop_bid_levels.upper_bound(last_ask_price);
+    for (auto stop_levels_it = stop_bid_levels.begin(); stop_levels_it != stop_levels_end; ++stop_levels_it)
+        addTriggeredOrders(stop_levels_it->second);
+    stop_bid_levels.erase(stop_bid_levels.begin(), stop_levels_end);
+    activateTriggeredOrders();
+    // Trailing stop levels with the smallest offsets have the lowest stop prices.
+    last_ask_price = lastTradedPriceAsk();
+    auto trailing_stop_levels_end = trailing_stop_bid_levels.begin();
+    while (trailing_stop_levels_end != trailing_stop_bid_levels.end() && trailingBidStopPrice(trailing_stop_levels_end->first) <= last_ask_price)
+        addTriggeredOrders((trailing_stop_levels_end++)->second);
+    trailing_stop_bid_levels.erase(trailing_stop_bid_levels.begin(), trailing_stop_levels_end);
+    activateTriggeredOrders();
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::activateAskStopOrders()
+{
+    uint64_t last_bid_price = lastTradedPriceBid();
+    // Activate the highest stop prices first.
+    auto stop_levels_begin = stop_ask_levels.lower_bound(last_bid_price);
+    for (auto stop_levels_it = stop_ask_levels.end(); stop_levels_it != stop_levels_begin;)
+        addTriggeredOrders((--stop_levels_it)->second);
+    stop_ask_levels.erase(stop_levels_begin, stop_ask_levels.end());
+    activateTriggeredOrders();
+    // Trailing stop levels with the smallest offsets have the highest stop prices.
+    last_bid_price = lastTradedPriceBid();
+    auto trailing_stop_levels_end = trailing_stop_ask_levels.begin();
+    while (trailing_stop_levels_end != trailing_stop_ask_levels.end() && trailingAskStopPrice(trailing_stop_levels_end->first) >= last_bid_price)
+        addTriggeredOrders((trailing_stop_levels_end++)->second);
+    trailing_stop_ask_levels.erase(trailing_stop_ask_levels.begin(), trailing_stop_levels_end);
+    activateTriggeredOrders();
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::addTriggeredOrders(const Level &level)
+{
+    for (const Order &order : level.getOrders())
+        triggered_orders.push_back(order);
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::activateTriggeredOrders()
+{
+    // The levels of the triggered orders have been erased, so the orders are no longer linked.
+    for (const Order &order : triggered_orders)
+    {
+        order_pool.destroy(orders.find(order.getOrderID()));
+        orders.erase(order.getOrderID());
+    }
+    for (const Order &order : triggered_orders)
+        activateStopOrder(order);
+    triggered_orders.clear();
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::activateStopOrder(Order order)
+{
+    order.setStopPrice(0);
+    order.setTrailAmount(0);
+    // Convert the stop / trailing stop order to a limit or market order and match it.
+    if (order.isStop() || order.isTrailingStop())
+    {
+        order.setType(OrderType::Market);
+        if (!recordOrder(order))
+            event_handler->handleOrderUpdated(OrderUpdated{order});
+        addMarketOrder(order);
+    }
+    else
+    {
+        order.setType(OrderType::Limit);
+        if (!recordOrder(order))
+            event_handler->handleOrderUpdated(OrderUpdated{order});
+        addLimitOrder(order);
+    }
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::updateBidStopOrders()
+{
+    if (trailing_ask_price <= lastTradedPriceAsk() || trailing_stop_bid_levels.empty())
+    {
+        trailing_ask_price = last_traded_price;
+        return;
+    }
+    // Moving the reference price reprices every trailing stop order on the bid side.
+    trailing_bid_reference = lastTradedPriceAsk();
+    anchorTrailingStopOrders(unanchored_trailing_bid_orders, trailing_stop_bid_levels, LevelSide::Bid);
+    trailing_ask_price = last_traded_price;
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::updateAskStopOrders()
+{
+    if (trailing_bid_price >= lastTradedPriceBid() || trailing_stop_ask_levels.empty())
+    {
+        trailing_bid_price = last_traded_price;
+        return;
+    }
+    // Moving the reference price reprices every trailing stop order on the ask side.
+    trailing_ask_reference = lastTradedPriceBid();
+    anchorTrailingStopOrders(unanchored_trailing_ask_orders, trailing_stop_ask_levels, LevelSide::Ask);
+    trailing_bid_price = last_traded_price;
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::anchorTrailingStopOrders(
+    std::vector<uint64_t> &unanchored_orders, std::pmr::map<uint64_t, Level> &trailing_levels, LevelSide side)
+{
+    for (uint64_t order_id : unanchored_orders)
+    {
+        // The order may have been activated or deleted since it was recorded.
+        ArrayOrderWrapper *resting_order = orders.find(order_id);
+        if (!resting_order)
+            continue;
+        ArrayOrderWrapper &wrapper = *resting_order;
+        Order &stop_order = wrapper.order;
+        if (!(stop_order.isTrailingStop() || stop_order.isTrailingStopLimit()) || stop_order.isAsk() != (side == LevelSide::Ask) ||
+            !isUnanchored(wrapper))
+            continue;
+        uint64_t trail_amount = stop_order.getTrailAmount();
+        wrapper.level->deleteOrder(stop_order);
+        if (wrapper.level->empty())
+            trailing_levels.erase(wrapper.level->getPrice());
+        auto level_it =
+            trailing_levels.emplace(std::piecewise_construct, std::make_tuple(trail_amount), std::make_tuple(trail_amount, side, symbol_id))
+                .first;
+        wrapper.level = &level_it->second;
+        wrapper.level->addOrder(stop_order);
+    }
+    unanchored_orders.clear();
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::addUnanchoredTrailingStopOrder(std::vector<uint64_t> &unanchored_orders, uint64_t order_id)
+{
+    if (unanchored_orders.size() == unanchored_orders.capacity())
+    {
+        auto is_stale = [this](uint64_t id) {
+            ArrayOrderWrapper *wrapper = orders.find(id);
+            if (!wrapper)
+                return true;
+            const Order &stop_order = wrapper->order;
+            return !(stop_order.isTrailingStop() || stop_order.isTrailingStopLimit()) || !isUnanchored(*wrapper);
+        };
+        unanchored_orders.erase(std::remove_if(unanchored_orders.begin(), unanchored_orders.end(), is_stale), unanchored_orders.end());
+    }
+    unanchored_orders.push_back(order_id);
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::match(Order &order)
+{
+    // Order is a FOK order that cannot be filled.
+    if (order.isFok() && !canMatchOrder(order))
+        return;
+    if (order.isAsk())
+    {
+        Order &ask_order = order;
+        while (best_bid_index != NO_LEVEL && indexToPrice(best_bid_index) >= ask_order.getPrice() && !ask_order.isFilled())
+        {
+            Level &bid_level = bid_ladder[best_bid_index];
+            Order &bid_order = bid_level.front();
+            uint64_t executing_price = bid_order.getPrice();
+            executeOrders(ask_order, bid_order, executing_price);
+            bid_level.reduceVolume(bid_order.getLastExecutedQuantity());
+            bid_ladder.removeVolume(best_bid_index, bid_order.getLastExecutedQuantity());
+            // Deleting the last order in the best level moves the best bid index.
+            if (bid_order.isFilled())
+                deleteFilledOrder(bid_order);
+        }
+    }
+    if (order.isBid())
+    {
+        Order &bid_order = order;
+        while (best_ask_index != NO_LEVEL && indexToPrice(best_ask_index) <= bid_order.getPrice() && !bid_order.isFilled())
+        {
+            Level &ask_level = ask_ladder[best_ask_index];
+            Order &ask_order = ask_level.front();
+            uint64_t executing_price = ask_order.getPrice();
+            executeOrders(bid_order, ask_order, executing_price);
+            ask_level.reduceVolume(ask_order.getLastExecutedQuantity());
+            ask_ladder.removeVolume(best_ask_index, ask_order.getLastExecutedQuantity());
+            // Deleting the last order in the best level moves the best ask index.
+            if (ask_order.isFilled())
+                deleteFilledOrder(ask_order);
+        }
+    }
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::executeOrders(Order &aggressor, Order &passive, uint64_t executing_price)
+{
+    // Calculate the minimum quantity to match.
+    uint64_t matched_quantity = std::min(aggressor.getOpenQuantity(), passive.getOpenQuantity());
+    aggressor.execute(executing_price, matched_quantity);
+    passive.execute(executing_price, matched_quantity);
+    if (execution_reports)
+    {
+        report.fills.emplace_back(symbol_id, ++trade_seq, aggressor, passive);
+    }
+    else if (trade_events)
+    {
+        event_handler->handleTrade(Trade{symbol_id, ++trade_seq, aggressor, passive});
+    }
+    else
+    {
+        Order &bid = aggressor.isBid() ? aggressor : passive;
+        Order &ask = aggressor.isBid() ? passive : aggressor;
+        event_handler->handleOrderExecuted(ExecutedOrder{bid});
+        event_handler->handleOrderExecuted(ExecutedOrder{ask});
+    }
+    last_traded_price = executing_price;
+}
+
+template<typename Handler>
+bool BasicArrayOrderBook<Handler>::canMatchOrder(const Order &order) const
+{
+    OrderSide opposite_side = order.isAsk() ? OrderSide::Bid : OrderSide::Ask;
+    return volumeAtOrBetter(opposite_side, order.getPrice()) >= order.getOpenQuantity();
+}
+
+template<typename Handler>
+uint64_t BasicArrayOrderBook<Handler>::volumeAtOrBetter(OrderSide side, uint64_t price) const
+{
+    if (side == OrderSide::Bid)
+    {
+        if (price > max_price)
+            return 0;
+        if (price <= min_price)
+            return bid_ladder.totalVolume();
+        // Bids in levels below the first level priced at or above price are excluded.
+        size_t first_index = (price - min_price + tick_size - 1) / tick_size;
+        return bid_ladder.totalVolume() - bid_ladder.volumeUpTo(first_index - 1);
+    }
+    if (price < min_price)
+        return 0;
+    if (price >= max_price)
+        return ask_ladder.totalVolume();
+    return ask_ladder.volumeUpTo(priceToIndex(price - (price - min_price) % tick_size));
+}
+
+// LCOV_EXCL_START
+template<typename Handler>
+std::string BasicArrayOrderBook<Handler>::toString() const
+{
+    std::string book_string;
+    book_string += "SYMBOL ID : " + std::to_string(symbol_id) + "\n";
+    book_string += "LAST TRADED PRICE: " + std::to_string(last_traded_price) + "\n";
+    book_string += "BID ORDERS\n";
+    for (size_t index = bid_ladder.findNext(0); index != NO_LEVEL; index = bid_ladder.findNext(index + 1))
+        book_string += bid_ladder[index].toString();
+    book_string += "ASK ORDERS\n";
+    for (size_t index = ask_ladder.findNext(0); index != NO_LEVEL; index = ask_ladder.findNext(index + 1))
+        book_string += ask_ladder[index].toString();
+    book_string += "BID STOP ORDERS\n";
+    for (const auto &[price, level] : stop_bid_levels)
+        book_string += level.toString();
+    book_string += "ASK STOP ORDERS\n";
+    for (const auto &[price, level] : stop_ask_levels)
+        book_string += level.toString();
+    book_string += "BID TRAILING STOP ORDERS\n";
+    for (const auto &[price, level] : trailing_stop_bid_levels)
+        book_string += level.toString();
+    book_string += "ASK TRAILING STOP ORDERS\n";
+    for (const auto &[price, level] : trailing_stop_ask_levels)
+        book_string += level.toString();
+    return book_string;
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::dumpBook(const std::string &path) const
+{
+    std::ofstream file(path);
+    file << toString();
+    file.close();
+}
+
+template<typename Handler>
+void BasicArrayOrderBook<Handler>::validateOrderBook() const
+{
+    assert(bestAsk() > bestBid() && "Best bid price should never be lower than best ask price!");
+    assert(best_ask_index == ask_ladder.findNext(0) && "Best ask index does not point at the lowest occupied ask level!");
+    assert((bid_ladder.size() == 0 || best_bid_index == bid_ladder.findPrev(bid_ladder.size() - 1)) &&
+           "Best bid index does not point at the highest occupied bid level!");
+    uint64_t ask_volume = 0;
+    for (size_t index = ask_ladder.findNext(0); index != NO_LEVEL; index = ask_ladder.findNext(index + 1))
+    {
+        assert(!ask_ladder[index].empty() && "Occupied ask level should not be empty!");
+        ask_volume += ask_ladder[index].getVolume();
+        assert(ask_ladder.volumeUpTo(index) == ask_volume && "Ask depth index does not match the ask levels!");
+    }
+    assert(ask_ladder.totalVolume() == ask_volume && "Ask depth index does not match the ask levels!");
+    uint64_t bid_volume = 0;
+    for (size_t index = bid_ladder.findNext(0); index != NO_LEVEL; index = bid_ladder.findNext(index + 1))
+    {
+        assert(!bid_ladder[index].empty() && "Occupied bid level should not be empty!");
+        bid_volume += bid_ladder[index].getVolume();
+        assert(bid_ladder.volumeUpTo(index) == bid_volume && "Bid depth index does not match the bid levels!");
+    }
+    assert(bid_ladder.totalVolume() == bid_volume && "Bid depth index does not match the bid levels!");
+    for (const auto &[price, level] : stop_ask_levels)
+    {
+        assert(!level.empty() && "Empty stop levels should never be in the orderbook!");
+        assert(price < last_traded_price && "Stop level has ask price that meets or exceeds last traded price!");
+    }
+    for (const auto &[price, level] : stop_bid_levels)
+    {
+        assert(!level.empty() && "Empty stop levels should never be in the orderbook!");
+        assert(price > last_traded_price && "Stop level has bid price that meets or is below last traded price!");
+    }
+    for (const auto &[price, level] : trailing_stop_ask_levels)
+        assert(!level.empty() && "Empty trailing stop levels should never be in the orderbook!");
+    for (const auto &[price, level] : trailing_stop_bid_levels)
+        assert(!level.empty() && "Empty trailing stop levels should never be in the orderbook!");
+}
+} // namespace RapidTrader
+  // LCOV_EXCL_END
+#endif // RAPID_TRADER_ARRAY_ORDERBOOK_IMPL_H
@@ -0,0 +1,83 @@
+// //match_engine/include/matching/orderbook/depth_index.h
+#ifndef RAPID_TRADER_DEPTH_INDEX_H
+#define RAPID_TRADER_DEPTH_INDEX_H
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace RapidTrader {
+/**
+ * A Fenwick tree over the volumes of a ladder of price levels. Adjusting the
+ * volume of a level and querying the cumulative volume of a prefix of the
+ * ladder are both O(log n).
+ */
+class DepthIndex
+{
+public:
+    /**
+     * A constructor for the depth index. All volumes are initially zero.
+     *
+     * @param size_ the number of levels in the ladder.
+     */
+    explicit DepthIndex(size_t size_)
+        : tree(size_ + 1, 0)
+    {}
+
+    /**
+     * A constructor for an empty depth index over no levels, which allocates nothing.
+     */
+    DepthIndex() = default;
+
+    /**
+     * Adds volume to a level.
+     *
+     * @param index the index of the level, require that index < size().
+     * @param amount the volume to add.
+     */
+    void add(size_t index, uint64_t amount)
+    {
+        assert(index < size() && "Level index is out of range!");
+        for (size_t i = index + 1; i < tree.size(); i += i & (~i + 1))
+            tree[i] += amount;
+    }
+
+    /**
+     * Removes volume from a level.
+     *
+     * @param index the index of the level, require that index < size().
+     * @param amount the volume to remove, require that amount does not exceed the volume of the level.
+     */
+    void remove(size_t index, uint64_t amount)
+    {
+        assert(index < size() && "Level index is out of range!");
+        for (size_t i = index + 1; i < tree.size(); i += i & (~i + 1))
+            tree[i] -= amount;
+    }
+
+    /**
+     * @param index the index of the last level to include, require that index < size().
+     * @return the total volume of the levels at indices zero through index.
+     */
+    [[nodiscard]] uint64_t prefixVolume(size_t index) const
+    {
+        assert(index < size() && "Level index is out of range!");
+        uint64_t volume = 0;
+        for (size_t i = index + 1; i > 0; i -= i & (~i + 1))
+            volume += tree[i];
+        return volume;
+    }
+
+    /**
+     * @return the number of levels in the ladder.
+     */
+    [[nodiscard]] size_t size() const
+    {
+        return tree.empty() ? 0 : tree.size() - 1;
+    }
+
+private:
+    // One-based Fenwick tree, tree[i] holds the volume of levels (i - lowbit(i), i].
+    std::vector<uint64_t> tree;
+};
+} // namespace RapidTrader
+#endif // RAPID_TRADER_DEPTH_INDEX_H
@@ -20,10 +20,16 @@ using namespace boost::intrusive;
 
 /**
  * Represents a price level in an orderbook.
+ *
+ * @tparam Price the price type of the orders in the level, see BasicOrder.
+ * @tparam Quantity the quantity type of the orders in the level, see BasicOrder.
  */
-class Level
+template<typename Price, typename Quantity>
+class BasicLevel
 {
 public:
+    using LevelOrder = BasicOrder<Price, Quantity>;
+
     /**
      * A constructor for the level.
      *
@@ -31,17 +37,17 @@ public:
      * @param side_ the side the level is on - either ask or bid.
      * @param symbol_id_ the symbol ID associated with the level.
      */
-    Level(uint64_t price_, LevelSide side_, uint32_t symbol_id_);
+    BasicLevel(uint64_t price_, LevelSide side_, uint32_t symbol_id_);
 
     /**
      * @return the orders in the level.
      */
-    [[nodiscard]] const list<Order> &getOrders() const;
+    [[nodiscard]] const list<LevelOrder> &getOrders() const;
 
     /**
      * @return the orders in the level.
      */
-    [[nodiscard]] list<Order> &getOrders();
+    [[nodiscard]] list<LevelOrder> &getOrders();
 
     /**
      * @return the price associated with the level.
@@ -111,13 +117,13 @@ public:
      * @return the least recently inserted order in the level,
      *         require that the level is non-empty.
      */
-    Order &front();
+    LevelOrder &front();
 
     /**
      * @return the most recently inserted order in the level,
      *         require that the level is non-empty.
      */
-    Order &back();
+    LevelOrder &back();
 
     /**
      * Adds an order to the level.
@@ -125,7 +131,7 @@ public:
      * @param order the order to add, require that order is on the same side as the level,
      *              has the same price as the level, and has the same symbol ID as the level.
      */
-    void addOrder(Order &order);
+    void addOrder(LevelOrder &order);
 
     /**
      * Removes the least recently inserted order from the level, require
@@ -145,7 +151,7 @@ public:
      * @param order the order to delete, require that the order
      *              is in the level.
      */
-    void deleteOrder(const Order &order);
+    void deleteOrder(const LevelOrder &order);
 
     /**
      * Reduce the current volume of the level.
@@ -159,7 +165,11 @@ public:
      */
     [[nodiscard]] std::string toString() const;
 
-    friend std::ostream &operator<<(std::ostream &os, const Level &level);
+    friend std::ostream &operator<<(std::ostream &os, const BasicLevel &level)
+    {
+        os << level.toString();
+        return os;
+    }
 
 private:
     /**
@@ -175,11 +185,17 @@ private:
      */
     void validateLevel() const;
 
-    list<Order> orders;
+    list<LevelOrder> orders;
     LevelSide side;
     uint32_t symbol_id;
     uint64_t volume;
     uint64_t price;
 };
+
+// Levels of orders with 64-bit prices and quantities.
+using Level = BasicLevel<uint64_t, uint64_t>;
+
+extern template class BasicLevel<uint64_t, uint64_t>;
+extern template class BasicLevel<uint32_t, uint32_t>;
 } // namespace RapidTrader
 #endif // RAPID_TRADER_LEVEL_H
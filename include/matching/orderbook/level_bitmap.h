@@ -0,0 +1,224 @@
+// //match_engine/include/matching/orderbook/level_bitmap.h
+#ifndef RAPID_TRADER_LEVEL_BITMAP_H
+#define RAPID_TRADER_LEVEL_BITMAP_H
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace RapidTrader {
+/**
+ * A hierarchical occupancy bitmap over a ladder of price levels.
+ *
+ * The bottom layer has one bit per level. Each layer above it has one bit per
+ * 64-bit word of the layer below, set iff that word is non-zero, until a layer
+ * fits in a single word. Finding the next or previous occupied level is a
+ * count-trailing/leading-zeros scan per layer, so at most a handful of
+ * instructions even for ladders with millions of levels.
+ *
+ * The bottom layer is stored in pages of PAGE_SIZE levels that are only
+ * allocated the first time a level inside the page is occupied, like the pages
+ * of a price ladder. A wide, sparsely populated ladder pays one pointer per page
+ * and one bit per 64 levels for the layers above, and one bit per level only for
+ * the pages it touches.
+ */
+class LevelBitmap
+{
+public:
+    // Returned by the find functions if there is no occupied level.
+    static constexpr size_t NOT_FOUND = std::numeric_limits<size_t>::max();
+    // The number of levels per page of the bottom layer.
+    static constexpr size_t PAGE_SIZE = 1024;
+
+    /**
+     * A constructor for the level bitmap.
+     *
+     * @param size_ the number of levels in the ladder, require that size_ is positive.
+     */
+    explicit LevelBitmap(size_t size_)
+        : size(size_)
+        , pages((size_ + PAGE_SIZE - 1) / PAGE_SIZE)
+    {
+        assert(size > 0 && "Level bitmap must have at least one level!");
+        size_t num_bits = (size + 63) / 64;
+        while (num_bits > 1)
+        {
+            size_t num_words = (num_bits + 63) / 64;
+            layers.emplace_back(num_words, 0);
+            num_bits = num_words;
+        }
+    }
+
+    /**
+     * Marks a level as occupied.
+     *
+     * @param index the index of the level, require that index < size.
+     */
+    void set(size_t index)
+    {
+        assert(index < size && "Level index is out of range!");
+        std::unique_ptr<uint64_t[]> &page = pages[index / PAGE_SIZE];
+        if (!page)
+            page = std::make_unique<uint64_t[]>(WORDS_PER_PAGE);
+        uint64_t &bottom_word = page[index % PAGE_SIZE >> 6];
+        bool was_empty = bottom_word == 0;
+        bottom_word |= uint64_t{1} << (index & 63);
+        // The layers above already know about this word.
+        if (!was_empty)
+            return;
+        index >>= 6;
+        for (auto &layer : layers)
+        {
+            uint64_t &word = layer[index >> 6];
+            was_empty = word == 0;
+            word |= uint64_t{1} << (index & 63);
+            if (!was_empty)
+                return;
+            index >>= 6;
+        }
+    }
+
+    /**
+     * Marks a level as empty.
+     *
+     * @param index the index of the level, require that index < size.
+     */
+    void clear(size_t index)
+    {
+        assert(index < size && "Level index is out of range!");
+        const std::unique_ptr<uint64_t[]> &page = pages[index / PAGE_SIZE];
+        // Levels of pages that were never occupied are already empty.
+        if (!page)
+            return;
+        uint64_t &bottom_word = page[index % PAGE_SIZE >> 6];
+        bottom_word &= ~(uint64_t{1} << (index & 63));
+        // The word still has occupied levels, so the layers above are unchanged.
+        if (bottom_word != 0)
+            return;
+        index >>= 6;
+        for (auto &layer : layers)
+        {
+            uint64_t &word = layer[index >> 6];
+            word &= ~(uint64_t{1} << (index & 63));
+            if (word != 0)
+                return;
+            index >>= 6;
+        }
+    }
+
+    /**
+     * @param index the index of the level, require that index < size.
+     * @return true if the level is occupied and false otherwise.
+     */
+    [[nodiscard]] bool test(size_t index) const
+    {
+        assert(index < size && "Level index is out of range!");
+        return (loadWord(0, index >> 6) >> (index & 63)) & 1;
+    }
+
+    /**
+     * @param index the index to start searching from.
+     * @return the lowest occupied index that is greater than or equal to index, or
+     *         NOT_FOUND if there is no such index.
+     */
+    [[nodiscard]] size_t findNext(size_t index) const
+    {
+        size_t layer = 0;
+        // Climb until a layer has a set bit at or after the current position.
+        while (true)
+        {
+            size_t word_index = index >> 6;
+            if (layer == numLayers() || word_index >= numWords(layer))
+                return NOT_FOUND;
+            uint64_t word = loadWord(layer, word_index) & (~uint64_t{0} << (index & 63));
+            if (word != 0)
+            {
+                index = (word_index << 6) + __builtin_ctzll(word);
+                break;
+            }
+            index = word_index + 1;
+            ++layer;
+        }
+        // Descend, taking the lowest set bit of each word.
+        while (layer-- > 0)
+            index = (index << 6) + __builtin_ctzll(loadWord(layer, index));
+        return index;
+    }
+
+    /**
+     * @param index the index to start searching from, require that index < size.
+     * @return the highest occupied index that is less than or equal to index, or
+     *         NOT_FOUND if there is no such index.
+     */
+    [[nodiscard]] size_t findPrev(size_t index) const
+    {
+        assert(index < size && "Level index is out of range!");
+        size_t layer = 0;
+        // Climb until a layer has a set bit at or before the current position.
+        while (true)
+        {
+            if (layer == numLayers())
+                return NOT_FOUND;
+            size_t word_index = index >> 6;
+            uint64_t word = loadWord(layer, word_index) & (~uint64_t{0} >> (63 - (index & 63)));
+            if (word != 0)
+            {
+                index = (word_index << 6) + 63 - __builtin_clzll(word);
+                break;
+            }
+            if (word_index == 0)
+                return NOT_FOUND;
+            index = word_index - 1;
+            ++layer;
+        }
+        // Descend, taking the highest set bit of each word.
+        while (layer-- > 0)
+            index = (index << 6) + 63 - __builtin_clzll(loadWord(layer, index));
+        return index;
+    }
+
+private:
+    // The number of words per page of the bottom layer.
+    static constexpr size_t WORDS_PER_PAGE = PAGE_SIZE / 64;
+
+    /**
+     * @return the number of layers, including the bottom layer.
+     */
+    [[nodiscard]] size_t numLayers() const
+    {
+        return layers.size() + 1;
+    }
+
+    /**
+     * @param layer the layer, where zero is the bottom layer.
+     * @return the number of words in the layer.
+     */
+    [[nodiscard]] size_t numWords(size_t layer) const
+    {
+        return layer == 0 ? (size + 63) / 64 : layers[layer - 1].size();
+    }
+
+    /**
+     * @param layer the layer, where zero is the bottom layer.
+     * @param word_index the index of the word in the layer, require that word_index < numWords(layer).
+     * @return the word, zero if it is in a page that was never occupied.
+     */
+    [[nodiscard]] uint64_t loadWord(size_t layer, size_t word_index) const
+    {
+        if (layer > 0)
+            return layers[layer - 1][word_index];
+        const std::unique_ptr<uint64_t[]> &page = pages[word_index / WORDS_PER_PAGE];
+        return page ? page[word_index % WORDS_PER_PAGE] : 0;
+    }
+
+    // The number of levels in the ladder.
+    size_t size;
+    // The pages of the bottom layer, which has one bit per level. Pages that were never
+    // occupied are null.
+    std::vector<std::unique_ptr<uint64_t[]>> pages;
+    // layers[0] has one bit per word of the bottom layer, layers[i + 1] has one bit per word of layers[i].
+    std::vector<std::vector<uint64_t>> layers;
+};
+} // namespace RapidTrader
+#endif // RAPID_TRADER_LEVEL_BITMAP_H
@@ -3,8 +3,12 @@
 #define RAPID_TRADER_MAP_ORDERBOOK_H
 #include <map>
 #include <limits>
+#include <memory_resource>
+#include <vector>
 #include "utils/robin_hood.h" // *** CORRECTED PATH ***
+#include "utils/object_pool.h"
 #include "matching/orderbook/level.h"
+#include "matching/orderbook/order_index.h"
 #include "matching/orderbook/orderbook.h"
 #include "matching/orderbook/order.h"
 #include "event_handler/event_handler.h"
@@ -17,27 +21,65 @@ namespace RapidTrader {
 #    define VALIDATE_ORDERBOOK
 #endif
 
-struct OrderWrapper
+// Maps prices to levels. Level nodes are allocated from the pool resource of the owning book.
+template<typename Price, typename Quantity>
+using BasicPriceLevels = std::pmr::map<uint64_t, BasicLevel<Price, Quantity>>;
+
+template<typename Price, typename Quantity>
+struct BasicOrderWrapper
 {
-    Order order;
     // An iterator to the level that the order is stored in.
     // Used for finding the level to delete the order from in constant time.
     // Be careful about iterator invalidation! For the STL map, this iterator
     // will remain valid as long as element that iterator corresponds to in
     // the map is deleted. Insertions and deletions do not invalidate the iterator.
-    std::map<uint64_t, Level>::iterator level_it;
+    typename BasicPriceLevels<Price, Quantity>::iterator level_it;
+    // The order follows the level so that the level and the hot fields of the order share a cache line.
+    BasicOrder<Price, Quantity> order;
 };
 
-class MapOrderBook : public OrderBook
+static_assert(sizeof(BasicOrderWrapper<uint64_t, uint64_t>) == sizeof(BasicPriceLevels<uint64_t, uint64_t>::iterator) + sizeof(BasicOrder<uint64_t, uint64_t>),
+    "The order must directly follow its level iterator!");
+
+/**
+ * An orderbook that stores price levels in ordered maps.
+ *
+ * @tparam Handler the type of the event handler that the book reports to. Events are
+ *                 dispatched through Handler directly, so if Handler is a final class
+ *                 the handle methods are resolved and inlined at compile time.
+ * @tparam Price the price type of the resting orders. Added orders with a price that does not
+ *               fit in Price are deleted without being matched, and replacements and
+ *               executions at such a price are ignored, so prices are never truncated.
+ * @tparam Quantity the quantity type of the resting orders. Added orders with a quantity that
+ *                  does not fit in Quantity are deleted without being matched, and cancelling
+ *                  such a quantity deletes the order.
+ */
+template<typename Handler, typename Price = uint64_t, typename Quantity = uint64_t>
+class BasicMapOrderBook : public OrderBook
 {
 public:
+    // The types that the book stores resting orders in. Orders are converted to BookOrder
+    // when they are added, and back to Order when they are reported.
+    using BookOrder = BasicOrder<Price, Quantity>;
+    using BookLevel = BasicLevel<Price, Quantity>;
+    using PriceLevels = BasicPriceLevels<Price, Quantity>;
+    using OrderWrapper = BasicOrderWrapper<Price, Quantity>;
+
     /**
-     * A constructor for the MapOrderBook.
+     * A constructor for the BasicMapOrderBook.
      *
      * @param symbol_id_ the symbol ID that will be associated with the book.
      * @param event_handler_ handles updates from the book.
+     * @param order_capacity the number of resting orders to allocate space for up front.
+     * @param sequential_order_ids true if order IDs are nearly monotonic, in which case resting
+     *                             orders are indexed directly by ID instead of hashing them.
+     */
+    BasicMapOrderBook(uint32_t symbol_id_, Handler &event_handler_, size_t order_capacity = 0, bool sequential_order_ids = false);
+
+    /**
+     * A destructor for the BasicMapOrderBook. Returns all resting orders to the order pool.
      */
-    MapOrderBook(uint32_t symbol_id_, EventHandler &event_handler_);
+    ~BasicMapOrderBook() override;
 
     /**
      * @inheritdoc
@@ -74,15 +116,17 @@ public:
      */
     [[nodiscard]] bool hasOrder(uint64_t order_id) const override
     {
-        return orders.find(order_id) != orders.end();
+        return orders.find(order_id) != nullptr;
     }
 
     /**
      * @inheritdoc
      */
-    [[nodiscard]] const Order &getOrder(uint64_t order_id) const override
+    [[nodiscard]] Order getOrder(uint64_t order_id) const override
     {
-        return orders.find(order_id)->second.order;
+        OrderWrapper *wrapper = orders.find(order_id);
+        refreshTrailingStopPrice(*wrapper);
+        return wrapper->order;
     }
 
     /**
@@ -125,6 +169,25 @@ public:
         return last_traded_price;
     }
 
+    /**
+     * @inheritdoc
+     *
+     * Levels are keyed by arbitrary prices rather than by ticks, so there is no dense index
+     * to keep a depth index over. The query sums the levels priced at or better than price,
+     * in time linear in their number.
+     */
+    [[nodiscard]] uint64_t volumeAtOrBetter(OrderSide side, uint64_t price) const override;
+
+    /**
+     * @inheritdoc
+     */
+    void setEventHandler(EventHandler &event_handler_) override
+    {
+        event_handler = &static_cast<Handler &>(event_handler_);
+        trade_events = event_handler->handlesTrades();
+        execution_reports = event_handler->handlesExecutionReports();
+    }
+
     /**
      * @inheritdoc
      */
@@ -135,7 +198,11 @@ public:
      */
     [[nodiscard]] std::string toString() const override;
 
-    friend std::ostream &operator<<(std::ostream &os, const MapOrderBook &book);
+    friend std::ostream &operator<<(std::ostream &os, const BasicMapOrderBook &book)
+    {
+        os << book.toString();
+        return os;
+    }
 
 private:
     /**
@@ -149,48 +216,80 @@ private:
      */
     void deleteOrder(uint64_t order_id, bool notification);
 
+    /**
+     * Deletes a resting order that has been filled by an incoming order.
+     *
+     * @param order the order, require that the order is in the book and filled.
+     */
+    void deleteFilledOrder(BookOrder &order);
+
+    /**
+     * Records the state of an order in the execution report of the current command, if the
+     * event handler handles execution reports.
+     *
+     * @param order the order, an Order or a BookOrder. Book orders are only converted if
+     *              they are recorded.
+     * @return true if the order was recorded, and false if the event that describes the
+     *         change to the order should be raised instead.
+     */
+    template<typename AnyOrder>
+    bool recordOrder(const AnyOrder &order)
+    {
+        if (!execution_reports)
+            return false;
+        report.recordOrder(order);
+        return true;
+    }
+
+    /**
+     * Completes the execution report of the current command with the final state of each
+     * order in it, raises it, and clears it for the next command. Does nothing if the event
+     * handler does not handle execution reports or the command did not change the book.
+     */
+    void raiseExecutionReport();
+
     /**
      * Submits a limit order to the book.
      *
      * @param order the limit order to add to the book, require that the order
      *              does not already exist in the book.
      */
-    void addLimitOrder(Order &order);
+    void addLimitOrder(BookOrder &order);
 
     /**
      * Inserts a limit order into the book.
      *
      * @param order the order to insert.
      */
-    void insertLimitOrder(const Order &order);
+    void insertLimitOrder(const BookOrder &order);
 
     /**
      * Submits a market order to the book.
      *
      * @param order the market order to add to the book.
      */
-    void addMarketOrder(Order &order);
+    void addMarketOrder(BookOrder &order);
 
     /**
      * Inserts a trailing restart order into the book.
      *
      * @param order the trailing restart order to insert.
      */
-    void insertTrailingStopOrder(const Order &order);
+    void insertTrailingStopOrder(const BookOrder &order);
 
     /**
      * Submits a restart market order to the book.
      *
      * @param order the restart market order to submit to the book.
      */
-    void addStopOrder(Order &order);
+    void addStopOrder(BookOrder &order);
 
     /**
      * Inserts a restart order into the book.
      *
      * @param order the restart order to insert.
      */
-    void insertStopOrder(const Order &order);
+    void insertStopOrder(const BookOrder &order);
 
     /**
      * Calculates the stop price of a trailing stop
@@ -200,49 +299,138 @@ private:
      *              order is a trailing stop ir trailing stop limit order.
      * @return the new stop price of the order.
      */
-    uint64_t calculateStopPrice(Order &order);
+    uint64_t calculateStopPrice(BookOrder &order);
 
     /**
-     * Updates the restart price of trailing stop orders on the bid side.
+     * Moves the reference price of trailing stop orders on the bid side if the market
+     * price has fallen. Trailing stop levels are keyed by their offset from the reference
+     * price, so this does not touch the levels except to re-anchor orders whose offset
+     * differs from their trail amount.
      */
     void updateBidStopOrders();
 
     /**
-     * Updates the stop price of trailing restart orders on the ask side.
+     * Moves the reference price of trailing stop orders on the ask side if the market
+     * price has risen. Trailing stop levels are keyed by their offset from the reference
+     * price, so this does not touch the levels except to re-anchor orders whose offset
+     * differs from their trail amount.
      */
     void updateAskStopOrders();
 
     /**
-     * Activates stop limit and restart market orders if the last traded
-     * price is suitable.
+     * Moves trailing stop orders whose offset from the reference price differs from their
+     * trail amount to the level keyed by their trail amount. Each order is moved at most once.
+     *
+     * @param unanchored_orders the IDs of the orders to re-anchor, cleared on return.
+     * @param trailing_levels the trailing stop levels that the orders are in.
+     * @param side the side of the book that the trailing stop levels are on.
      */
-    void activateStopOrders();
+    void anchorTrailingStopOrders(std::vector<uint64_t> &unanchored_orders, PriceLevels &trailing_levels, LevelSide side);
 
     /**
-     * Attempts to activate stop, stop limit, trailing restart, and trailing stop limit
-     * orders on the bid side.
+     * Records a trailing stop order whose offset from the reference price differs from
+     * its trail amount. Stale IDs are dropped before the list has to grow.
      *
-     * @return true if any restart orders were activated and false otherwise.
+     * @param unanchored_orders the IDs of the unanchored orders on the side of the order.
+     * @param order_id the ID of the order, require that the order is in the book.
      */
-    bool activateBidStopOrders();
+    void addUnanchoredTrailingStopOrder(std::vector<uint64_t> &unanchored_orders, uint64_t order_id);
+
+    /**
+     * @param wrapper the wrapper of a trailing stop order in the book.
+     * @return true if the offset of the order from the reference price is not its trail amount.
+     */
+    [[nodiscard]] static bool isUnanchored(const OrderWrapper &wrapper)
+    {
+        return wrapper.level_it->first != wrapper.order.getTrailAmount();
+    }
 
     /**
-     * Attempts to activate restart, stop limit, trailing stop, and trailing stop limit
-     * orders on the ask side.
+     * @param offset the offset of a bid side trailing stop level from the reference price.
+     * @return the stop price of the orders in the level, unbounded if it does not fit in Price.
+     */
+    [[nodiscard]] uint64_t trailingBidStopPrice(uint64_t offset) const
+    {
+        return addPriceOffset(trailing_bid_reference, offset);
+    }
+
+    /**
+     * @param price a price.
+     * @param offset an offset from the price.
+     * @return the sum of the price and the offset, or max 64-bit integer value, the unbounded
+     *         price, if the sum does not fit in Price.
+     */
+    [[nodiscard]] static uint64_t addPriceOffset(uint64_t price, uint64_t offset)
+    {
+        constexpr auto price_limit = static_cast<uint64_t>(std::numeric_limits<Price>::max());
+        if (price >= price_limit || offset >= price_limit - price)
+            return std::numeric_limits<uint64_t>::max();
+        return price + offset;
+    }
+
+    /**
+     * @param offset the offset of an ask side trailing stop level from the reference price.
+     * @return the stop price of the orders in the level.
+     */
+    [[nodiscard]] uint64_t trailingAskStopPrice(uint64_t offset) const
+    {
+        return trailing_ask_reference > offset ? trailing_ask_reference - offset : 0;
+    }
+
+    /**
+     * Sets the stop price of a trailing stop order to the price derived from the
+     * reference price. Does nothing for other orders.
      *
-     * @return true if any restart orders were activated and false otherwise.
+     * @param wrapper the wrapper of an order in the book.
      */
-    bool activateAskStopOrders();
+    void refreshTrailingStopPrice(OrderWrapper &wrapper) const
+    {
+        BookOrder &order = wrapper.order;
+        if (order.isTrailingStop() || order.isTrailingStopLimit())
+            order.setStopPrice(order.isAsk() ? trailingAskStopPrice(wrapper.level_it->first) : trailingBidStopPrice(wrapper.level_it->first));
+    }
 
     /**
-     * Removes the provided order from the orderbook, converts it into a market
-     * or limit order, and submits it for matching.
+     * Activates stop, stop limit, trailing stop, and trailing stop limit orders if the
+     * last traded price has moved since stop orders were last checked. Does nothing
+     * if there have been no trades since the last check.
+     */
+    void activateStopOrders();
+
+    /**
+     * Activates stop, stop limit, trailing stop, and trailing stop limit
+     * orders on the bid side that are triggered by the last traded price.
+     */
+    void activateBidStopOrders();
+
+    /**
+     * Activates stop, stop limit, trailing stop, and trailing stop limit
+     * orders on the ask side that are triggered by the last traded price.
+     */
+    void activateAskStopOrders();
+
+    /**
+     * Copies the orders of a triggered stop level onto the triggered order work list.
+     * The level must be erased by the caller before the orders are activated.
+     *
+     * @param level the triggered stop level.
+     */
+    void addTriggeredOrders(const BookLevel &level);
+
+    /**
+     * Removes the orders on the triggered order work list from the book and activates
+     * them in the order that they were added. Empties the work list.
+     */
+    void activateTriggeredOrders();
+
+    /**
+     * Converts a triggered stop order that has been removed from the book into
+     * a market or limit order, and submits it for matching.
      *
-     * @param order the order to activate, require that order is has a stop, stop limit,
-     *              trailing stop, or trailing stop limit order that is presently in the
-     *              orderbook.
+     * @param order the order to activate, require that order is a stop, stop limit,
+     *              trailing stop, or trailing stop limit order.
      */
-    void activateStopOrder(Order order);
+    void activateStopOrder(BookOrder order);
 
     /**
      * Matches all crossed orders in the book. Orders that are filled
@@ -250,27 +438,29 @@ private:
      *
      * @param order the order to match.
      */
-    void match(Order &order);
+    void match(BookOrder &order);
 
     /**
      * Indicates whether an order is able to completely filled
-     * or not.
+     * or not. Walks the opposing levels that the order would cross,
+     * and stops as soon as they hold enough volume.
      *
      * @param order an order.
      * @return true if the order can be completely filled and false
      *         otherwise.
      */
-    [[nodiscard]] bool canMatchOrder(const Order &order) const;
+    [[nodiscard]] bool canMatchOrder(const BookOrder &order) const;
 
     /**
      * Matches two orders.
      *
-     * @param ask an ask order to execute.
-     * @param bid a bid order to execute.
+     * @param aggressor the incoming order to execute.
+     * @param passive the resting order to execute, require that passive is on the
+     *                opposite side of the book to aggressor.
      * @param executing_price price at which orders are executed, require that
      *                        ask price <= executing_price <= bid price.
      */
-    void executeOrders(Order &ask, Order &bid, uint64_t executing_price);
+    void executeOrders(BookOrder &aggressor, BookOrder &passive, uint64_t executing_price);
 
     /**
      * @returns the last traded price if any trades have been made and the max
@@ -337,33 +527,69 @@ private:
      */
     void validateTrailingStopOrders() const;
 
-    // IMPORTANT: Note that the declaration of orders MUST be
-    // declared before the declaration of the price level vectors.
-    // Class members are destroyed in the reverse order of their declaration,
-    // so the price level vectors will be destroyed before orders. This is
-    // required for the intrusive list.
-
+    // IMPORTANT: Note that the pools MUST be declared before the declaration
+    // of orders and the price level maps, and orders MUST be declared before
+    // the price level maps. Class members are destroyed in the reverse order
+    // of their declaration, so the price level maps will be destroyed before
+    // orders, and both are destroyed before the memory backing them is released.
+    // This is required for the intrusive list.
+
+    // Slab of order wrappers for resting orders.
+    ObjectPool<OrderWrapper> order_pool;
+    // Pooled memory for the nodes of the price level maps.
+    std::pmr::unsynchronized_pool_resource level_resource;
     // Maps order IDs to order wrappers.
-    robin_hood::unordered_map<uint64_t, OrderWrapper> orders;
+    OrderIndex<OrderWrapper> orders;
     // Maps prices to limit levels.
-    std::map<uint64_t, Level> ask_levels;
-    std::map<uint64_t, Level> bid_levels;
+    PriceLevels ask_levels;
+    PriceLevels bid_levels;
     // Maps prices to stop levels.
-    std::map<uint64_t, Level> stop_ask_levels;
-    std::map<uint64_t, Level> stop_bid_levels;
-    // Maps prices to trailing stop levels.
-    std::map<uint64_t, Level> trailing_stop_ask_levels;
-    std::map<uint64_t, Level> trailing_stop_bid_levels;
+    PriceLevels stop_ask_levels;
+    PriceLevels stop_bid_levels;
+    // Maps offsets from the reference prices to trailing stop levels.
+    PriceLevels trailing_stop_ask_levels;
+    PriceLevels trailing_stop_bid_levels;
+    // IDs of trailing stop orders that were inserted while the market price was away from the
+    // reference price, and so are keyed by an offset other than their trail amount.
+    std::vector<uint64_t> unanchored_trailing_ask_orders;
+    std::vector<uint64_t> unanchored_trailing_bid_orders;
     // Handles any trade events.
-    EventHandler &event_handler;
+    Handler *event_handler;
+    // True if fills are reported to the event handler as Trade events.
+    bool trade_events;
+    // True if each command is reported to the event handler as a single ExecutionReport.
+    bool execution_reports;
+    // Collects the orders and fills of the current command if execution_reports is set.
+    ExecutionReport report;
+    // The sequence number of the last trade, zero if no trades have occurred.
+    uint64_t trade_seq;
     // The current price of the symbol - based off the price that the
     // symbol was last traded at. Initially zero.
     uint64_t last_traded_price;
     // Tracks increases and decreases in market price.
     uint64_t trailing_bid_price;
     uint64_t trailing_ask_price;
+    // The market prices that trailing stop orders trail. The stop price of an ask trailing
+    // stop order is trailing_ask_reference minus its offset, and the stop price of a bid
+    // trailing stop order is trailing_bid_reference plus its offset.
+    uint64_t trailing_ask_reference;
+    uint64_t trailing_bid_reference;
+    // The last traded price that stop orders were last checked against, max 64-bit
+    // integer value if they have never been checked.
+    uint64_t stop_check_price;
+    // Work list of triggered stop orders that are waiting to be activated.
+    std::vector<BookOrder> triggered_orders;
     // The symbol ID associated with the book.
     uint32_t symbol_id;
 };
+
+// Orderbooks that dispatch events through the virtual event handler interface.
+using MapOrderBook = BasicMapOrderBook<EventHandler>;
+
+// Instantiated in map_orderbook.cpp. Include "matching/orderbook/map_orderbook_impl.h" to bind other handler types.
+extern template class BasicMapOrderBook<EventHandler>;
+extern template class BasicMapOrderBook<NullEventHandler>;
+extern template class BasicMapOrderBook<EventHandler, uint32_t, uint32_t>;
+extern template class BasicMapOrderBook<NullEventHandler, uint32_t, uint32_t>;
 } // namespace RapidTrader
 #endif // RAPID_TRADER_MAP_ORDERBOOK_H
\ No newline at end of file
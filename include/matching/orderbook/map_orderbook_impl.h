@@ -0,0 +1,828 @@
+// //match_engine/include/matching/orderbook/map_orderbook_impl.h
+#ifndef RAPID_TRADER_MAP_ORDERBOOK_IMPL_H
+#define RAPID_TRADER_MAP_ORDERBOOK_IMPL_H
+#include "matching/orderbook/map_orderbook.h"
+#include "event_handler/event.h"
+#include "utils/log.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+
+namespace RapidTrader {
+template<typename Handler, typename Price, typename Quantity>
+BasicMapOrderBook<Handler, Price, Quantity>::BasicMapOrderBook(uint32_t symbol_id_, Handler &event_handler_, size_t order_capacity, bool sequential_order_ids)
+    : order_pool(order_capacity)
+    , orders(sequential_order_ids)
+    , ask_levels(&level_resource)
+    , bid_levels(&level_resource)
+    , stop_ask_levels(&level_resource)
+    , stop_bid_levels(&level_resource)
+    , trailing_stop_ask_levels(&level_resource)
+    , trailing_stop_bid_levels(&level_resource)
+    , event_handler(&event_handler_)
+    , trade_events(event_handler_.handlesTrades())
+    , execution_reports(event_handler_.handlesExecutionReports())
+    , report(symbol_id_)
+    , trade_seq(0)
+    , last_traded_price(0)
+    , trailing_bid_price(0)
+    , trailing_ask_price(std::numeric_limits<uint64_t>::max())
+    , trailing_ask_reference(0)
+    , trailing_bid_reference(0)
+    , stop_check_price(std::numeric_limits<uint64_t>::max())
+    , symbol_id(symbol_id_)
+{
+    orders.reserve(order_capacity);
+}
+
+template<typename Handler, typename Price, typename Quantity>
+BasicMapOrderBook<Handler, Price, Quantity>::~BasicMapOrderBook()
+{
+    // Unlink the orders from their levels before the orders are destroyed.
+    ask_levels.clear();
+    bid_levels.clear();
+    stop_ask_levels.clear();
+    stop_bid_levels.clear();
+    trailing_stop_ask_levels.clear();
+    trailing_stop_bid_levels.clear();
+    orders.forEach([&](OrderWrapper *wrapper) { order_pool.destroy(wrapper); });
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::addOrder(Order order)
+{
+    if (!recordOrder(order))
+        event_handler->handleOrderAdded(OrderAdded{order});
+    if (!BookOrder::fits(order))
+    {
+        // The order cannot be narrowed to the types of the book, so it is deleted without being matched.
+        if (!recordOrder(order))
+            event_handler->handleOrderDeleted(OrderDeleted{order});
+        raiseExecutionReport();
+        return;
+    }
+    // Books with 64-bit prices and quantities match the order in place, other books match a narrowed copy.
+    std::conditional_t<std::is_same_v<BookOrder, Order>, Order &, BookOrder> book_order{order};
+    switch (book_order.getType())
+    {
+    case OrderType::Limit:
+        addLimitOrder(book_order);
+        break;
+    case OrderType::Market:
+        addMarketOrder(book_order);
+        break;
+    case OrderType::Stop:
+    case OrderType::StopLimit:
+    case OrderType::TrailingStop:
+    case OrderType::TrailingStopLimit:
+        addStopOrder(book_order);
+        break;
+    }
+    activateStopOrders();
+    raiseExecutionReport();
+    VALIDATE_ORDERBOOK;
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::executeOrder(uint64_t order_id, uint64_t quantity, uint64_t price)
+{
+    if (!priceFits<Price>(price))
+        return;
+    OrderWrapper *wrapper = orders.find(order_id);
+    BookLevel &executing_level = wrapper->level_it->second;
+    BookOrder &executing_order = wrapper->order;
+    uint64_t executing_quantity = std::min<uint64_t>(quantity, executing_order.getOpenQuantity());
+    executing_order.execute(price, executing_quantity);
+    last_traded_price = price;
+    if (!recordOrder(executing_order))
+        event_handler->handleOrderExecuted(ExecutedOrder{executing_order});
+    executing_level.reduceVolume(executing_order.getLastExecutedQuantity());
+    if (executing_order.isFilled())
+        deleteOrder(order_id, true);
+    activateStopOrders();
+    raiseExecutionReport();
+    VALIDATE_ORDERBOOK;
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::executeOrder(uint64_t order_id, uint64_t quantity)
+{
+    OrderWrapper *wrapper = orders.find(order_id);
+    BookLevel &executing_level = wrapper->level_it->second;
+    BookOrder &executing_order = wrapper->order;
+    uint64_t executing_quantity = std::min<uint64_t>(quantity, executing_order.getOpenQuantity());
+    uint64_t executing_price = executing_order.getPrice();
+    executing_order.execute(executing_price, executing_quantity);
+    last_traded_price = executing_price;
+    if (!recordOrder(executing_order))
+        event_handler->handleOrderExecuted(ExecutedOrder{executing_order});
+    executing_level.reduceVolume(executing_order.getLastExecutedQuantity());
+    if (executing_order.isFilled())
+        deleteOrder(order_id, true);
+    activateStopOrders();
+    raiseExecutionReport();
+    VALIDATE_ORDERBOOK;
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::cancelOrder(uint64_t order_id, uint64_t quantity)
+{
+    if (!quantityFits<Quantity>(quantity))
+    {
+        // The quantity exceeds the open quantity of every order in the book.
+        deleteOrder(order_id);
+        return;
+    }
+    OrderWrapper *wrapper = orders.find(order_id);
+    BookLevel &cancelling_level = wrapper->level_it->second;
+    BookOrder &cancelling_order = wrapper->order;
+    uint64_t pre_cancellation_quantity = cancelling_order.getOpenQuantity();
+    cancelling_order.setQuantity(quantity);
+    if (!recordOrder(cancelling_order))
+        event_handler->handleOrderUpdated(OrderUpdated{cancelling_order});
+    cancelling_level.reduceVolume(pre_cancellation_quantity - cancelling_order.getOpenQuantity());
+    if (cancelling_order.isFilled())
+        deleteOrder(order_id, true);
+    activateStopOrders();
+    raiseExecutionReport();
+    VALIDATE_ORDERBOOK;
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::deleteOrder(uint64_t order_id)
+{
+    deleteOrder(order_id, true);
+    activateStopOrders();
+    raiseExecutionReport();
+    VALIDATE_ORDERBOOK;
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::deleteOrder(uint64_t order_id, bool notification)
+{
+    OrderWrapper *wrapper = orders.find(order_id);
+    auto &levels_it = wrapper->level_it;
+    BookOrder &deleting_order = wrapper->order;
+    refreshTrailingStopPrice(*wrapper);
+    if (notification && !recordOrder(deleting_order))
+        event_handler->handleOrderDeleted(OrderDeleted{deleting_order});
+    levels_it->second.deleteOrder(deleting_order);
+    if (levels_it->second.empty())
+    {
+        switch (deleting_order.getType())
+        {
+        case OrderType::Limit:
+            deleting_order.isAsk() ? ask_levels.erase(levels_it) : bid_levels.erase(levels_it);
+            break;
+        case OrderType::Stop:
+        case OrderType::StopLimit:
+            deleting_order.isAsk() ? stop_ask_levels.erase(levels_it) : stop_bid_levels.erase(levels_it);
+            break;
+        case OrderType::TrailingStop:
+        case OrderType::TrailingStopLimit:
+            deleting_order.isAsk() ? trailing_stop_ask_levels.erase(levels_it) : trailing_stop_bid_levels.erase(levels_it);
+            break;
+        default:
+            assert(false && "Invalid order type!");
+        }
+    }
+    order_pool.destroy(wrapper);
+    orders.erase(order_id);
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::deleteFilledOrder(BookOrder &order)
+{
+    if (!execution_reports)
+    {
+        deleteOrder(order.getOrderID(), true);
+        return;
+    }
+    // Resting orders that are filled are described by their last fill, unless the command
+    // had already affected them.
+    report.updateOrder(order);
+    deleteOrder(order.getOrderID(), false);
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::replaceOrder(uint64_t order_id, uint64_t new_order_id, uint64_t new_price)
+{
+    if (!priceFits<Price>(new_price))
+        return;
+    OrderWrapper *wrapper = orders.find(order_id);
+    refreshTrailingStopPrice(*wrapper);
+    Order new_order = wrapper->order;
+    new_order.setOrderID(new_order_id);
+    new_order.setPrice(new_price);
+    deleteOrder(order_id, true);
+    // The execution report raised by addOrder includes the deletion of the replaced order.
+    addOrder(new_order);
+    activateStopOrders();
+    raiseExecutionReport();
+    VALIDATE_ORDERBOOK;
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::raiseExecutionReport()
+{
+    if (!execution_reports || report.empty())
+        return;
+    // Orders that are still in the book have changed since they were recorded if they were
+    // matched after they were added or activated.
+    for (OrderReport &order_report : report.orders)
+    {
+        OrderWrapper *wrapper = orders.find(order_report.order.getOrderID());
+        order_report.resting = wrapper != nullptr;
+        if (wrapper)
+        {
+            refreshTrailingStopPrice(*wrapper);
+            order_report.order = wrapper->order;
+        }
+    }
+    event_handler->handleExecutionReport(report);
+    report.clear();
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::addLimitOrder(BookOrder &order)
+{
+
+    match(order);
+    if (!order.isFilled() && !order.isIoc() && !order.isFok())
+        insertLimitOrder(order);
+    else if (!recordOrder(order))
+        event_handler->handleOrderDeleted(OrderDeleted{order});
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::insertLimitOrder(const BookOrder &order)
+{
+    if (order.isAsk())
+    {
+        auto level_it = ask_levels.emplace_hint(ask_levels.begin(), std::piecewise_construct, std::make_tuple(order.getPrice()),
+            std::make_tuple(order.getPrice(), LevelSide::Ask, symbol_id));
+        OrderWrapper *wrapper = order_pool.construct(OrderWrapper{level_it, order});
+        orders.insert(order.getOrderID(), wrapper);
+        level_it->second.addOrder(wrapper->order);
+    }
+    else
+    {
+        auto level_it = bid_levels.emplace_hint(bid_levels.end(), std::piecewise_construct, std::make_tuple(order.getPrice()),
+            std::make_tuple(order.getPrice(), LevelSide::Bid, symbol_id));
+        OrderWrapper *wrapper = order_pool.construct(OrderWrapper{level_it, order});
+        orders.insert(order.getOrderID(), wrapper);
+        level_it->second.addOrder(wrapper->order);
+    }
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::addMarketOrder(BookOrder &order)
+{
+    order.setPrice(order.isAsk() ? 0 : std::numeric_limits<uint64_t>::max());
+    match(order);
+    if (!recordOrder(order))
+        event_handler->handleOrderDeleted(OrderDeleted{order});
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::addStopOrder(BookOrder &order)
+{
+    if (order.isTrailingStop() || order.isTrailingStopLimit())
+        calculateStopPrice(order);
+    uint64_t market_price = order.isAsk() ? lastTradedPriceBid() : lastTradedPriceAsk();
+    uint64_t order_stop_price = order.getStopPrice();
+    uint8_t match = (order.isAsk() && market_price <= order_stop_price) + (order.isBid() && market_price >= order_stop_price);
+    if (match)
+    {
+        order.setType((order.isStop() || order.isTrailingStop()) ? OrderType::Market : OrderType::Limit);
+        order.setStopPrice(0);
+        order.setTrailAmount(0);
+        if (!recordOrder(order))
+            event_handler->handleOrderUpdated(OrderUpdated{order});
+        order.isMarket() ? addMarketOrder(order) : addLimitOrder(order);
+        return;
+    }
+    order.isTrailingStop() || order.isTrailingStopLimit() ? insertTrailingStopOrder(order) : insertStopOrder(order);
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::insertStopOrder(const BookOrder &order)
+{
+    if (order.isAsk())
+    {
+        auto level_it = stop_ask_levels
+                            .emplace(std::piecewise_construct, std::make_tuple(order.getStopPrice()),
+                                std::make_tuple(order.getStopPrice(), LevelSide::Ask, symbol_id))
+                            .first;
+        OrderWrapper *wrapper = order_pool.construct(OrderWrapper{level_it, order});
+        orders.insert(order.getOrderID(), wrapper);
+        level_it->second.addOrder(wrapper->order);
+    }
+    else
+    {
+        auto level_it = stop_bid_levels
+                            .emplace(std::piecewise_construct, std::make_tuple(order.getStopPrice()),
+                                std::make_tuple(order.getStopPrice(), LevelSide::Bid, symbol_id))
+                            .first;
+        OrderWrapper *wrapper = order_pool.construct(OrderWrapper{level_it, order});
+        orders.insert(order.getOrderID(), wrapper);
+        level_it->second.addOrder(wrapper->order);
+    }
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::insertTrailingStopOrder(const BookOrder &order)
+{
+    if (order.isAsk())
+    {
+        // An empty side has no reference price yet, so anchor it to the present market price.
+        if (trailing_stop_ask_levels.empty())
+            trailing_ask_reference = lastTradedPriceBid();
+        assert(order.getStopPrice() <= trailing_ask_reference && "Ask trailing stop price cannot exceed the reference price!");
+        uint64_t offset = trailing_ask_reference - order.getStopPrice();
+        auto level_it = trailing_stop_ask_levels
+                            .emplace(std::piecewise_construct, std::make_tuple(offset), std::make_tuple(offset, LevelSide::Ask, symbol_id))
+                            .first;
+        OrderWrapper *wrapper = order_pool.construct(OrderWrapper{level_it, order});
+        orders.insert(order.getOrderID(), wrapper);
+        level_it->second.addOrder(wrapper->order);
+        if (isUnanchored(*wrapper))
+            addUnanchoredTrailingStopOrder(unanchored_trailing_ask_orders, order.getOrderID());
+    }
+    else
+    {
+        if (trailing_stop_bid_levels.empty())
+            trailing_bid_reference = lastTradedPriceAsk();
+        assert(order.getStopPrice() >= trailing_bid_reference && "Bid trailing stop price cannot be below the reference price!");
+        uint64_t offset = order.getStopPrice() - trailing_bid_reference;
+        auto level_it = trailing_stop_bid_levels
+                            .emplace(std::piecewise_construct, std::make_tuple(offset), std::make_tuple(offset, LevelSide::Bid, symbol_id))
+                            .first;
+        OrderWrapper *wrapper = order_pool.construct(OrderWrapper{level_it, order});
+        orders.insert(order.getOrderID(), wrapper);
+        level_it->second.addOrder(wrapper->order);
+        if (isUnanchored(*wrapper))
+            addUnanchoredTrailingStopOrder(unanchored_trailing_bid_orders, order.getOrderID());
+    }
+}
+
+template<typename Handler, typename Price, typename Quantity>
+uint64_t BasicMapOrderBook<Handler, Price, Quantity>::calculateStopPrice(BookOrder &order)
+{
+    if (order.isAsk())
+    {
+        uint64_t market_price = lastTradedPriceBid();
+        uint64_t trail_amount = order.getTrailAmount();
+        // Set the new stop price to zero if the trail amount meets or exceeds the market price.
+        uint64_t new_stop_price = market_price > trail_amount ? market_price - trail_amount : 0;
+        order.setStopPrice(new_stop_price);
+        return new_stop_price;
+    }
+    else
+    {
+        uint64_t market_price = lastTradedPriceAsk();
+        uint64_t trail_amount = order.getTrailAmount();
+        // The stop price is unbounded if the sum of trail amount and the market price does not fit
+        // in the price type of the book.
+        uint64_t new_stop_price = addPriceOffset(market_price, trail_amount);
+        order.setStopPrice(new_stop_price);
+        return new_stop_price;
+    }
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::activateStopOrders()
+{
+    // Stop orders are only triggered by trades. Activating stop orders may result in trades
+    // which may trigger more stop orders, so continue until the last traded price settles.
+    while (last_traded_price != stop_check_price)
+    {
+        stop_check_price = last_traded_price;
+        activateBidStopOrders();
+        updateAskStopOrders();
+        activateAskStopOrders();
+        updateBidStopOrders();
+    }
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::activateBidStopOrders()
+{
+    uint64_t last_ask_price = lastTradedPriceAsk();
+    auto stop_levels_end = stop_bid_levels.upper_bound(last_ask_price);
+    for (auto stop_levels_it = stop_bid_levels.begin(); stop_levels_it != stop_levels_end; ++stop_levels_it)
+        addTriggeredOrders(stop_levels_it->second);
+    stop_bid_levels.erase(stop_bid_levels.begin(), stop_levels_end);
+    activateTriggeredOrders();
+    // Trailing stop levels with the smallest offsets have the lowest stop prices.
+    last_ask_price = lastTradedPriceAsk();
+    auto trailing_stop_levels_end = trailing_stop_bid_levels.begin();
+    while (trailing_stop_levels_end != trailing_stop_bid_levels.end() && trailingBidStopPrice(trailing_stop_levels_end->first) <= last_ask_price)
+        addTriggeredOrders((trailing_stop_levels_end++)->second);
+    trailing_stop_bid_levels.erase(trailing_stop_bid_levels.begin(), trailing_stop_levels_end);
+    activateTriggeredOrders();
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::activateAskStopOrders()
+{
+    uint64_t last_bid_price = lastTradedPriceBid();
+    // Activate the highest stop prices first.
+    auto stop_levels_begin = stop_ask_levels.lower_bound(last_bid_price);
+    for (auto stop_levels_it = stop_ask_levels.end(); stop_levels_it != stop_levels_begin;)
+        addTriggeredOrders((--stop_levels_it)->second);
+    stop_ask_levels.erase(stop_levels_begin, stop_ask_levels.end());
+    activateTriggeredOrders();
+    // Trailing stop levels with the smallest offsets have the highest stop prices.
+    last_bid_price = lastTradedPriceBid();
+    auto trailing_stop_levels_end = trailing_stop_ask_levels.begin();
+    while (trailing_stop_levels_end != trailing_stop_ask_levels.end() && trailingAskStopPrice(trailing_stop_levels_end->first) >= last_bid_price)
+        addTriggeredOrders((trailing_stop_levels_end++)->second);
+    trailing_stop_ask_levels.erase(trailing_stop_ask_levels.begin(), trailing_stop_levels_end);
+    activateTriggeredOrders();
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::addTriggeredOrders(const BookLevel &level)
+{
+    for (const BookOrder &order : level.getOrders())
+        triggered_orders.push_back(order);
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::activateTriggeredOrders()
+{
+    // The levels of the triggered orders have been erased, so the orders are no longer linked.
+    for (const BookOrder &order : triggered_orders)
+    {
+        order_pool.destroy(orders.find(order.getOrderID()));
+        orders.erase(order.getOrderID());
+    }
+    for (const BookOrder &order : triggered_orders)
+        activateStopOrder(order);
+    triggered_orders.clear();
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::activateStopOrder(BookOrder order)
+{
+    order.setStopPrice(0);
+    order.setTrailAmount(0);
+    // Convert the stop / trailing stop order to a limit or market order and match it.
+    if (order.isStop() || order.isTrailingStop())
+    {
+        order.setType(OrderType::Market);
+        if (!recordOrder(order))
+            event_handler->handleOrderUpdated(OrderUpdated{order});
+        addMarketOrder(order);
+    }
+    else
+    {
+        order.setType(OrderType::Limit);
+        if (!recordOrder(order))
+            event_handler->handleOrderUpdated(OrderUpdated{order});
+        addLimitOrder(order);
+    }
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::updateBidStopOrders()
+{
+    if (trailing_ask_price <= lastTradedPriceAsk() || trailing_stop_bid_levels.empty())
+    {
+        trailing_ask_price = last_traded_price;
+        return;
+    }
+    // Moving the reference price reprices every trailing stop order on the bid side.
+    trailing_bid_reference = lastTradedPriceAsk();
+    anchorTrailingStopOrders(unanchored_trailing_bid_orders, trailing_stop_bid_levels, LevelSide::Bid);
+    trailing_ask_price = last_traded_price;
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::updateAskStopOrders()
+{
+    if (trailing_bid_price >= lastTradedPriceBid() || trailing_stop_ask_levels.empty())
+    {
+        trailing_bid_price = last_traded_price;
+        return;
+    }
+    // Moving the reference price reprices every trailing stop order on the ask side.
+    trailing_ask_reference = lastTradedPriceBid();
+    anchorTrailingStopOrders(unanchored_trailing_ask_orders, trailing_stop_ask_levels, LevelSide::Ask);
+    trailing_bid_price = last_traded_price;
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::anchorTrailingStopOrders(std::vector<uint64_t> &unanchored_orders, PriceLevels &trailing_levels, LevelSide side)
+{
+    for (uint64_t order_id : unanchored_orders)
+    {
+        // The order may have been activated or deleted since it was recorded.
+        OrderWrapper *resting_order = orders.find(order_id);
+        if (!resting_order)
+            continue;
+        OrderWrapper &wrapper = *resting_order;
+        BookOrder &stop_order = wrapper.order;
+        if (!(stop_order.isTrailingStop() || stop_order.isTrailingStopLimit()) || stop_order.isAsk() != (side == LevelSide::Ask) ||
+            !isUnanchored(wrapper))
+            continue;
+        uint64_t trail_amount = stop_order.getTrailAmount();
+        wrapper.level_it->second.deleteOrder(stop_order);
+        if (wrapper.level_it->second.empty())
+            trailing_levels.erase(wrapper.level_it);
+        wrapper.level_it = trailing_levels
+                               .emplace(std::piecewise_construct, std::make_tuple(trail_amount), std::make_tuple(trail_amount, side, symbol_id))
+                               .first;
+        wrapper.level_it->second.addOrder(stop_order);
+    }
+    unanchored_orders.clear();
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::addUnanchoredTrailingStopOrder(std::vector<uint64_t> &unanchored_orders, uint64_t order_id)
+{
+    if (unanchored_orders.size() == unanchored_orders.capacity())
+    {
+        auto is_stale = [this](uint64_t id) {
+            OrderWrapper *wrapper = orders.find(id);
+            if (!wrapper)
+                return true;
+            const BookOrder &stop_order = wrapper->order;
+            return !(stop_order.isTrailingStop() || stop_order.isTrailingStopLimit()) || !isUnanchored(*wrapper);
+        };
+        unanchored_orders.erase(std::remove_if(unanchored_orders.begin(), unanchored_orders.end(), is_stale), unanchored_orders.end());
+    }
+    unanchored_orders.push_back(order_id);
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::match(BookOrder &order)
+{
+    // Order is a FOK order that cannot be filled.
+    if (order.isFok() && !canMatchOrder(order))
+        return;
+    if (order.isAsk())
+    {
+        auto bid_levels_it = bid_levels.rbegin();
+        BookOrder &ask_order = order;
+        while (bid_levels_it != bid_levels.rend() && bid_levels_it->first >= ask_order.getPrice() && !ask_order.isFilled())
+        {
+            BookLevel &bid_level = bid_levels_it->second;
+            BookOrder &bid_order = bid_level.front();
+            uint64_t executing_price = bid_order.getPrice();
+            executeOrders(ask_order, bid_order, executing_price);
+            bid_level.reduceVolume(bid_order.getLastExecutedQuantity());
+            if (bid_order.isFilled())
+                deleteFilledOrder(bid_order);
+            // Reset the level iterator - iterator may be invalidated if the order is deleted.
+            bid_levels_it = bid_levels.rbegin();
+        }
+    }
+    if (order.isBid())
+    {
+        auto ask_levels_it = ask_levels.begin();
+        BookOrder &bid_order = order;
+        while (ask_levels_it != ask_levels.end() && ask_levels_it->first <= bid_order.getPrice() && !bid_order.isFilled())
+        {
+            BookLevel &ask_level = ask_levels_it->second;
+            BookOrder &ask_order = ask_level.front();
+            uint64_t executing_price = ask_order.getPrice();
+            executeOrders(bid_order, ask_order, executing_price);
+            ask_level.reduceVolume(ask_order.getLastExecutedQuantity());
+            if (ask_order.isFilled())
+                deleteFilledOrder(ask_order);
+            // Reset the level iterator - iterator may be invalidated if the order is deleted.
+            ask_levels_it = ask_levels.begin();
+        }
+    }
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::executeOrders(BookOrder &aggressor, BookOrder &passive, uint64_t executing_price)
+{
+    // Calculate the minimum quantity to match.
+    uint64_t matched_quantity = std::min(aggressor.getOpenQuantity(), passive.getOpenQuantity());
+    aggressor.execute(executing_price, matched_quantity);
+    passive.execute(executing_price, matched_quantity);
+    if (execution_reports)
+    {
+        report.fills.emplace_back(symbol_id, ++trade_seq, aggressor, passive);
+    }
+    else if (trade_events)
+    {
+        event_handler->handleTrade(Trade{symbol_id, ++trade_seq, aggressor, passive});
+    }
+    else
+    {
+        BookOrder &bid = aggressor.isBid() ? aggressor : passive;
+        BookOrder &ask = aggressor.isBid() ? passive : aggressor;
+        event_handler->handleOrderExecuted(ExecutedOrder{bid});
+        event_handler->handleOrderExecuted(ExecutedOrder{ask});
+    }
+    last_traded_price = executing_price;
+}
+
+template<typename Handler, typename Price, typename Quantity>
+bool BasicMapOrderBook<Handler, Price, Quantity>::canMatchOrder(const BookOrder &order) const
+{
+    uint64_t price = order.getPrice();
+    uint64_t quantity_required = order.getOpenQuantity();
+    uint64_t quantity_available = 0;
+    if (order.isAsk())
+    {
+        auto bid_levels_it = bid_levels.rbegin();
+        while (bid_levels_it != bid_levels.rend() && bid_levels_it->first >= price)
+        {
+            uint64_t level_volume = bid_levels_it->second.getVolume();
+            uint64_t quantity_needed = quantity_required - quantity_available;
+            quantity_available += std::min(level_volume, quantity_needed);
+            if (quantity_available >= quantity_required)
+                return true;
+            ++bid_levels_it;
+        }
+    }
+    else
+    {
+        auto ask_levels_it = ask_levels.begin();
+        while (ask_levels_it != ask_levels.end() && ask_levels_it->first <= price)
+        {
+            uint64_t level_volume = ask_levels_it->second.getVolume();
+            uint64_t quantity_needed = quantity_required - quantity_available;
+            quantity_available += std::min(level_volume, quantity_needed);
+            if (quantity_available >= quantity_required)
+                return true;
+            ++ask_levels_it;
+        }
+    }
+    return false;
+}
+
+template<typename Handler, typename Price, typename Quantity>
+uint64_t BasicMapOrderBook<Handler, Price, Quantity>::volumeAtOrBetter(OrderSide side, uint64_t price) const
+{
+    uint64_t volume = 0;
+    if (side == OrderSide::Bid)
+    {
+        for (auto bid_levels_it = bid_levels.rbegin(); bid_levels_it != bid_levels.rend() && bid_levels_it->first >= price; ++bid_levels_it)
+            volume += bid_levels_it->second.getVolume();
+    }
+    else
+    {
+        for (auto ask_levels_it = ask_levels.begin(); ask_levels_it != ask_levels.end() && ask_levels_it->first <= price; ++ask_levels_it)
+            volume += ask_levels_it->second.getVolume();
+    }
+    return volume;
+}
+
+// LCOV_EXCL_START
+template<typename Handler, typename Price, typename Quantity>
+std::string BasicMapOrderBook<Handler, Price, Quantity>::toString() const
+{
+    std::string book_string;
+    book_string += "SYMBOL ID : " + std::to_string(symbol_id) + "\n";
+    book_string += "LAST TRADED PRICE: " + std::to_string(last_traded_price) + "\n";
+    book_string += "BID ORDERS\n";
+    for (const auto &[price, level] : bid_levels)
+        book_string += level.toString();
+    book_string += "ASK ORDERS\n";
+    for (const auto &[price, level] : ask_levels)
+        book_string += level.toString();
+    book_string += "BID STOP ORDERS\n";
+    for (const auto &[price, level] : stop_bid_levels)
+        book_string += level.toString();
+    book_string += "ASK STOP ORDERS\n";
+    for (const auto &[price, level] : stop_ask_levels)
+        book_string += level.toString();
+    book_string += "BID TRAILING STOP ORDERS\n";
+    for (const auto &[price, level] : trailing_stop_bid_levels)
+        book_string += level.toString();
+    book_string += "ASK TRAILING STOP ORDERS\n";
+    for (const auto &[price, level] : trailing_stop_ask_levels)
+        book_string += level.toString();
+    return book_string;
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::dumpBook(const std::string &path) const
+{
+    std::ofstream file(path);
+    file << toString();
+    file.close();
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::validateOrderBook() const
+{
+    validateLimitOrders();
+    validateStopOrders();
+    validateTrailingStopOrders();
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::validateLimitOrders() const
+{
+    uint64_t current_best_ask = ask_levels.empty() ? std::numeric_limits<uint64_t>::max() : ask_levels.begin()->first;
+    uint64_t current_best_bid = bid_levels.empty() ? 0 : bid_levels.rbegin()->first;
+    assert(current_best_ask > current_best_bid && "Best bid price should never be lower than best ask price!");
+
+    for (const auto &[price, level] : ask_levels)
+    {
+        assert(!level.empty() && "Empty limit levels should never be in the orderbook!");
+        assert(level.getPrice() == price && "Limit level price should have same value as map key!");
+        assert(level.getSide() == LevelSide::Ask && "Limit level with bid side cannot be on the ask side of the book!");
+        const auto &level_orders = level.getOrders();
+        for (const auto &order : level_orders)
+        {
+            assert(!order.isFilled() && "Limit level should not contain any filled orders!");
+            assert(order.getType() == OrderType::Limit && "Limit level contains order that is not a limit order!");
+        }
+    }
+
+    for (const auto &[price, level] : bid_levels)
+    {
+        assert(!level.empty() && "Empty limit levels should never be in the orderbook!");
+        assert(level.getPrice() == price && "Limit level price should have same value as map key!");
+        assert(level.getSide() == LevelSide::Bid && "Limit level with ask side cannot be on the bid side of the book!");
+        const auto &level_orders = level.getOrders();
+        for (const auto &order : level_orders)
+        {
+            assert(!order.isFilled() && "Limit level should not contain any filled orders!");
+            assert(order.getType() == OrderType::Limit && "Limit level contains order that is not a limit order!");
+        }
+    }
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::validateStopOrders() const
+{
+    for (const auto &[price, level] : stop_ask_levels)
+    {
+        assert(!level.empty() && "Empty stop levels should never be in the orderbook!");
+        assert(price < last_traded_price && "Stop level has ask price that meets or exceeds last traded price!");
+        assert(level.getPrice() == price && "Stop Level price should have same value as map key!");
+        assert(level.getSide() == LevelSide::Ask && "Stop Level on the ask side cannot be on the bid side of the book!");
+        const auto &level_orders = level.getOrders();
+        for (const auto &order : level_orders)
+        {
+            assert(!order.isFilled() && "Stop level should not contain any filled orders!");
+            assert(order.getType() == OrderType::Stop ||
+                   order.getType() == OrderType::StopLimit && "Stop level contains order that is not a stop order!");
+        }
+    }
+
+    for (const auto &[price, level] : stop_bid_levels)
+    {
+        assert(!level.empty() && "Empty stop levels should never be in the orderbook!");
+        assert(price > last_traded_price && "Stop level has bid price that meets or is below last traded price!");
+        assert(level.getPrice() == price && "Level price should have same value as map key!");
+        assert(level.getSide() == LevelSide::Bid && "Stop Level on the bid side cannot be on the ask side of the book!");
+        const auto &level_orders = level.getOrders();
+        for (const auto &order : level_orders)
+        {
+            assert(!order.isFilled() && "Stop level should not contain any filled orders!");
+            assert(order.getType() == OrderType::Stop ||
+                   order.getType() == OrderType::StopLimit && "Stop level contains order that is not a stop order!");
+        }
+    }
+}
+
+template<typename Handler, typename Price, typename Quantity>
+void BasicMapOrderBook<Handler, Price, Quantity>::validateTrailingStopOrders() const
+{
+    for (const auto &[price, level] : trailing_stop_ask_levels)
+    {
+        assert(!level.empty() && "Empty trailing stop levels should never be in the orderbook!");
+        assert(trailingAskStopPrice(price) < last_traded_price && "Trailing Stop level has ask price that meets or exceeds last traded price!");
+        assert(level.getPrice() == price && "Trailing stop Level price should have same value as map key!");
+        assert(level.getSide() == LevelSide::Ask && "Trailing stop Level on the ask side cannot be on the bid side of the book!");
+        const auto &level_orders = level.getOrders();
+        for (const auto &order : level_orders)
+        {
+            assert(!order.isFilled() && "Trailing stop level should not contain any filled orders!");
+            assert(order.getType() == OrderType::TrailingStop ||
+                   order.getType() == OrderType::TrailingStopLimit &&
+                       "Trailing stop level contains an order that is not a trailing stop order!");
+        }
+    }
+
+    for (const auto &[price, level] : trailing_stop_bid_levels)
+    {
+        assert(!level.empty() && "Empty trailing stop levels should never be in the orderbook!");
+        assert(trailingBidStopPrice(price) > last_traded_price && "Trailing stop level has bid price that meets or is below last traded price!");
+        assert(level.getPrice() == price && "Level price should have same value as map key!");
+        assert(level.getSide() == LevelSide::Bid && "Trailing stop Level on the bid side cannot be on the ask side of the book!");
+        const auto &level_orders = level.getOrders();
+        for (const auto &order : level_orders)
+        {
+            assert(!order.isFilled() && "Trailing stop level should not contain any filled orders!");
+            assert(order.getType() == OrderType::TrailingStop ||
+                   order.getType() == OrderType::TrailingStopLimit &&
+                       "Trailing stop level contains an order that is not a trailing stop order!");
+        }
+    }
+}
+} // namespace RapidTrader
+  // LCOV_EXCL_END
+#endif // RAPID_TRADER_MAP_ORDERBOOK_IMPL_H
@@ -1,8 +1,13 @@
 #ifndef RAPID_TRADER_ORDER_H
 #define RAPID_TRADER_ORDER_H
+#include <algorithm>
 #include <boost/intrusive/list.hpp>
+#include <cassert>
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <ostream>
+#include <type_traits>
 
 namespace RapidTrader {
 // Only validate order in debug mode.
@@ -13,8 +18,13 @@ namespace RapidTrader {
 #endif
 
 using namespace boost::intrusive;
-class MapOrderBook;
-class Level;
+template<typename Handler, typename Price, typename Quantity>
+class BasicMapOrderBook;
+template<typename Handler>
+class BasicArrayOrderBook;
+template<typename Price, typename Quantity>
+class BasicLevel;
+struct Command;
 
 /**
  * Supported order types.
@@ -50,7 +60,7 @@ class Level;
  * Instead, the stop price is defined as a specific dollar amount (the trail
  * amount) below or above the market price of the security (the trailing stop price).
  */
-enum class OrderType
+enum class OrderType : uint8_t
 {
     Limit = 0,
     Market = 1,
@@ -73,7 +83,7 @@ enum class OrderType
  * be executed immediately. Any portion of the IOC order that cannot
  * be filled will be cancelled.
  */
-enum class OrderTimeInForce
+enum class OrderTimeInForce : uint8_t
 {
     GTC = 0,
     FOK = 1,
@@ -86,15 +96,97 @@ enum class OrderTimeInForce
  * Bid: An order on the bid side is an order to buy a security.
  * Ask: An order on the ask side is an order to sell a security.
  */
-enum class OrderSide
+enum class OrderSide : uint8_t
 {
     Bid = 0,
     Ask = 1
 };
 
-struct Order : public list_base_hook<>
+/**
+ * Links an order into the level it rests in. Books always unlink an order before
+ * destroying it, so the hook does not pay for the checks of a safe-mode hook.
+ */
+using OrderHook = list_base_hook<link_mode<normal_link>>;
+
+/**
+ * @tparam To the type the price would be converted to.
+ * @param price the price.
+ * @return true if the price is unbounded or less than the largest value of To, so that it
+ *         can be converted to To, and false otherwise.
+ */
+template<typename To, typename From>
+constexpr bool priceFits(From price)
+{
+    return price == std::numeric_limits<From>::max() || price < std::numeric_limits<To>::max();
+}
+
+/**
+ * @tparam To the type the quantity would be converted to.
+ * @param quantity the quantity.
+ * @return true if the quantity fits in To and false otherwise.
+ */
+template<typename To, typename From>
+constexpr bool quantityFits(From quantity)
+{
+    return quantity <= std::numeric_limits<To>::max();
+}
+
+/**
+ * Converts a price to another width. The largest value of a width means that the price
+ * is unbounded, as it does for the price of a market bid order, so it converts to the largest
+ * value of the other width.
+ *
+ * @tparam To the type to convert the price to.
+ * @param price the price to convert, require that priceFits<To>(price) is true. Prices from
+ *              outside the engine must be checked before they are converted, since release
+ *              builds would truncate them.
+ * @return the converted price.
+ */
+template<typename To, typename From>
+constexpr To convertPrice(From price)
+{
+    assert(priceFits<To>(price) && "Price does not fit in the price type of the order!");
+    if (price == std::numeric_limits<From>::max())
+        return std::numeric_limits<To>::max();
+    return static_cast<To>(price);
+}
+
+/**
+ * Converts a quantity to another width.
+ *
+ * @tparam To the type to convert the quantity to.
+ * @param quantity the quantity to convert, require that quantityFits<To>(quantity) is true.
+ * @return the converted quantity.
+ */
+template<typename To, typename From>
+constexpr To convertQuantity(From quantity)
+{
+    assert(quantityFits<To>(quantity) && "Quantity does not fit in the quantity type of the order!");
+    return static_cast<To>(quantity);
+}
+
+/**
+ * An order. The fields that matching reads and writes for every resting order in a level
+ * (the level links, ID, open quantity, and price) are packed together at the front of the
+ * order, followed by the fields that are only read when an order is added, triggered, or
+ * reported.
+ *
+ * Prices and quantities are stored as Price and Quantity. Orders that cross the public
+ * interfaces of the engine use 64-bit prices and quantities (see Order), and books for
+ * symbols whose normalized prices and quantities fit in 32 bits may store their resting
+ * orders with 32-bit fields, which halves the size of the hot and cold fields. Orders convert
+ * implicitly to wider orders and explicitly to narrower ones. Instantiated for 64-bit and
+ * 32-bit prices and quantities in order.cpp.
+ *
+ * @tparam Price the unsigned integer type of prices, stop prices, and trail amounts.
+ * @tparam Quantity the unsigned integer type of quantities.
+ */
+template<typename Price, typename Quantity>
+struct BasicOrder : public OrderHook
 {
 public:
+    static_assert(std::is_unsigned_v<Price> && std::is_unsigned_v<Quantity>, "Prices and quantities must be unsigned integers!");
+
     /**
      * Creates a market order on the ask side.
      *
@@ -105,7 +197,7 @@ public:
      *                      FOK or IOC.
      * @return a new market order.
      */
-    static Order marketAskOrder(uint64_t order_id, uint32_t symbol_id, uint64_t quantity, OrderTimeInForce time_in_force);
+    static BasicOrder marketAskOrder(uint64_t order_id, uint32_t symbol_id, uint64_t quantity, OrderTimeInForce time_in_force);
 
     /**
      * Creates a market order on the bid side.
@@ -117,7 +209,7 @@ public:
      *                      FOK or IOC.
      * @return a new market order.
      */
-    static Order marketBidOrder(uint64_t order_id, uint32_t symbol_id, uint64_t quantity, OrderTimeInForce time_in_force);
+    static BasicOrder marketBidOrder(uint64_t order_id, uint32_t symbol_id, uint64_t quantity, OrderTimeInForce time_in_force);
 
     /**
      * Creates a new limit order on the ask side.
@@ -129,7 +221,7 @@ public:
      * @param time_in_force the time in force of the order.
      * @return a new limit order.
      */
-    static Order limitAskOrder(uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t quantity, OrderTimeInForce time_in_force);
+    static BasicOrder limitAskOrder(uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t quantity, OrderTimeInForce time_in_force);
 
     /**
      * Creates a new limit order on the bid side.
@@ -141,7 +233,7 @@ public:
      * @param time_in_force the time in force of the order.
      * @return a new limit order.
      */
-    static Order limitBidOrder(uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t quantity, OrderTimeInForce time_in_force);
+    static BasicOrder limitBidOrder(uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t quantity, OrderTimeInForce time_in_force);
 
     /**
      * Creates a new stop market order on the ask side.
@@ -154,7 +246,7 @@ public:
      *                      FOK or IOC.
      * @return a new stop market order.
      */
-    static Order stopAskOrder(
+    static BasicOrder stopAskOrder(
         uint64_t order_id, uint32_t symbol_id, uint64_t stop_price, uint64_t quantity, OrderTimeInForce time_in_force);
 
     /**
@@ -168,7 +260,7 @@ public:
      *                      FOK or IOC.
      * @return a new stop market order.
      */
-    static Order stopBidOrder(
+    static BasicOrder stopBidOrder(
         uint64_t order_id, uint32_t symbol_id, uint64_t stop_price, uint64_t quantity, OrderTimeInForce time_in_force);
 
     /**
@@ -182,7 +274,7 @@ public:
      * @param time_in_force the time in force of the order.
      * @return a new stop limit order.
      */
-    static Order stopLimitAskOrder(
+    static BasicOrder stopLimitAskOrder(
         uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t stop_price, uint64_t quantity, OrderTimeInForce time_in_force);
 
     /**
@@ -196,7 +288,7 @@ public:
      * @param time_in_force the time in force of the order.
      * @return a new stop limit order.
      */
-    static Order stopLimitBidOrder(
+    static BasicOrder stopLimitBidOrder(
         uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t stop_price, uint64_t quantity, OrderTimeInForce time_in_force);
 
     /**
@@ -209,7 +301,7 @@ public:
      * @param time_in_force the time in force of the order, require that time in force is IOC or FOK.
      * @return a new trailing stop order.
      */
-    static Order trailingStopAskOrder(
+    static BasicOrder trailingStopAskOrder(
         uint64_t order_id, uint32_t symbol_id, uint64_t trail_amount, uint64_t quantity, OrderTimeInForce time_in_force);
 
     /**
@@ -222,7 +314,7 @@ public:
      * @param time_in_force the time in force of the order, require that time in force is IOC or FOK.
      * @return a new trailing stop order.
      */
-    static Order trailingStopBidOrder(
+    static BasicOrder trailingStopBidOrder(
         uint64_t order_id, uint32_t symbol_id, uint64_t trail_amount, uint64_t quantity, OrderTimeInForce time_in_force);
 
     /**
@@ -236,7 +328,7 @@ public:
      * @param time_in_force the time in force of the order, require that time in force is IOC or FOK.
      * @return a new trailing stop limit order.
      */
-    static Order trailingStopLimitAskOrder(
+    static BasicOrder trailingStopLimitAskOrder(
         uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t trail_amount, uint64_t quantity, OrderTimeInForce time_in_force);
 
     /**
@@ -250,13 +342,13 @@ public:
      * @param time_in_force the time in force of the order, require that time in force is IOC or FOK.
      * @return a new trailing stop limit order.
      */
-    static Order trailingStopLimitBidOrder(
+    static BasicOrder trailingStopLimitBidOrder(
         uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t trail_amount, uint64_t quantity, OrderTimeInForce time_in_force);
 
     /**
      * @return the quantity of the order.
      */
-    [[nodiscard]] uint64_t getQuantity() const
+    [[nodiscard]] Quantity getQuantity() const
     {
         return quantity;
     }
@@ -264,7 +356,7 @@ public:
     /**
      * @return the quantity of the order that has been executed.
      */
-    [[nodiscard]] uint64_t getExecutedQuantity() const
+    [[nodiscard]] Quantity getExecutedQuantity() const
     {
         return executed_quantity;
     }
@@ -272,7 +364,7 @@ public:
     /**
      * @return the quantity of the order that remains to be executed.
      */
-    [[nodiscard]] uint64_t getOpenQuantity() const
+    [[nodiscard]] Quantity getOpenQuantity() const
     {
         return open_quantity;
     }
@@ -281,7 +373,7 @@ public:
      * @return the last executed quantity of the order if the order
      *         has been executed, otherwise zero.
      */
-    [[nodiscard]] uint64_t getLastExecutedQuantity() const
+    [[nodiscard]] Quantity getLastExecutedQuantity() const
     {
         return last_executed_quantity;
     }
@@ -297,7 +389,7 @@ public:
     /**
      * @return the price associated with the order.
      */
-    [[nodiscard]] uint64_t getPrice() const
+    [[nodiscard]] Price getPrice() const
     {
         return price;
     }
@@ -306,7 +398,7 @@ public:
      * @return the stop price associated with the order
      *         if applicable, otherwise zero.
      */
-    [[nodiscard]] uint64_t getStopPrice() const
+    [[nodiscard]] Price getStopPrice() const
     {
         return stop_price;
     }
@@ -315,7 +407,7 @@ public:
      * @return the trail amount associated with the order
      *         if applicable, otherwise zero.
      */
-    [[nodiscard]] uint64_t getTrailAmount() const
+    [[nodiscard]] Price getTrailAmount() const
     {
         return trail_amount;
     }
@@ -349,7 +441,7 @@ public:
      * @return the price at which the order was last executed if the order
      *         has been executed, otherwise zero.
      */
-    [[nodiscard]] uint64_t getLastExecutedPrice() const
+    [[nodiscard]] Price getLastExecutedPrice() const
     {
         return last_executed_price;
     }
@@ -466,7 +558,7 @@ public:
      * @param other another order.
      * @return true if the orders are equal and false otherwise.
      */
-    bool operator==(const Order &other) const
+    bool operator==(const BasicOrder &other) const
     {
         return id == other.id;
     }
@@ -477,23 +569,72 @@ public:
      * @param other another order.
      * @return true if the orders are equal and false otherwise.
      */
-    bool operator!=(const Order &other) const
+    bool operator!=(const BasicOrder &other) const
     {
         return !(*this == other);
     }
 
+    /**
+     * Converts an order to a wider order.
+     *
+     * @param other the order to convert.
+     */
+    template<typename OtherPrice, typename OtherQuantity,
+        std::enable_if_t<(sizeof(OtherPrice) <= sizeof(Price) && sizeof(OtherQuantity) <= sizeof(Quantity)), int> = 0>
+    BasicOrder(const BasicOrder<OtherPrice, OtherQuantity> &other)
+        : BasicOrder(other, ConvertTag{})
+    {}
+
+    /**
+     * Converts an order to a narrower order.
+     *
+     * @param other the order to convert, require that fits(other) is true.
+     */
+    template<typename OtherPrice, typename OtherQuantity,
+        std::enable_if_t<!(sizeof(OtherPrice) <= sizeof(Price) && sizeof(OtherQuantity) <= sizeof(Quantity)), int> = 0>
+    explicit BasicOrder(const BasicOrder<OtherPrice, OtherQuantity> &other)
+        : BasicOrder(other, ConvertTag{})
+    {}
+
+    /**
+     * @param other an order with any price and quantity types.
+     * @return true if every price and quantity of the order fits in the types of this order,
+     *         so that it can be converted without losing any of its values, and false otherwise.
+     */
+    template<typename OtherPrice, typename OtherQuantity>
+    [[nodiscard]] static bool fits(const BasicOrder<OtherPrice, OtherQuantity> &other)
+    {
+        return quantityFits<Quantity>(other.quantity) && quantityFits<Quantity>(other.open_quantity) &&
+               quantityFits<Quantity>(other.executed_quantity) && quantityFits<Quantity>(other.last_executed_quantity) &&
+               priceFits<Price>(other.price) && priceFits<Price>(other.last_executed_price) && priceFits<Price>(other.stop_price) &&
+               priceFits<Price>(other.trail_amount);
+    }
+
     /**
      * @return the string representation of the order.
      */
     [[nodiscard]] std::string toString() const;
 
-    friend std::ostream &operator<<(std::ostream &os, const Order &order);
-    friend class MapOrderBook;
-    friend class Level;
+    friend std::ostream &operator<<(std::ostream &os, const BasicOrder &order)
+    {
+        os << order.toString();
+        return os;
+    }
+
+    template<typename Handler, typename OtherPrice, typename OtherQuantity>
+    friend class BasicMapOrderBook;
+    template<typename Handler>
+    friend class BasicArrayOrderBook;
+    template<typename OtherPrice, typename OtherQuantity>
+    friend class BasicLevel;
+    template<typename OtherPrice, typename OtherQuantity>
+    friend struct BasicOrder;
+    friend struct Command;
+    friend struct EventRecord;
 
 private:
     /**
-     * A constructor for the Order.
+     * A constructor for the BasicOrder.
      *
      * @param type_ the type of the order - Limit, Market, Stop, Stop Limit, Trailing Stop, or Trailing Stop Limit.
      * @param side_ the side the order is on - ask or bid.
@@ -506,21 +647,47 @@ private:
      * @param quantity_ the quantity of the order.
      * @param id_ the ID associated with the order.
      */
-    Order(OrderType type_, OrderSide side_, OrderTimeInForce time_in_force_, uint32_t symbol_id_, uint64_t price_, uint64_t stop_price_,
+    BasicOrder(OrderType type_, OrderSide side_, OrderTimeInForce time_in_force_, uint32_t symbol_id_, uint64_t price_, uint64_t stop_price_,
         uint64_t trail_amount_, uint64_t quantity_, uint64_t id_);
 
+    struct ConvertTag
+    {};
+
+    /**
+     * A constructor that converts an order to the price and quantity types of this order.
+     *
+     * @param other the order to convert, require that fits(other) is true.
+     */
+    template<typename OtherPrice, typename OtherQuantity>
+    BasicOrder(const BasicOrder<OtherPrice, OtherQuantity> &other, ConvertTag)
+        : id(other.id)
+        , open_quantity(convertQuantity<Quantity>(other.open_quantity))
+        , price(convertPrice<Price>(other.price))
+        , side(other.side)
+        , type(other.type)
+        , time_in_force(other.time_in_force)
+        , symbol_id(other.symbol_id)
+        , quantity(convertQuantity<Quantity>(other.quantity))
+        , executed_quantity(convertQuantity<Quantity>(other.executed_quantity))
+        , last_executed_price(convertPrice<Price>(other.last_executed_price))
+        , last_executed_quantity(convertQuantity<Quantity>(other.last_executed_quantity))
+        , stop_price(convertPrice<Price>(other.stop_price))
+        , trail_amount(convertPrice<Price>(other.trail_amount))
+    {}
+
     /**
      * Executes the order.
      *
      * @param price_ the price at which to execute the order, require that price is positive.
      * @param quantity_ the quantity of the order to execute, require that quantity is positive.
      */
-    void execute(uint32_t price_, uint64_t quantity_)
+    void execute(uint64_t price_, uint64_t quantity_)
     {
-        open_quantity -= quantity_;
-        executed_quantity += quantity_;
-        last_executed_price = price_;
-        last_executed_quantity = quantity_;
+        auto executed = convertQuantity<Quantity>(quantity_);
+        open_quantity -= executed;
+        executed_quantity += executed;
+        last_executed_price = convertPrice<Price>(price_);
+        last_executed_quantity = executed;
         VALIDATE_ORDER;
     }
 
@@ -532,7 +699,7 @@ private:
      */
     void setPrice(uint64_t price_)
     {
-        price = price_;
+        price = convertPrice<Price>(price_);
         VALIDATE_ORDER;
     }
 
@@ -544,7 +711,7 @@ private:
      */
     void setStopPrice(uint64_t stop_price_)
     {
-        stop_price = stop_price_;
+        stop_price = convertPrice<Price>(stop_price_);
         VALIDATE_ORDER;
     }
 
@@ -556,7 +723,7 @@ private:
      */
     void setTrailAmount(uint64_t trail_amount_)
     {
-        trail_amount = trail_amount_;
+        trail_amount = convertPrice<Price>(trail_amount_);
         VALIDATE_ORDER;
     }
 
@@ -567,8 +734,9 @@ private:
      */
     void setQuantity(uint64_t quantity_)
     {
-        quantity = std::min(quantity_, open_quantity);
-        open_quantity -= quantity_;
+        auto new_quantity = convertQuantity<Quantity>(quantity_);
+        quantity = std::min(new_quantity, open_quantity);
+        open_quantity -= new_quantity;
         VALIDATE_ORDER;
     }
 
@@ -609,19 +777,27 @@ private:
      */
     void validateOrder() const;
 
-    OrderType type;
+    // Hot fields.
+    uint64_t id;
+    Quantity open_quantity;
+    Price price;
     OrderSide side;
+    OrderType type;
     OrderTimeInForce time_in_force;
     uint32_t symbol_id;
-    uint64_t price;
-    uint64_t stop_price;
-    uint64_t trail_amount;
-    uint64_t last_executed_price;
-    uint64_t id;
-    uint64_t quantity;
-    uint64_t executed_quantity;
-    uint64_t open_quantity;
-    uint64_t last_executed_quantity;
+    // Cold fields.
+    Quantity quantity;
+    Quantity executed_quantity;
+    Price last_executed_price;
+    Quantity last_executed_quantity;
+    Price stop_price;
+    Price trail_amount;
 };
+
+// Orders that cross the public interfaces of the engine.
+using Order = BasicOrder<uint64_t, uint64_t>;
+
+extern template struct BasicOrder<uint64_t, uint64_t>;
+extern template struct BasicOrder<uint32_t, uint32_t>;
 } // namespace RapidTrader
 #endif // RAPID_TRADER_ORDER_H
@@ -0,0 +1,503 @@
+// //match_engine/include/matching/orderbook/order_index.h
+#ifndef RAPID_TRADER_ORDER_INDEX_H
+#define RAPID_TRADER_ORDER_INDEX_H
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+#include "utils/robin_hood.h"
+
+namespace RapidTrader {
+/**
+ * A hash table from order IDs to orders that never rehashes all of its entries at once.
+ *
+ * Entries are stored with linear probing. When the table fills up, a new table is
+ * allocated and the entries of the old table are moved to it a few slots at a time on
+ * each subsequent insert and erase, so the cost of growing is spread over the operations
+ * that follow it. Erased entries in the old table are marked rather than removed, so that
+ * the migration never misses an entry. Tables are allocated zeroed, which lets the operating
+ * system supply large tables lazily instead of clearing them up front.
+ *
+ * @tparam T type of the objects the table points to.
+ */
+template<typename T>
+class OrderHashTable
+{
+public:
+    OrderHashTable() = default;
+    OrderHashTable(const OrderHashTable &) = delete;
+    OrderHashTable &operator=(const OrderHashTable &) = delete;
+
+    ~OrderHashTable()
+    {
+        std::free(current.slots);
+        std::free(previous.slots);
+    }
+
+    /**
+     * Allocates space for orders up front. Does nothing if the table is not empty.
+     *
+     * @param capacity the number of orders to allocate space for.
+     */
+    void reserve(size_t capacity)
+    {
+        if (num_objects > 0 || current.used > 0 || previous.slots)
+            return;
+        std::free(current.slots);
+        // The table grows once half of its slots are used.
+        current = Table(tableCapacity(2 * capacity + 2));
+    }
+
+    /**
+     * @param order_id the ID of the order to find.
+     * @return the order if it is in the table and null otherwise.
+     */
+    [[nodiscard]] T *find(uint64_t order_id) const
+    {
+        if (Slot *slot = current.find(order_id))
+            return slot->value;
+        if (Slot *slot = previous.find(order_id))
+            return slot->value;
+        return nullptr;
+    }
+
+    /**
+     * Adds an order to the table.
+     *
+     * @param order_id the ID of the order, require that the order is not in the table.
+     * @param object the order, require that object is not null.
+     */
+    void insert(uint64_t order_id, T *object)
+    {
+        assert(!find(order_id) && "Order already exists!");
+        assert(object && "Order must not be null!");
+        migrate();
+        if (2 * (current.used + 1) > current.capacity)
+            grow();
+        current.insert(order_id, object);
+        ++num_objects;
+    }
+
+    /**
+     * Removes an order from the table.
+     *
+     * @param order_id the ID of the order, require that the order is in the table.
+     */
+    void erase(uint64_t order_id)
+    {
+        assert(find(order_id) && "Order does not exist!");
+        Slot *slot = current.find(order_id);
+        if (!slot)
+            slot = previous.find(order_id);
+        slot->value = erasedMarker();
+        --num_objects;
+        migrate();
+    }
+
+    /**
+     * Calls a function on every order in the table.
+     *
+     * @param f the function, called with a pointer to the order.
+     */
+    template<typename F>
+    void forEach(F &&f) const
+    {
+        current.forEach(f);
+        previous.forEach(f);
+    }
+
+    /**
+     * @return true if there are no orders in the table and false otherwise.
+     */
+    [[nodiscard]] bool empty() const
+    {
+        return num_objects == 0;
+    }
+
+    /**
+     * @return the number of orders in the table.
+     */
+    [[nodiscard]] size_t size() const
+    {
+        return num_objects;
+    }
+
+private:
+    // The smallest number of slots a table has.
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    struct Slot
+    {
+        uint64_t key;
+        // Null if the slot has never been used, the erased marker if its entry was erased.
+        T *value;
+    };
+
+    static T *erasedMarker()
+    {
+        return reinterpret_cast<T *>(alignof(T));
+    }
+
+    static bool isLive(const Slot &slot)
+    {
+        return slot.value && slot.value != erasedMarker();
+    }
+
+    /**
+     * @param min_slots the smallest number of slots the table should have.
+     * @return the smallest power of two that is at least min_slots and MIN_CAPACITY.
+     */
+    static size_t tableCapacity(size_t min_slots)
+    {
+        size_t capacity = MIN_CAPACITY;
+        while (capacity < min_slots)
+            capacity <<= 1;
+        return capacity;
+    }
+
+    struct Table
+    {
+        Table() = default;
+
+        explicit Table(size_t capacity_)
+            : slots(static_cast<Slot *>(std::calloc(capacity_, sizeof(Slot))))
+            , capacity(capacity_)
+        {
+            if (!slots)
+                throw std::bad_alloc();
+        }
+
+        Slot *find(uint64_t key) const
+        {
+            if (!slots)
+                return nullptr;
+            for (size_t i = robin_hood::hash<uint64_t>{}(key) & (capacity - 1);; i = (i + 1) & (capacity - 1))
+            {
+                Slot &slot = slots[i];
+                if (!slot.value)
+                    return nullptr;
+                if (slot.key == key && slot.value != erasedMarker())
+                    return &slot;
+            }
+        }
+
+        void insert(uint64_t key, T *value)
+        {
+            size_t i = robin_hood::hash<uint64_t>{}(key) & (capacity - 1);
+            while (isLive(slots[i]))
+                i = (i + 1) & (capacity - 1);
+            if (!slots[i].value)
+                ++used;
+            slots[i] = Slot{key, value};
+        }
+
+        template<typename F>
+        void forEach(F &f) const
+        {
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                if (isLive(slots[i]))
+                    f(slots[i].value);
+            }
+        }
+
+        Slot *slots = nullptr;
+        size_t capacity = 0;
+        // The number of slots that have been used, including slots whose entries were erased.
+        size_t used = 0;
+    };
+
+    /**
+     * Starts moving the entries to a new table sized for the live entries.
+     */
+    void grow()
+    {
+        // The migration is paced to finish before the new table fills up, so this is
+        // only a safeguard.
+        while (previous.slots)
+            migrate();
+        // Erased entries are not moved, so a table that filled up with erased entries is
+        // replaced by one of at least half its size rather than a larger one.
+        size_t capacity = std::max(tableCapacity(4 * num_objects), current.capacity / 2);
+        previous = current;
+        current = Table(capacity);
+        migration_index = 0;
+        // The new table holds at most a quarter of its slots once the migration is complete, so
+        // at least a quarter of its slots are left for inserts before it must grow again. Moving
+        // this many slots per operation finishes the migration before then.
+        slots_per_migration = std::max<size_t>(1, 4 * previous.capacity / current.capacity);
+    }
+
+    /**
+     * Moves a few slots of the previous table to the current table, and frees the previous
+     * table once all of its slots have been moved.
+     */
+    void migrate()
+    {
+        if (!previous.slots)
+            return;
+        size_t end = std::min(migration_index + slots_per_migration, previous.capacity);
+        for (; migration_index < end; ++migration_index)
+        {
+            Slot &slot = previous.slots[migration_index];
+            if (isLive(slot))
+            {
+                current.insert(slot.key, slot.value);
+                // Moved entries are marked as erased, so that they are only found in the current table.
+                slot.value = erasedMarker();
+            }
+        }
+        if (migration_index == previous.capacity)
+        {
+            std::free(previous.slots);
+            previous = Table();
+        }
+    }
+
+    Table current;
+    // The table whose entries are being moved to the current table, empty if there is none.
+    Table previous;
+    // The next slot of the previous table to move.
+    size_t migration_index = 0;
+    size_t slots_per_migration = 1;
+    size_t num_objects = 0;
+};
+
+/**
+ * Maps order IDs to the resting orders of a book.
+ *
+ * When order IDs are sequential, orders are stored in pages of slots that are indexed
+ * directly by order ID. The pages cover a sliding window of IDs: the window grows as new
+ * IDs arrive and shrinks as the oldest pages drain, and drained pages are recycled, so
+ * lookups, inserts, and erases never hash or rehash. IDs that fall outside the window,
+ * and every ID when order IDs are not sequential, are stored in an OrderHashTable.
+ *
+ * @tparam T type of the objects the index points to.
+ */
+template<typename T>
+class OrderIndex
+{
+public:
+    // The number of order IDs covered by a page.
+    static constexpr uint64_t PAGE_SIZE = 4096;
+    // The largest number of pages the window covers. IDs further than this from the oldest
+    // resting order in the window are stored in the hash table.
+    static constexpr uint64_t MAX_WINDOW_PAGES = 1024;
+
+    /**
+     * A constructor for the OrderIndex.
+     *
+     * @param sequential_ids_ true if order IDs are nearly monotonic, in which case orders are
+     *                        indexed directly by ID, and false if IDs are arbitrary.
+     */
+    explicit OrderIndex(bool sequential_ids_ = false)
+        : sequential_ids(sequential_ids_)
+    {
+        if (sequential_ids)
+            window.resize(MAX_WINDOW_PAGES);
+    }
+
+    /**
+     * Allocates space for orders up front.
+     *
+     * @param capacity the number of orders to allocate space for.
+     */
+    void reserve(size_t capacity)
+    {
+        if (!sequential_ids)
+        {
+            fallback.reserve(capacity);
+            return;
+        }
+        size_t num_pages = (capacity + PAGE_SIZE - 1) / PAGE_SIZE;
+        while (free_pages.size() < num_pages && free_pages.size() < MAX_WINDOW_PAGES)
+            free_pages.push_back(std::make_unique<Page>());
+    }
+
+    /**
+     * @param order_id the ID of the order to find.
+     * @return the order if it is in the index and null otherwise.
+     */
+    [[nodiscard]] T *find(uint64_t order_id) const
+    {
+        uint64_t page_number = order_id / PAGE_SIZE;
+        // Drained pages inside the window are released, so a page in the window may be null.
+        const Page *page = page_number - first_page < last_page - first_page ? window[page_number % MAX_WINDOW_PAGES].get() : nullptr;
+        if (page)
+        {
+            T *object = page->slots[order_id % PAGE_SIZE];
+            if (object || fallback.empty())
+                return object;
+        }
+        return fallback.find(order_id);
+    }
+
+    /**
+     * Adds an order to the index.
+     *
+     * @param order_id the ID of the order, require that the order is not in the index.
+     * @param object the order, require that object is not null.
+     */
+    void insert(uint64_t order_id, T *object)
+    {
+        assert(!find(order_id) && "Order already exists!");
+        assert(object && "Order must not be null!");
+        ++num_objects;
+        uint64_t page_number = order_id / PAGE_SIZE;
+        if (!sequential_ids || !coverPage(page_number))
+        {
+            fallback.insert(order_id, object);
+            return;
+        }
+        std::unique_ptr<Page> &page = window[page_number % MAX_WINDOW_PAGES];
+        if (!page)
+            page = allocatePage();
+        page->slots[order_id % PAGE_SIZE] = object;
+        ++page->num_objects;
+    }
+
+    /**
+     * Removes an order from the index.
+     *
+     * @param order_id the ID of the order, require that the order is in the index.
+     */
+    void erase(uint64_t order_id)
+    {
+        assert(find(order_id) && "Order does not exist!");
+        --num_objects;
+        uint64_t page_number = order_id / PAGE_SIZE;
+        if (page_number - first_page < last_page - first_page && window[page_number % MAX_WINDOW_PAGES])
+        {
+            std::unique_ptr<Page> &page = window[page_number % MAX_WINDOW_PAGES];
+            T *&slot = page->slots[order_id % PAGE_SIZE];
+            if (slot)
+            {
+                slot = nullptr;
+                if (--page->num_objects == 0)
+                    releasePage(page_number);
+                return;
+            }
+        }
+        fallback.erase(order_id);
+    }
+
+    /**
+     * Calls a function on every order in the index.
+     *
+     * @param f the function, called with a pointer to the order.
+     */
+    template<typename F>
+    void forEach(F &&f) const
+    {
+        for (uint64_t page_number = first_page; page_number < last_page; ++page_number)
+        {
+            const std::unique_ptr<Page> &page = window[page_number % MAX_WINDOW_PAGES];
+            if (!page)
+                continue;
+            for (T *object : page->slots)
+            {
+                if (object)
+                    f(object);
+            }
+        }
+        fallback.forEach(f);
+    }
+
+    /**
+     * @return true if there are no orders in the index and false otherwise.
+     */
+    [[nodiscard]] bool empty() const
+    {
+        return num_objects == 0;
+    }
+
+    /**
+     * @return the number of orders in the index.
+     */
+    [[nodiscard]] size_t size() const
+    {
+        return num_objects;
+    }
+
+private:
+    struct Page
+    {
+        T *slots[PAGE_SIZE] = {};
+        // The number of slots that point to an order.
+        uint64_t num_objects = 0;
+    };
+
+    /**
+     * Grows the window to cover a page if that keeps the window within MAX_WINDOW_PAGES.
+     *
+     * @param page_number the number of the page.
+     * @return true if the window covers the page and false otherwise.
+     */
+    bool coverPage(uint64_t page_number)
+    {
+        if (first_page == last_page)
+        {
+            first_page = page_number;
+            last_page = page_number + 1;
+            return true;
+        }
+        if (page_number < first_page)
+        {
+            if (last_page - page_number > MAX_WINDOW_PAGES)
+                return false;
+            first_page = page_number;
+        }
+        else if (page_number >= last_page)
+        {
+            if (page_number + 1 - first_page > MAX_WINDOW_PAGES)
+                return false;
+            last_page = page_number + 1;
+        }
+        return true;
+    }
+
+    /**
+     * Recycles an empty page, and shrinks the window past any pages at either end of it
+     * that hold no orders.
+     *
+     * @param page_number the number of the empty page.
+     */
+    void releasePage(uint64_t page_number)
+    {
+        free_pages.push_back(std::move(window[page_number % MAX_WINDOW_PAGES]));
+        while (first_page < last_page && !window[first_page % MAX_WINDOW_PAGES])
+            ++first_page;
+        while (last_page > first_page && !window[(last_page - 1) % MAX_WINDOW_PAGES])
+            --last_page;
+    }
+
+    /**
+     * @return an empty page, recycled if possible.
+     */
+    std::unique_ptr<Page> allocatePage()
+    {
+        if (free_pages.empty())
+            return std::make_unique<Page>();
+        std::unique_ptr<Page> page = std::move(free_pages.back());
+        free_pages.pop_back();
+        return page;
+    }
+
+    // True if orders are indexed directly by ID.
+    const bool sequential_ids;
+    // The pages that cover the IDs between first_page * PAGE_SIZE and last_page * PAGE_SIZE,
+    // page n is stored at n % MAX_WINDOW_PAGES. Slots outside the window are always empty.
+    std::vector<std::unique_ptr<Page>> window;
+    uint64_t first_page = 0;
+    uint64_t last_page = 0;
+    // Empty pages that are waiting to be reused.
+    std::vector<std::unique_ptr<Page>> free_pages;
+    // Orders whose IDs are not covered by the window.
+    OrderHashTable<T> fallback;
+    size_t num_objects = 0;
+};
+} // namespace RapidTrader
+#endif // RAPID_TRADER_ORDER_INDEX_H
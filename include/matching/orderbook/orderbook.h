@@ -4,6 +4,46 @@
 #include "matching/orderbook/order.h" // Corrected path
 
 namespace RapidTrader {
+class EventHandler;
+
+/**
+ * Supported orderbook implementations.
+ *
+ * Map: price levels are stored in ordered maps. Supports any price.
+ *
+ * Array: limit price levels are stored in a contiguous array indexed by
+ * tick. Requires that limit prices fall inside a bounded price band.
+ */
+enum class OrderBookType
+{
+    Map = 0,
+    Array = 1
+};
+
+/**
+ * Describes the orderbook that should be created for a symbol.
+ */
+struct OrderBookConfig
+{
+    // The orderbook implementation to use.
+    OrderBookType type = OrderBookType::Map;
+    // The lowest limit price that can rest in the book. Only used by array orderbooks.
+    uint64_t min_price = 1;
+    // The highest limit price that can rest in the book. Only used by array orderbooks.
+    uint64_t max_price = 1;
+    // The minimum price increment. Only used by array orderbooks.
+    uint64_t tick_size = 1;
+    // The number of resting orders the book allocates space for up front.
+    size_t order_capacity = 0;
+    // True if order IDs are nearly monotonic, in which case the book indexes resting
+    // orders directly by ID instead of hashing them.
+    bool sequential_order_ids = false;
+    // True if every price of the symbol is less than 2^32 - 1 and every quantity fits in
+    // 32 bits, in which case the book stores resting orders with 32-bit prices and quantities.
+    // Only used by map orderbooks.
+    bool compact_orders = false;
+};
+
 class OrderBook
 {
 public:
@@ -72,9 +112,9 @@ public:
      *
      * @param order_id the ID of the order being requested, require that an order with
      *                 the provided ID exists in the book.
-     * @return the order with provided ID.
+     * @return a copy of the order with provided ID.
      */
-    [[nodiscard]] virtual const Order &getOrder(uint64_t order_id) const = 0;
+    [[nodiscard]] virtual Order getOrder(uint64_t order_id) const = 0;
 
     /**
      * @return true if there are no orders in the book and false otherwise.
@@ -101,6 +141,24 @@ public:
      */
     [[nodiscard]] virtual uint64_t lastTradedPrice() const = 0;
 
+    /**
+     * @param side the side of the book to query.
+     * @param price the price to query.
+     * @return the total open quantity of the limit orders on the provided side of the
+     *         book that are priced at price or better, that is at or above price for
+     *         bids and at or below price for asks.
+     */
+    [[nodiscard]] virtual uint64_t volumeAtOrBetter(OrderSide side, uint64_t price) const = 0;
+
+    /**
+     * Binds the book to another event handler, so that the book can be moved to another
+     * orderbook handler.
+     *
+     * @param event_handler_ the event handler that will handle updates from the book, require
+     *                       that it has the type of event handler that the book is bound to.
+     */
+    virtual void setEventHandler(EventHandler &event_handler_) = 0;
+
     /**
      * Writes the string representation of the the orderbook to
      * a file at the provided path. Creates a new file.
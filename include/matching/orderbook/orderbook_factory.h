@@ -0,0 +1,42 @@
+// //match_engine/include/matching/orderbook/orderbook_factory.h
+#ifndef RAPID_TRADER_ORDERBOOK_FACTORY_H
+#define RAPID_TRADER_ORDERBOOK_FACTORY_H
+#include <memory>
+#include "matching/orderbook/orderbook.h"
+#include "matching/orderbook/map_orderbook_impl.h"
+#include "matching/orderbook/array_orderbook_impl.h"
+#include "event_handler/event_handler.h"
+
+namespace RapidTrader {
+/**
+ * Creates an orderbook of the type described by the config, bound at compile time
+ * to the event handler type Handler.
+ *
+ * @tparam Handler the type of the event handler, require that event_handler is a Handler.
+ * @param symbol_id the symbol ID that will be associated with the book.
+ * @param event_handler handles updates from the book.
+ * @param config describes the orderbook to create.
+ * @return a new orderbook.
+ */
+template<typename Handler>
+std::unique_ptr<OrderBook> makeOrderBook(uint32_t symbol_id, EventHandler &event_handler, const OrderBookConfig &config)
+{
+    Handler &handler = static_cast<Handler &>(event_handler);
+    switch (config.type)
+    {
+    case OrderBookType::Array:
+        return std::make_unique<BasicArrayOrderBook<Handler>>(
+            symbol_id, handler, config.min_price, config.max_price, config.tick_size, config.order_capacity,
+            config.sequential_order_ids);
+    case OrderBookType::Map:
+    default:
+        if (config.compact_orders)
+        {
+            return std::make_unique<BasicMapOrderBook<Handler, uint32_t, uint32_t>>(
+                symbol_id, handler, config.order_capacity, config.sequential_order_ids);
+        }
+        return std::make_unique<BasicMapOrderBook<Handler>>(symbol_id, handler, config.order_capacity, config.sequential_order_ids);
+    }
+}
+} // namespace RapidTrader
+#endif // RAPID_TRADER_ORDERBOOK_FACTORY_H
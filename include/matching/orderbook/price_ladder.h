@@ -0,0 +1,219 @@
+// //match_engine/include/matching/orderbook/price_ladder.h
+#ifndef RAPID_TRADER_PRICE_LADDER_H
+#define RAPID_TRADER_PRICE_LADDER_H
+#include <vector>
+#include "matching/orderbook/depth_index.h"
+#include "matching/orderbook/level.h"
+#include "matching/orderbook/level_bitmap.h"
+
+namespace RapidTrader {
+/**
+ * One side of a tick-indexed price ladder.
+ *
+ * Levels are stored in fixed-size pages that are only allocated the first time
+ * a price inside the page is used, so a wide price band that is sparsely
+ * populated only pays for the pages it touches. Pages are never moved or freed
+ * while the ladder exists, so references to levels remain valid. An occupancy
+ * bitmap, paged the same way, tracks which levels hold orders, and a two tier
+ * depth index tracks the volume of the pages and of the levels inside each page.
+ */
+class PriceLadder
+{
+public:
+    // Returned by the find functions if there is no occupied level.
+    static constexpr size_t NOT_FOUND = LevelBitmap::NOT_FOUND;
+
+    /**
+     * A constructor for the price ladder.
+     *
+     * @param num_levels_ the number of levels in the ladder, require that num_levels_ is positive.
+     * @param min_price_ the price of the level at index zero.
+     * @param tick_size_ the price difference between adjacent levels.
+     * @param side_ the side of the book the ladder is on.
+     * @param symbol_id_ the symbol ID associated with the levels.
+     */
+    PriceLadder(size_t num_levels_, uint64_t min_price_, uint64_t tick_size_, LevelSide side_, uint32_t symbol_id_)
+        : pages((num_levels_ + PAGE_SIZE - 1) / PAGE_SIZE)
+        , page_depth(pages.size())
+        , occupancy(num_levels_)
+        , num_levels(num_levels_)
+        , min_price(min_price_)
+        , tick_size(tick_size_)
+        , side(side_)
+        , symbol_id(symbol_id_)
+        , total_volume(0)
+    {}
+
+    /**
+     * @param index the index of a level, require that the level is occupied.
+     * @return the level at the index.
+     */
+    Level &operator[](size_t index)
+    {
+        assert(occupancy.test(index) && "Level is not occupied!");
+        return pages[index / PAGE_SIZE].levels[index % PAGE_SIZE];
+    }
+
+    /**
+     * @param index the index of a level, require that the level is occupied.
+     * @return the level at the index.
+     */
+    const Level &operator[](size_t index) const
+    {
+        assert(occupancy.test(index) && "Level is not occupied!");
+        return pages[index / PAGE_SIZE].levels[index % PAGE_SIZE];
+    }
+
+    /**
+     * Marks a level as occupied, allocating the page that holds it if necessary.
+     *
+     * @param index the index of the level, require that index < size().
+     * @return the level at the index.
+     */
+    Level &occupy(size_t index)
+    {
+        Page &page = pages[index / PAGE_SIZE];
+        if (page.levels.empty())
+        {
+            size_t first_index = index / PAGE_SIZE * PAGE_SIZE;
+            size_t page_size = std::min(PAGE_SIZE, num_levels - first_index);
+            page.levels.reserve(page_size);
+            for (size_t i = first_index; i < first_index + page_size; ++i)
+                page.levels.emplace_back(min_price + i * tick_size, side, symbol_id);
+            page.depth = DepthIndex{page_size};
+        }
+        occupancy.set(index);
+        return page.levels[index % PAGE_SIZE];
+    }
+
+    /**
+     * Marks a level as empty.
+     *
+     * @param index the index of the level, require that the level holds no orders.
+     */
+    void release(size_t index)
+    {
+        assert(pages[index / PAGE_SIZE].levels[index % PAGE_SIZE].empty() && "Cannot release a level that holds orders!");
+        occupancy.clear(index);
+    }
+
+    /**
+     * Records volume added to a level.
+     *
+     * @param index the index of the level, require that the level is occupied.
+     * @param amount the volume added to the level.
+     */
+    void addVolume(size_t index, uint64_t amount)
+    {
+        assert(occupancy.test(index) && "Level is not occupied!");
+        pages[index / PAGE_SIZE].depth.add(index % PAGE_SIZE, amount);
+        page_depth.add(index / PAGE_SIZE, amount);
+        total_volume += amount;
+    }
+
+    /**
+     * Records volume removed from a level.
+     *
+     * @param index the index of the level, require that the level is occupied.
+     * @param amount the volume removed from the level.
+     */
+    void removeVolume(size_t index, uint64_t amount)
+    {
+        assert(occupancy.test(index) && "Level is not occupied!");
+        pages[index / PAGE_SIZE].depth.remove(index % PAGE_SIZE, amount);
+        page_depth.remove(index / PAGE_SIZE, amount);
+        total_volume -= amount;
+    }
+
+    /**
+     * @param index the index of the last level to include, require that index < size().
+     * @return the total volume of the levels at indices zero through index.
+     */
+    [[nodiscard]] uint64_t volumeUpTo(size_t index) const
+    {
+        size_t page_index = index / PAGE_SIZE;
+        uint64_t volume = page_index > 0 ? page_depth.prefixVolume(page_index - 1) : 0;
+        const Page &page = pages[page_index];
+        if (!page.levels.empty())
+            volume += page.depth.prefixVolume(index % PAGE_SIZE);
+        return volume;
+    }
+
+    /**
+     * @return the total volume of all levels in the ladder.
+     */
+    [[nodiscard]] uint64_t totalVolume() const
+    {
+        return total_volume;
+    }
+
+    /**
+     * @param index the index of a level, require that index < size().
+     * @return true if the level holds orders and false otherwise.
+     */
+    [[nodiscard]] bool isOccupied(size_t index) const
+    {
+        return occupancy.test(index);
+    }
+
+    /**
+     * @param index the index to start searching from.
+     * @return the lowest occupied index >= index, or NOT_FOUND if there is none.
+     */
+    [[nodiscard]] size_t findNext(size_t index) const
+    {
+        return occupancy.findNext(index);
+    }
+
+    /**
+     * @param index the index to start searching from, require that index < size().
+     * @return the highest occupied index <= index, or NOT_FOUND if there is none.
+     */
+    [[nodiscard]] size_t findPrev(size_t index) const
+    {
+        return occupancy.findPrev(index);
+    }
+
+    /**
+     * @return the number of levels in the ladder.
+     */
+    [[nodiscard]] size_t size() const
+    {
+        return num_levels;
+    }
+
+    /**
+     * Destroys all levels. Orders in the levels are unlinked.
+     */
+    void clear()
+    {
+        pages.clear();
+    }
+
+private:
+    // The number of levels per page, which matches the pages of the occupancy bitmap.
+    static constexpr size_t PAGE_SIZE = LevelBitmap::PAGE_SIZE;
+
+    struct Page
+    {
+        // The levels of the page, empty if the page has not been used yet.
+        std::vector<Level> levels;
+        // The volumes of the levels of the page, sized when the page is first used.
+        DepthIndex depth;
+    };
+
+    std::vector<Page> pages;
+    // The volumes of the pages.
+    DepthIndex page_depth;
+    // Tracks which levels hold orders.
+    LevelBitmap occupancy;
+    size_t num_levels;
+    uint64_t min_price;
+    uint64_t tick_size;
+    LevelSide side;
+    uint32_t symbol_id;
+    // The total volume of all levels in the ladder.
+    uint64_t total_volume;
+};
+} // namespace RapidTrader
+#endif // RAPID_TRADER_PRICE_LADDER_H
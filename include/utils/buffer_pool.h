@@ -0,0 +1,91 @@
+#ifndef RAPID_TRADER_BUFFER_POOL_H
+#define RAPID_TRADER_BUFFER_POOL_H
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include "concurrent/ring_queue.h"
+
+namespace RapidTrader {
+/**
+ * A fixed number of fixed-size byte buffers carved out of a single arena. Buffers may be
+ * acquired by one thread at a time and released by any thread, so that a buffer can be
+ * filled by one thread and handed back by whichever thread learns that it is no longer
+ * in use, such as the thread that receives delivery reports for a message.
+ */
+class BufferPool
+{
+public:
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    /**
+     * A constructor for the buffer pool.
+     *
+     * @param buffer_size_ the size of each buffer in bytes, require that buffer_size_ is positive.
+     * @param num_buffers_ the number of buffers, require that num_buffers_ is positive.
+     */
+    BufferPool(size_t buffer_size_, size_t num_buffers_)
+        : buffer_size(buffer_size_)
+        , num_buffers(num_buffers_)
+        , arena(std::make_unique<char[]>(buffer_size_ * num_buffers_))
+        , free_buffers(num_buffers_)
+    {
+        assert(buffer_size > 0 && num_buffers > 0 && "Buffer pools require at least one non-empty buffer!");
+        for (size_t i = 0; i < num_buffers; ++i)
+        {
+            char *buffer = arena.get() + i * buffer_size;
+            free_buffers.tryPush(buffer);
+        }
+    }
+
+    /**
+     * Acquires a free buffer if there is one. Must only be called by one thread at a time.
+     *
+     * @return the buffer, or nullptr if every buffer is in use.
+     */
+    char *tryAcquire()
+    {
+        char *buffer = nullptr;
+        free_buffers.tryPop(buffer);
+        return buffer;
+    }
+
+    /**
+     * Returns a buffer to the pool. May be called from any thread.
+     *
+     * @param buffer the buffer, require that it was acquired from this pool and has not been
+     *               released since.
+     */
+    void release(char *buffer)
+    {
+        assert(owns(buffer) && "Buffer does not belong to the pool!");
+        [[maybe_unused]] bool released = free_buffers.tryPush(buffer);
+        assert(released && "More buffers were released than acquired!");
+    }
+
+    /**
+     * @param buffer a pointer.
+     * @return true if the pointer is a buffer of this pool and false otherwise.
+     */
+    [[nodiscard]] bool owns(const char *buffer) const
+    {
+        return buffer >= arena.get() && buffer < arena.get() + buffer_size * num_buffers;
+    }
+
+    /**
+     * @return the size of each buffer in bytes.
+     */
+    [[nodiscard]] size_t bufferSize() const
+    {
+        return buffer_size;
+    }
+
+private:
+    const size_t buffer_size;
+    const size_t num_buffers;
+    std::unique_ptr<char[]> arena;
+    // Holds every buffer that is not in use, so it never fills up.
+    Concurrent::MPSCQueue<char *> free_buffers;
+};
+} // namespace RapidTrader
+#endif // RAPID_TRADER_BUFFER_POOL_H
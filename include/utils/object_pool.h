@@ -0,0 +1,139 @@
+#ifndef RAPID_TRADER_OBJECT_POOL_H
+#define RAPID_TRADER_OBJECT_POOL_H
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace RapidTrader {
+/**
+ * A single-threaded pool of fixed-size slots for objects of type T. Slots are
+ * carved out of large chunks and recycled through an intrusive free list, so
+ * once the pool has grown to the working set of the owner, constructing and
+ * destroying objects never touches the heap.
+ *
+ * The pool does not track live objects. Every object constructed by the pool
+ * must be destroyed through the pool before the pool itself is destroyed.
+ *
+ * @tparam T type of the objects that will be stored in the pool.
+ */
+template<typename T>
+class ObjectPool
+{
+public:
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    /**
+     * A constructor for the object pool.
+     *
+     * @param initial_capacity the number of slots to allocate up front.
+     * @param chunk_size_ the number of slots allocated each time the pool runs out
+     *                    of free slots, require that chunk_size_ is positive.
+     */
+    explicit ObjectPool(size_t initial_capacity = 0, size_t chunk_size_ = 4096)
+        : free_list(nullptr)
+        , chunk_size(chunk_size_)
+        , num_slots(0)
+        , num_live(0)
+    {
+        assert(chunk_size > 0 && "Chunk size must be positive!");
+        if (initial_capacity > 0)
+            grow(initial_capacity);
+    }
+
+    /**
+     * Constructs a new object in a free slot, allocating a new chunk if there are none.
+     *
+     * @param args the arguments to construct the object with.
+     * @return a pointer to the new object.
+     */
+    template<typename... Args>
+    T *construct(Args &&...args)
+    {
+        if (!free_list)
+            grow(chunk_size);
+        Slot *slot = free_list;
+        free_list = slot->next;
+        ++num_live;
+        return new (slot->storage) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * Destroys an object and returns its slot to the free list.
+     *
+     * @param object the object to destroy, require that object was constructed by this pool.
+     */
+    void destroy(T *object)
+    {
+        assert(num_live > 0 && "Cannot destroy an object in an empty pool!");
+        object->~T();
+        Slot *slot = reinterpret_cast<Slot *>(object);
+        slot->next = free_list;
+        free_list = slot;
+        --num_live;
+    }
+
+    /**
+     * @return the number of objects that are presently constructed in the pool.
+     */
+    [[nodiscard]] size_t size() const
+    {
+        return num_live;
+    }
+
+    /**
+     * @return the total number of slots owned by the pool.
+     */
+    [[nodiscard]] size_t capacity() const
+    {
+        return num_slots;
+    }
+
+    /**
+     * @return the number of times the pool has allocated a chunk from the heap.
+     */
+    [[nodiscard]] size_t chunkAllocations() const
+    {
+        return chunks.size();
+    }
+
+private:
+    union Slot
+    {
+        Slot *next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    /**
+     * Allocates a new chunk and pushes its slots onto the free list.
+     *
+     * @param num_new_slots the number of slots in the new chunk.
+     */
+    void grow(size_t num_new_slots)
+    {
+        chunks.push_back(std::make_unique<Slot[]>(num_new_slots));
+        Slot *chunk = chunks.back().get();
+        // Push the slots in reverse so that objects are handed out in address order.
+        for (size_t i = num_new_slots; i-- > 0;)
+        {
+            chunk[i].next = free_list;
+            free_list = &chunk[i];
+        }
+        num_slots += num_new_slots;
+    }
+
+    // The chunks that the slots are carved out of.
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    // The most recently freed slot, nullptr if there are no free slots.
+    Slot *free_list;
+    // The number of slots allocated each time the pool grows.
+    size_t chunk_size;
+    // The total number of slots and the number of slots in use.
+    size_t num_slots;
+    size_t num_live;
+};
+} // namespace RapidTrader
+#endif // RAPID_TRADER_OBJECT_POOL_H
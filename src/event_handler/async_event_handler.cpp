@@ -0,0 +1,243 @@
+#include "event_handler/async_event_handler.h"
+
+namespace RapidTrader {
+Order EventRecord::toOrder() const
+{
+    Order result{order_type, side, time_in_force, symbol_id, order.price, order.stop_price, order.trail_amount, order.quantity, order.id};
+    result.open_quantity = order.open_quantity;
+    result.executed_quantity = order.executed_quantity;
+    result.last_executed_price = order.last_executed_price;
+    result.last_executed_quantity = order.last_executed_quantity;
+    return result;
+}
+
+Trade EventRecord::toTrade() const
+{
+    return Trade{symbol_id, trade.trade_seq, trade.aggressor_id, trade.passive_id, trade.price, trade.quantity,
+        trade.aggressor_open_quantity, trade.passive_open_quantity, side};
+}
+
+AsyncEventHandler::AsyncEventHandler(std::unique_ptr<EventHandler> downstream_, const EventRingConfig &config_)
+    : downstream(std::move(downstream_))
+    , handles_trades(downstream->handlesTrades())
+    , handles_execution_reports(downstream->handlesExecutionReports())
+    , full_ring_policy(config_.full_ring_policy)
+    , wait_strategy(config_.wait_strategy)
+    , ring(config_.capacity)
+    , publisher(&AsyncEventHandler::publisherThread, this)
+{}
+
+AsyncEventHandler::~AsyncEventHandler()
+{
+    running.store(false, std::memory_order_release);
+    publisher_signal.notify();
+    publisher.join();
+}
+
+void AsyncEventHandler::flush()
+{
+    uint64_t pushed = pushed_events.load(std::memory_order_relaxed);
+    while (published_events.load(std::memory_order_acquire) < pushed)
+    {
+        notifyPublisher();
+        std::this_thread::yield();
+    }
+}
+
+EventRingMetrics AsyncEventHandler::getMetrics() const
+{
+    return EventRingMetrics{ring.maxSize(), ring.size(), max_occupancy.load(std::memory_order_relaxed),
+        published_events.load(std::memory_order_relaxed), blocked_events.load(std::memory_order_relaxed),
+        overflowed_events.load(std::memory_order_relaxed), shed_events.load(std::memory_order_relaxed)};
+}
+
+void AsyncEventHandler::handleExecutionReport(const ExecutionReport &event)
+{
+    size_t num_records = 1 + event.orders.size() + event.fills.size();
+    // A report that is partly shed could not be reassembled.
+    if (full_ring_policy == FullRingPolicy::Shed && ring.maxSize() - ring.size() < num_records)
+    {
+        shed_events.store(shed_events.load(std::memory_order_relaxed) + num_records, std::memory_order_relaxed);
+        return;
+    }
+    push(EventRecord::fromReport(event));
+    for (const OrderReport &order_report : event.orders)
+        push(EventRecord::fromOrder(order_report.resting ? EventType::OrderUpdated : EventType::OrderDeleted, order_report.order));
+    for (const Trade &fill : event.fills)
+        push(EventRecord::fromTrade(fill));
+}
+
+void AsyncEventHandler::pushFull(EventRecord &record)
+{
+    // Only the thread that raises events writes these counters, so they are incremented without
+    // read-modify-write instructions.
+    auto increment = [](std::atomic<uint64_t> &counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    };
+    switch (full_ring_policy)
+    {
+    case FullRingPolicy::Block:
+        increment(blocked_events);
+        do
+        {
+            notifyPublisher();
+            std::this_thread::yield();
+        } while (!ring.tryPush(record));
+        break;
+    case FullRingPolicy::Overflow:
+    {
+        increment(overflowed_events);
+        std::lock_guard<std::mutex> lock(overflow_mutex);
+        overflow.push_back(record);
+        overflow_size.store(overflow.size(), std::memory_order_release);
+        break;
+    }
+    case FullRingPolicy::Shed:
+        increment(shed_events);
+        dropRecord(record);
+        return;
+    }
+    pushed_events.store(pushed_events.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    notifyPublisher();
+}
+
+void AsyncEventHandler::publisherThread()
+{
+    std::vector<EventRecord> overflow_batch;
+    EventRecord record{};
+    // The number of consecutive times the ring has been found empty.
+    uint32_t idle_rounds = 0;
+    while (true)
+    {
+        size_t num_records = ring.size();
+        if (overflow_size.load(std::memory_order_acquire) != 0)
+        {
+            // The thread that raises events stops pushing onto the ring while the overflow buffer
+            // is not empty, so the records in the ring now all precede the buffered records. The
+            // ring is measured before the buffer is marked empty, after which newer records may
+            // be pushed onto the ring and must wait for the next round.
+            std::lock_guard<std::mutex> lock(overflow_mutex);
+            overflow_batch.swap(overflow);
+            num_records = ring.size();
+            overflow_size.store(0, std::memory_order_release);
+        }
+        if (num_records == 0 && overflow_batch.empty())
+        {
+            // Keep publishing until the handler is destroyed and every record has been published.
+            // Otherwise, events raised just before destruction would be lost.
+            if (!running.load(std::memory_order_acquire) && ring.empty() && overflow_size.load(std::memory_order_acquire) == 0)
+                return;
+            waitForRecords(idle_rounds++);
+            continue;
+        }
+        idle_rounds = 0;
+        if (num_records > max_occupancy.load(std::memory_order_relaxed))
+            max_occupancy.store(num_records, std::memory_order_relaxed);
+        for (size_t i = 0; i < num_records; ++i)
+        {
+            ring.tryPop(record);
+            publish(record);
+        }
+        for (const auto &overflow_record : overflow_batch)
+            publish(overflow_record);
+        overflow_batch.clear();
+    }
+}
+
+void AsyncEventHandler::publish(const EventRecord &record)
+{
+    if (remaining_report_records > 0)
+    {
+        publishReportRecord(record);
+        return;
+    }
+    switch (record.type)
+    {
+    case EventType::OrderAdded:
+        downstream->handleOrderAdded(OrderAdded{record.toOrder()});
+        break;
+    case EventType::OrderDeleted:
+        downstream->handleOrderDeleted(OrderDeleted{record.toOrder()});
+        break;
+    case EventType::OrderUpdated:
+        downstream->handleOrderUpdated(OrderUpdated{record.toOrder()});
+        break;
+    case EventType::OrderExecuted:
+        downstream->handleOrderExecuted(ExecutedOrder{record.toOrder()});
+        break;
+    case EventType::Trade:
+        downstream->handleTrade(record.toTrade());
+        break;
+    case EventType::SymbolAdded:
+    {
+        std::unique_ptr<std::string> name{record.symbol_name};
+        downstream->handleSymbolAdded(SymbolAdded{record.symbol_id, std::move(*name)});
+        break;
+    }
+    case EventType::SymbolDeleted:
+    {
+        std::unique_ptr<std::string> name{record.symbol_name};
+        downstream->handleSymbolDeleted(SymbolDeleted{record.symbol_id, std::move(*name)});
+        break;
+    }
+    case EventType::ExecutionReport:
+        report.symbol_id = record.symbol_id;
+        remaining_report_records = record.report.num_orders + record.report.num_fills;
+        break;
+    }
+    published_events.store(published_events.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void AsyncEventHandler::publishReportRecord(const EventRecord &record)
+{
+    // The orders of a report precede its fills.
+    if (record.type == EventType::Trade)
+        report.fills.push_back(record.toTrade());
+    else
+        report.orders.push_back(OrderReport{record.toOrder(), record.type == EventType::OrderUpdated});
+    if (--remaining_report_records == 0)
+    {
+        downstream->handleExecutionReport(report);
+        report.clear();
+    }
+    published_events.store(published_events.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void AsyncEventHandler::waitForRecords(uint32_t idle_rounds)
+{
+    switch (wait_strategy)
+    {
+    case Concurrent::WaitStrategy::BusySpin:
+        Concurrent::cpuRelax();
+        return;
+    case Concurrent::WaitStrategy::Backoff:
+        if (idle_rounds < BACKOFF_SPIN_ROUNDS)
+        {
+            Concurrent::cpuRelax();
+            return;
+        }
+        if (idle_rounds < BACKOFF_SPIN_ROUNDS + BACKOFF_YIELD_ROUNDS)
+        {
+            std::this_thread::yield();
+            return;
+        }
+        break;
+    case Concurrent::WaitStrategy::Block:
+        break;
+    }
+    uint32_t key = publisher_signal.prepareWait();
+    // Check again now that the thread raising events can see that the publisher is parking.
+    if (!running.load(std::memory_order_acquire) || !ring.empty() || overflow_size.load(std::memory_order_acquire) != 0)
+    {
+        publisher_signal.cancelWait();
+        return;
+    }
+    publisher_signal.wait(key);
+}
+
+void AsyncEventHandler::dropRecord(EventRecord &record)
+{
+    if (record.type == EventType::SymbolAdded || record.type == EventType::SymbolDeleted)
+        delete record.symbol_name;
+}
+} // namespace RapidTrader
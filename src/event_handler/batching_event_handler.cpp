@@ -0,0 +1,134 @@
+#include <cassert>
+#include <cstring>
+#include "event_handler/batching_event_handler.h"
+
+namespace RapidTrader {
+BatchingEventHandler::BatchingEventHandler(std::unique_ptr<MessageProducer> producer_, BatchConfig config_)
+    : config(std::move(config_))
+    , serializer(config.format)
+    // Every event is followed by a separator, except in the binary format.
+    , pool(config.max_batch_events * (EventSerializer::MAX_EVENT_SIZE + 1), config.max_in_flight_batches)
+    , producer(std::move(producer_))
+    , batch(nullptr)
+    , batch_size(0)
+    , batch_events(0)
+    , running(true)
+{
+    assert(config.max_batch_events > 0 && "Batches must hold at least one event!");
+    producer->setDeliveryCallback([this](void *opaque, bool delivered) {
+        if (!delivered)
+            failed_messages.fetch_add(1, std::memory_order_relaxed);
+        char *buffer = static_cast<char *>(opaque);
+        if (pool.owns(buffer))
+            pool.release(buffer);
+        else
+            delete[] buffer;
+    });
+    delivery = std::thread(&BatchingEventHandler::deliveryThread, this);
+}
+
+BatchingEventHandler::~BatchingEventHandler()
+{
+    {
+        std::lock_guard<std::mutex> lock(batch_mutex);
+        if (batch)
+            sendBatch(config.batch_key);
+        running = false;
+    }
+    batch_started.notify_one();
+    delivery.join();
+    producer->flush(FLUSH_TIMEOUT_MS);
+}
+
+void BatchingEventHandler::flush()
+{
+    std::lock_guard<std::mutex> lock(batch_mutex);
+    if (batch)
+        sendBatch(config.batch_key);
+}
+
+BatchMetrics BatchingEventHandler::getMetrics() const
+{
+    return BatchMetrics{batched_events.load(std::memory_order_relaxed), produced_messages.load(std::memory_order_relaxed),
+        failed_messages.load(std::memory_order_relaxed)};
+}
+
+void BatchingEventHandler::append(std::string_view key, std::string_view event)
+{
+    std::unique_lock<std::mutex> lock(batch_mutex);
+    std::string_view message_key = config.max_batch_events == 1 ? key : std::string_view{config.batch_key};
+    // Execution reports may not fit in the space left in the batch, or in a buffer at all.
+    size_t separator_size = config.format == EventFormat::Json ? 1 : 0;
+    if (batch && batch_size + separator_size + event.size() > pool.bufferSize())
+        sendBatch(config.batch_key);
+    if (event.size() > pool.bufferSize())
+    {
+        sendOversized(message_key, event);
+        return;
+    }
+    if (!batch)
+    {
+        // Every buffer is in flight, wait for the delivery thread to serve a delivery report.
+        while (!(batch = pool.tryAcquire()))
+        {
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+        }
+        batch_start = std::chrono::steady_clock::now();
+        if (config.max_batch_events > 1)
+            batch_started.notify_one();
+    }
+    else if (config.format == EventFormat::Json)
+    {
+        batch[batch_size++] = '\n';
+    }
+    std::memcpy(batch + batch_size, event.data(), event.size());
+    batch_size += event.size();
+    ++batch_events;
+    batched_events.fetch_add(1, std::memory_order_relaxed);
+    if (batch_events == config.max_batch_events)
+        sendBatch(message_key);
+}
+
+void BatchingEventHandler::sendBatch(std::string_view key)
+{
+    assert(batch && "There is no batch to send!");
+    // The producer's queue is full, serve delivery reports until it has space.
+    while (!producer->produce(key, std::string_view{batch, batch_size}, batch))
+        producer->poll(static_cast<int>(DELIVERY_POLL_INTERVAL.count()));
+    produced_messages.fetch_add(1, std::memory_order_relaxed);
+    batch = nullptr;
+    batch_size = 0;
+    batch_events = 0;
+}
+
+void BatchingEventHandler::sendOversized(std::string_view key, std::string_view event)
+{
+    char *message = new char[event.size()];
+    std::memcpy(message, event.data(), event.size());
+    while (!producer->produce(key, std::string_view{message, event.size()}, message))
+        producer->poll(static_cast<int>(DELIVERY_POLL_INTERVAL.count()));
+    batched_events.fetch_add(1, std::memory_order_relaxed);
+    produced_messages.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BatchingEventHandler::deliveryThread()
+{
+    std::unique_lock<std::mutex> lock(batch_mutex);
+    while (running)
+    {
+        auto deadline = std::chrono::steady_clock::now() + DELIVERY_POLL_INTERVAL;
+        if (batch)
+            deadline = std::min(deadline, batch_start + config.max_batch_delay);
+        batch_started.wait_until(lock, deadline);
+        if (batch && std::chrono::steady_clock::now() >= batch_start + config.max_batch_delay)
+            sendBatch(config.batch_key);
+        // Delivery reports release buffers without the batch mutex, so the thread raising events
+        // can keep filling batches while reports are served.
+        lock.unlock();
+        producer->poll(0);
+        lock.lock();
+    }
+}
+} // namespace RapidTrader
@@ -43,5 +43,30 @@ std::ostream &operator<<(std::ostream &os, const OrderUpdated &notification)
     os << "UPDATED ORDER\n" << notification.order;
     return os;
 }
+
+std::ostream &operator<<(std::ostream &os, const Trade &notification)
+{
+    os << "TRADE\n"
+       << "Symbol ID: " << notification.symbol_id << "\n"
+       << "Trade Sequence: " << notification.trade_seq << "\n"
+       << "Aggressor ID: " << notification.aggressor_id << "\n"
+       << "Passive ID: " << notification.passive_id << "\n"
+       << "Price: " << notification.price << "\n"
+       << "Quantity: " << notification.quantity << "\n"
+       << "Aggressor Open Quantity: " << notification.aggressor_open_quantity << "\n"
+       << "Passive Open Quantity: " << notification.passive_open_quantity << "\n";
+    return os;
+}
+
+std::ostream &operator<<(std::ostream &os, const ExecutionReport &notification)
+{
+    os << "EXECUTION REPORT\n"
+       << "Symbol ID: " << notification.symbol_id << "\n";
+    for (const OrderReport &order_report : notification.orders)
+        os << (order_report.resting ? "RESTING ORDER\n" : "DONE ORDER\n") << order_report.order;
+    for (const Trade &fill : notification.fills)
+        os << fill;
+    return os;
+}
 } // namespace RapidTrader
 // LCOV_EXCL_STOP
\ No newline at end of file
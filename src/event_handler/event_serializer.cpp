@@ -0,0 +1,326 @@
+#include <cassert>
+#include <cstring>
+#include "event_handler/event_serializer.h"
+
+namespace RapidTrader {
+namespace {
+// The two-digit decimal representations of 0 through 99.
+constexpr char DIGIT_PAIRS[] = "00010203040506070809"
+                               "10111213141516171819"
+                               "20212223242526272829"
+                               "30313233343536373839"
+                               "40414243444546474849"
+                               "50515253545556575859"
+                               "60616263646566676869"
+                               "70717273747576777879"
+                               "80818283848586878889"
+                               "90919293949596979899";
+
+/**
+ * Writes the decimal representation of a value, two digits at a time.
+ *
+ * @param out where the digits are written, require that there is space for 20 digits.
+ * @param value the value to write.
+ * @return one past the last digit written.
+ */
+char *writeUnsigned(char *out, uint64_t value)
+{
+    char digits[20];
+    char *first = digits + sizeof(digits);
+    while (value >= 100)
+    {
+        uint64_t pair = (value % 100) * 2;
+        value /= 100;
+        first -= 2;
+        first[0] = DIGIT_PAIRS[pair];
+        first[1] = DIGIT_PAIRS[pair + 1];
+    }
+    if (value >= 10)
+    {
+        first -= 2;
+        first[0] = DIGIT_PAIRS[value * 2];
+        first[1] = DIGIT_PAIRS[value * 2 + 1];
+    }
+    else
+    {
+        *--first = static_cast<char>('0' + value);
+    }
+    size_t length = digits + sizeof(digits) - first;
+    std::memcpy(out, first, length);
+    return out + length;
+}
+
+/**
+ * Writes a string.
+ *
+ * @param out where the string is written, require that there is space for it.
+ * @param text the string to write.
+ * @return one past the last character written.
+ */
+char *writeString(char *out, std::string_view text)
+{
+    std::memcpy(out, text.data(), text.size());
+    return out + text.size();
+}
+
+/**
+ * Writes a value in little-endian byte order, whatever the byte order of the host.
+ *
+ * @param out where the value is written, require that there is space for it.
+ * @param value the value to write.
+ * @return one past the last byte written.
+ */
+template<typename T>
+char *writeLittleEndian(char *out, T value)
+{
+    for (size_t i = 0; i < sizeof(T); ++i)
+        out[i] = static_cast<char>(static_cast<uint64_t>(value) >> (8 * i));
+    return out + sizeof(T);
+}
+
+std::string_view eventTypeName(EventType type)
+{
+    switch (type)
+    {
+    case EventType::OrderAdded:
+        return "OrderAdded";
+    case EventType::OrderDeleted:
+        return "OrderDeleted";
+    case EventType::OrderUpdated:
+        return "OrderUpdated";
+    case EventType::OrderExecuted:
+        return "ExecutedOrder";
+    case EventType::Trade:
+        return "Trade";
+    case EventType::ExecutionReport:
+        return "ExecutionReport";
+    default:
+        return "Unknown";
+    }
+}
+
+std::string_view orderTypeName(OrderType type)
+{
+    switch (type)
+    {
+    case OrderType::Limit:
+        return "Limit";
+    case OrderType::Market:
+        return "Market";
+    case OrderType::Stop:
+        return "Stop";
+    case OrderType::StopLimit:
+        return "StopLimit";
+    case OrderType::TrailingStop:
+        return "TrailingStop";
+    case OrderType::TrailingStopLimit:
+        return "TrailingStopLimit";
+    default:
+        return "Unknown";
+    }
+}
+
+std::string_view sideName(OrderSide side)
+{
+    return side == OrderSide::Bid ? "Bid" : "Ask";
+}
+
+/**
+ * Writes an order as a fixed-size binary record.
+ *
+ * @param out where the record is written, require that there is space for BINARY_EVENT_SIZE bytes.
+ * @param type the type of the event that the record describes.
+ * @param order the order.
+ * @return one past the last byte written.
+ */
+char *writeOrderBinary(char *out, EventType type, const Order &order)
+{
+    out = writeLittleEndian(out, BINARY_EVENT_MAGIC);
+    out = writeLittleEndian(out, static_cast<uint8_t>(type));
+    out = writeLittleEndian(out, static_cast<uint8_t>(order.getSide()));
+    out = writeLittleEndian(out, static_cast<uint8_t>(order.getType()));
+    out = writeLittleEndian(out, order.getSymbolID());
+    out = writeLittleEndian(out, order.getOrderID());
+    out = writeLittleEndian(out, order.getPrice());
+    out = writeLittleEndian(out, order.getQuantity());
+    out = writeLittleEndian(out, order.getOpenQuantity());
+    out = writeLittleEndian(out, order.getExecutedQuantity());
+    out = writeLittleEndian(out, order.getLastExecutedPrice());
+    return writeLittleEndian(out, order.getLastExecutedQuantity());
+}
+
+/**
+ * Writes the fields of an order as a JSON object.
+ *
+ * @param out where the object is written, require that there is space for it.
+ * @param order the order.
+ * @return one past the last character written.
+ */
+char *writeOrderJson(char *out, const Order &order)
+{
+    // Keys are written in lexicographic order, the order in which JSON objects have always been dumped.
+    out = writeString(out, "{\"executed_quantity\":");
+    out = writeUnsigned(out, order.getExecutedQuantity());
+    out = writeString(out, ",\"last_executed_price\":");
+    out = writeUnsigned(out, order.getLastExecutedPrice());
+    out = writeString(out, ",\"last_executed_quantity\":");
+    out = writeUnsigned(out, order.getLastExecutedQuantity());
+    out = writeString(out, ",\"open_quantity\":");
+    out = writeUnsigned(out, order.getOpenQuantity());
+    out = writeString(out, ",\"order_id\":");
+    out = writeUnsigned(out, order.getOrderID());
+    out = writeString(out, ",\"price\":");
+    out = writeUnsigned(out, order.getPrice());
+    out = writeString(out, ",\"quantity\":");
+    out = writeUnsigned(out, order.getQuantity());
+    out = writeString(out, ",\"side\":\"");
+    out = writeString(out, sideName(order.getSide()));
+    out = writeString(out, "\",\"symbol_id\":");
+    out = writeUnsigned(out, order.getSymbolID());
+    out = writeString(out, ",\"type\":\"");
+    out = writeString(out, orderTypeName(order.getType()));
+    return writeString(out, "\"}");
+}
+
+/**
+ * Writes a trade as a fixed-size binary record.
+ *
+ * @param out where the record is written, require that there is space for BINARY_EVENT_SIZE bytes.
+ * @param trade the trade.
+ * @return one past the last byte written.
+ */
+char *writeTradeBinary(char *out, const Trade &trade)
+{
+    out = writeLittleEndian(out, BINARY_EVENT_MAGIC);
+    out = writeLittleEndian(out, static_cast<uint8_t>(EventType::Trade));
+    out = writeLittleEndian(out, static_cast<uint8_t>(trade.aggressor_side));
+    out = writeLittleEndian(out, uint8_t{0});
+    out = writeLittleEndian(out, trade.symbol_id);
+    out = writeLittleEndian(out, trade.trade_seq);
+    out = writeLittleEndian(out, trade.aggressor_id);
+    out = writeLittleEndian(out, trade.passive_id);
+    out = writeLittleEndian(out, trade.price);
+    out = writeLittleEndian(out, trade.quantity);
+    out = writeLittleEndian(out, trade.aggressor_open_quantity);
+    return writeLittleEndian(out, trade.passive_open_quantity);
+}
+
+/**
+ * Writes the fields of a trade as a JSON object.
+ *
+ * @param out where the object is written, require that there is space for it.
+ * @param trade the trade.
+ * @return one past the last character written.
+ */
+char *writeTradeJson(char *out, const Trade &trade)
+{
+    out = writeString(out, "{\"aggressor_id\":");
+    out = writeUnsigned(out, trade.aggressor_id);
+    out = writeString(out, ",\"aggressor_open_quantity\":");
+    out = writeUnsigned(out, trade.aggressor_open_quantity);
+    out = writeString(out, ",\"aggressor_side\":\"");
+    out = writeString(out, sideName(trade.aggressor_side));
+    out = writeString(out, "\",\"passive_id\":");
+    out = writeUnsigned(out, trade.passive_id);
+    out = writeString(out, ",\"passive_open_quantity\":");
+    out = writeUnsigned(out, trade.passive_open_quantity);
+    out = writeString(out, ",\"price\":");
+    out = writeUnsigned(out, trade.price);
+    out = writeString(out, ",\"quantity\":");
+    out = writeUnsigned(out, trade.quantity);
+    out = writeString(out, ",\"symbol_id\":");
+    out = writeUnsigned(out, trade.symbol_id);
+    out = writeString(out, ",\"trade_seq\":");
+    out = writeUnsigned(out, trade.trade_seq);
+    return writeString(out, "}");
+}
+} // namespace
+
+std::string_view EventSerializer::serializeOrder(EventType type, const Order &order)
+{
+    char *out = buffer.data();
+    if (format == EventFormat::Binary)
+    {
+        out = writeOrderBinary(out, type, order);
+        assert(static_cast<size_t>(out - buffer.data()) == BINARY_EVENT_SIZE && "Binary events must have a fixed size!");
+        return {buffer.data(), BINARY_EVENT_SIZE};
+    }
+    out = writeString(out, "{\"data\":");
+    out = writeOrderJson(out, order);
+    out = writeString(out, ",\"event_type\":\"");
+    out = writeString(out, eventTypeName(type));
+    out = writeString(out, "\"}");
+    assert(static_cast<size_t>(out - buffer.data()) <= MAX_EVENT_SIZE && "Serialized event overflowed its buffer!");
+    return {buffer.data(), static_cast<size_t>(out - buffer.data())};
+}
+
+std::string_view EventSerializer::serialize(const Trade &event)
+{
+    char *out = buffer.data();
+    if (format == EventFormat::Binary)
+    {
+        out = writeTradeBinary(out, event);
+        assert(static_cast<size_t>(out - buffer.data()) == BINARY_EVENT_SIZE && "Binary events must have a fixed size!");
+        return {buffer.data(), BINARY_EVENT_SIZE};
+    }
+    out = writeString(out, "{\"data\":");
+    out = writeTradeJson(out, event);
+    out = writeString(out, ",\"event_type\":\"Trade\"}");
+    assert(static_cast<size_t>(out - buffer.data()) <= MAX_EVENT_SIZE && "Serialized event overflowed its buffer!");
+    return {buffer.data(), static_cast<size_t>(out - buffer.data())};
+}
+
+std::string_view EventSerializer::serialize(const ExecutionReport &event)
+{
+    // Each order and fill is no longer than a whole event, and the header is no longer than one.
+    size_t max_size = (1 + event.orders.size() + event.fills.size()) * (format == EventFormat::Binary ? BINARY_EVENT_SIZE : MAX_EVENT_SIZE);
+    if (report_buffer.size() < max_size)
+        report_buffer.resize(max_size);
+    char *out = report_buffer.data();
+    if (format == EventFormat::Binary)
+    {
+        out = writeLittleEndian(out, BINARY_EVENT_MAGIC);
+        out = writeLittleEndian(out, static_cast<uint8_t>(EventType::ExecutionReport));
+        out = writeLittleEndian(out, uint16_t{0});
+        out = writeLittleEndian(out, event.symbol_id);
+        out = writeLittleEndian(out, static_cast<uint32_t>(event.orders.size()));
+        out = writeLittleEndian(out, static_cast<uint32_t>(event.fills.size()));
+        std::memset(out, 0, BINARY_EVENT_SIZE - 16);
+        out += BINARY_EVENT_SIZE - 16;
+        for (const OrderReport &order_report : event.orders)
+            out = writeOrderBinary(out, order_report.resting ? EventType::OrderUpdated : EventType::OrderDeleted, order_report.order);
+        for (const Trade &fill : event.fills)
+            out = writeTradeBinary(out, fill);
+    }
+    else
+    {
+        out = writeString(out, "{\"data\":{\"fills\":[");
+        for (size_t i = 0; i < event.fills.size(); ++i)
+        {
+            if (i > 0)
+                *out++ = ',';
+            out = writeTradeJson(out, event.fills[i]);
+        }
+        out = writeString(out, "],\"orders\":[");
+        for (size_t i = 0; i < event.orders.size(); ++i)
+        {
+            if (i > 0)
+                *out++ = ',';
+            out = writeString(out, "{\"order\":");
+            out = writeOrderJson(out, event.orders[i].order);
+            out = writeString(out, event.orders[i].resting ? ",\"resting\":true}" : ",\"resting\":false}");
+        }
+        out = writeString(out, "],\"symbol_id\":");
+        out = writeUnsigned(out, event.symbol_id);
+        out = writeString(out, "},\"event_type\":\"ExecutionReport\"}");
+    }
+    assert(static_cast<size_t>(out - report_buffer.data()) <= max_size && "Serialized report overflowed its buffer!");
+    return {report_buffer.data(), static_cast<size_t>(out - report_buffer.data())};
+}
+
+std::string_view EventSerializer::key(uint64_t order_id)
+{
+    char *end = writeUnsigned(key_buffer.data(), order_id);
+    return {key_buffer.data(), static_cast<size_t>(end - key_buffer.data())};
+}
+} // namespace RapidTrader
@@ -0,0 +1,92 @@
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include "event_handler/message_producer.h"
+
+namespace RapidTrader {
+namespace {
+void writeSize(std::FILE *file, size_t size)
+{
+    unsigned char bytes[4];
+    for (size_t i = 0; i < sizeof(bytes); ++i)
+        bytes[i] = static_cast<unsigned char>(size >> (8 * i));
+    std::fwrite(bytes, 1, sizeof(bytes), file);
+}
+
+bool readSize(std::FILE *file, size_t &size)
+{
+    unsigned char bytes[4];
+    if (std::fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes))
+        return false;
+    size = 0;
+    for (size_t i = 0; i < sizeof(bytes); ++i)
+        size |= static_cast<size_t>(bytes[i]) << (8 * i);
+    return true;
+}
+} // namespace
+
+FileMessageProducer::FileMessageProducer(const std::string &path)
+    : file(std::fopen(path.c_str(), "wb"))
+{
+    assert(file && "Failed to open message file!");
+}
+
+FileMessageProducer::~FileMessageProducer()
+{
+    flush(0);
+    std::fclose(file);
+}
+
+bool FileMessageProducer::produce(std::string_view key, std::string_view payload, void *opaque)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    writeSize(file, key.size());
+    writeSize(file, payload.size());
+    std::fwrite(key.data(), 1, key.size(), file);
+    std::fwrite(payload.data(), 1, payload.size(), file);
+    undelivered.push_back(opaque);
+    produced.notify_one();
+    return true;
+}
+
+void FileMessageProducer::poll(int timeout_ms)
+{
+    // Deliveries are reported without holding the mutex, so that the callback may produce.
+    std::vector<void *> delivering;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        produced.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] { return !undelivered.empty(); });
+        std::fflush(file);
+        delivering.swap(undelivered);
+    }
+    for (void *opaque : delivering)
+        reportDelivery(opaque, true);
+}
+
+bool FileMessageProducer::flush([[maybe_unused]] int timeout_ms)
+{
+    // Written messages are already delivered, so there is nothing to wait for.
+    poll(0);
+    return true;
+}
+
+std::vector<std::pair<std::string, std::string>> FileMessageProducer::readMessages(const std::string &path)
+{
+    std::vector<std::pair<std::string, std::string>> messages;
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return messages;
+    size_t key_size;
+    size_t payload_size;
+    while (readSize(file, key_size) && readSize(file, payload_size))
+    {
+        std::string key(key_size, '\0');
+        std::string payload(payload_size, '\0');
+        if (std::fread(key.data(), 1, key_size, file) != key_size || std::fread(payload.data(), 1, payload_size, file) != payload_size)
+            break;
+        messages.emplace_back(std::move(key), std::move(payload));
+    }
+    std::fclose(file);
+    return messages;
+}
+} // namespace RapidTrader
@@ -1,26 +1,34 @@
 // //match_engine/src/kafka_event_handler.h
 #pragma once
-#include "event_handler/event_handler.h"
-#include <nlohmann/json.hpp>
+#include "event_handler/message_producer.h"
 #include <librdkafka/rdkafkacpp.h>
+#include <memory>
+#include <string>
+#include <string_view>
 
-using json = nlohmann::json;
 namespace RapidTrader {
-class KafkaEventHandler : public EventHandler {
+// Produces messages to a Kafka topic without copying their payloads. Delivery reports are
+// served by poll and flush, as librdkafka serves them on the thread that polls the producer.
+class KafkaMessageProducer : public MessageProducer {
 public:
-    explicit KafkaEventHandler(std::unique_ptr<RdKafka::Producer> producer, std::string topic_name);
-    ~KafkaEventHandler() override = default;
-protected:
-    void handleOrderAdded(const OrderAdded& event) override;
-    void handleOrderDeleted(const OrderDeleted& event) override;
-    void handleOrderUpdated(const OrderUpdated& event) override;
-    void handleOrderExecuted(const ExecutedOrder& event) override;
-    void handleSymbolAdded(const SymbolAdded& event) override;
-    void handleSymbolDeleted(const SymbolDeleted& event) override;
+    // Sets the delivery report callback of conf and creates a producer from it, returns nullptr and sets errstr on failure.
+    static std::unique_ptr<KafkaMessageProducer> create(RdKafka::Conf* conf, std::string topic_name, std::string& errstr);
+    ~KafkaMessageProducer() override = default;
+    bool produce(std::string_view key, std::string_view payload, void* opaque) override;
+    void poll(int timeout_ms) override;
+    bool flush(int timeout_ms) override;
 private:
-    void send_message(const std::string& key, const std::string& payload);
-    json order_to_json(const Order& order);
-    std::unique_ptr<RdKafka::Producer> kafka_producer;
+    class DeliveryReport : public RdKafka::DeliveryReportCb {
+    public:
+        explicit DeliveryReport(KafkaMessageProducer& producer_) : producer(producer_) {}
+        void dr_cb(RdKafka::Message& message) override;
+    private:
+        KafkaMessageProducer& producer;
+    };
+    explicit KafkaMessageProducer(std::string topic_name);
     std::string topic_name;
+    // IMPORTANT: librdkafka keeps a pointer to the callback, so it must outlive the producer.
+    DeliveryReport delivery_report;
+    std::unique_ptr<RdKafka::Producer> kafka_producer;
 };
-} // namespace RapidTrader
\ No newline at end of file
+} // namespace RapidTrader
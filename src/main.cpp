@@ -1,6 +1,10 @@
 // //match_engine/src/main.cpp
+#include "matching/market/binary_command.h"
 #include "matching/market/concurrent_market.h"
+#include "event_handler/async_event_handler.h"
+#include "event_handler/batching_event_handler.h"
 #include "kafka_event_handler.h"
+#include <algorithm>
 #include <csignal>
 #include <iostream>
 #include <memory>
@@ -16,6 +20,8 @@ static volatile sig_atomic_t run = 1;
 static void sigterm(int sig) { run = 0; }
 OrderSide string_to_side(const std::string& s) { if (s == "buy") return OrderSide::Bid; return OrderSide::Ask; }
 OrderTimeInForce string_to_tif(const std::string& s) { if (s == "IOC") return OrderTimeInForce::IOC; if (s == "FOK") return OrderTimeInForce::FOK; return OrderTimeInForce::GTC; }
+FullRingPolicy string_to_full_ring_policy(const std::string& s) { if (s == "overflow") return FullRingPolicy::Overflow; if (s == "shed") return FullRingPolicy::Shed; return FullRingPolicy::Block; }
+EventFormat string_to_event_format(const std::string& s) { if (s == "binary") return EventFormat::Binary; return EventFormat::Json; }
 
 // Helper function to produce rejection messages directly
 void produce_rejection(RdKafka::Producer* producer, const std::string& topic, const json& payload, const std::string& reason) {
@@ -66,10 +72,42 @@ int main(int argc, char **argv) {
     }
     
     const uint32_t num_threads = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() : 2;
-    std::vector<std::unique_ptr<EventHandler>> event_handlers;
+    // Each worker hands its events to a publisher thread through a ring, so that matching never
+    // waits on serialization or on the producer.
+    const char* ring_policy_env = std::getenv("EVENT_RING_POLICY");
+    EventRingConfig ring_config;
+    ring_config.full_ring_policy = string_to_full_ring_policy(ring_policy_env ? ring_policy_env : "block");
+    const char* event_format_env = std::getenv("EVENT_FORMAT");
+    EventFormat event_format = string_to_event_format(event_format_env ? event_format_env : "json");
+    // Events are coalesced into batches that are produced without copying. A batch size of one
+    // produces one message per event keyed by its order ID.
+    BatchConfig batch_config;
+    batch_config.format = event_format;
+    const char* batch_size_env = std::getenv("EVENT_BATCH_SIZE");
+    if (batch_size_env) batch_config.max_batch_events = std::max<size_t>(1, std::stoull(batch_size_env));
+    const char* batch_delay_env = std::getenv("EVENT_BATCH_DELAY_US");
+    if (batch_delay_env) batch_config.max_batch_delay = std::chrono::microseconds(std::stoull(batch_delay_env));
+    // TRADE_EVENTS=1 publishes one Trade per fill instead of an ExecutedOrder for each of its two orders.
+    const char* trade_events_env = std::getenv("TRADE_EVENTS");
+    batch_config.trade_events = trade_events_env && std::string(trade_events_env) == "1";
+    // EXECUTION_REPORTS=1 publishes one execution report per command instead of its individual events.
+    const char* execution_reports_env = std::getenv("EXECUTION_REPORTS");
+    batch_config.execution_reports = execution_reports_env && std::string(execution_reports_env) == "1";
+    // The handlers keep their final type, so that orderbooks are bound to them at compile time.
+    std::vector<std::unique_ptr<AsyncEventHandler>> event_handlers;
+    std::vector<AsyncEventHandler*> publishers;
+    std::vector<BatchingEventHandler*> batchers;
     for (uint32_t i = 0; i < num_threads; ++i) { 
         std::string handler_err;
-        event_handlers.push_back(std::make_unique<KafkaEventHandler>(std::unique_ptr<RdKafka::Producer>(RdKafka::Producer::create(prod_conf.get(), handler_err)), outbound_topic)); 
+        auto kafka_producer = KafkaMessageProducer::create(prod_conf.get(), outbound_topic, handler_err);
+        if (!kafka_producer) { std::cerr << "Failed to create event producer: " << handler_err << std::endl; exit(1); }
+        // Each worker keys its batches by its own key, so its events stay in order on one partition.
+        batch_config.batch_key = "worker-" + std::to_string(i);
+        auto batching_handler = std::make_unique<BatchingEventHandler>(std::move(kafka_producer), batch_config);
+        batchers.push_back(batching_handler.get());
+        auto publisher = std::make_unique<AsyncEventHandler>(std::move(batching_handler), ring_config);
+        publishers.push_back(publisher.get());
+        event_handlers.push_back(std::move(publisher)); 
     }
     ConcurrentMarket market(event_handlers, num_threads);
     std::cout << "Matching Engine started with " << num_threads << " threads." << std::endl;
@@ -91,7 +129,31 @@ int main(int argc, char **argv) {
         std::unique_ptr<RdKafka::Message> msg(consumer->consume(1000));
         if (!msg) continue;
         if (msg->err()) { if (msg->err() == RdKafka::ERR__TIMED_OUT) continue; std::cerr << "% Consume error: " << msg->errstr() << std::endl; continue; }
-        
+
+        // Binary commands are decoded in place, without parsing or allocating.
+        const char *data = static_cast<const char *>(msg->payload());
+        if (BinaryCommand::isBinary(data, msg->len())) {
+            BinaryCommand command;
+            if (!BinaryCommand::decode(data, msg->len(), command)) { std::cerr << "Malformed binary command of " << msg->len() << " bytes" << std::endl; continue; }
+            if (command.operation == BinaryOperation::AddOrder) {
+                if (command.order_type == OrderType::Limit) {
+                    Order order = command.side == OrderSide::Bid ?
+                        Order::limitBidOrder(command.order_id, command.symbol_id, command.price, command.quantity, command.time_in_force) :
+                        Order::limitAskOrder(command.order_id, command.symbol_id, command.price, command.quantity, command.time_in_force);
+                    market.addOrder(order);
+                    std::cout << "Accepted LIMIT_ORDER: " << command.order_id << std::endl;
+                } else {
+                    std::cout << "Rejected unsupported order type " << static_cast<int>(command.order_type) << " for order ID: " << command.order_id << std::endl;
+                    produce_rejection(main_producer.get(), outbound_topic, json{{"order_id", command.order_id}, {"instrument_id", command.symbol_id}},
+                        "Order type " + std::to_string(static_cast<int>(command.order_type)) + " not supported by match_engine.");
+                }
+            } else {
+                market.deleteOrder(command.symbol_id, command.order_id);
+                std::cout << "Processed CANCEL_ORDER: " << command.order_id << std::endl;
+            }
+            continue;
+        }
+
         std::string payload_str(static_cast<const char *>(msg->payload()), msg->len());
         try {
             json j = json::parse(payload_str);
@@ -124,5 +186,14 @@ int main(int argc, char **argv) {
     main_producer->flush(5000);
     consumer->close(); 
     std::cout << "\nEngine shutting down..." << std::endl;
+    for (size_t i = 0; i < publishers.size(); ++i) {
+        EventRingMetrics metrics = publishers[i]->getMetrics();
+        std::cout << "Event ring " << i << ": published " << metrics.published_events << ", occupancy " << metrics.occupancy << "/" << metrics.capacity
+                  << " (max " << metrics.max_occupancy << "), blocked " << metrics.blocked_events << ", overflowed " << metrics.overflowed_events
+                  << ", shed " << metrics.shed_events << std::endl;
+        BatchMetrics batch_metrics = batchers[i]->getMetrics();
+        std::cout << "Event batches " << i << ": batched " << batch_metrics.batched_events << ", produced " << batch_metrics.produced_messages
+                  << ", failed " << batch_metrics.failed_messages << std::endl;
+    }
     return 0;
 }
\ No newline at end of file
@@ -1,87 +1,216 @@
 // //match_engine/src/matching/market/concurrent_market.cpp
 #include "matching/market/concurrent_market.h"
+#include <algorithm>
 #include "matching/orderbook/map_orderbook.h"
 
 namespace RapidTrader {
-ConcurrentMarket::ConcurrentMarket(std::vector<std::unique_ptr<EventHandler>> &event_handlers, uint8_t num_threads)
-    : thread_pool(num_threads)
-    , symbol_submission_index(0)
-{
-    assert(num_threads > 0 && "The number of threads must be positive!");
-    assert(event_handlers.size() == num_threads && "The number of event handlers must be equal to the number of threads!");
-    orderbook_handlers.reserve(num_threads);
-    for (uint32_t i = 0; i < num_threads; ++i)
-        orderbook_handlers.push_back(std::make_unique<OrderBookHandler>(std::move(event_handlers[i])));
-}
-
-void ConcurrentMarket::addSymbol(uint32_t symbol_id, const std::string &symbol_name)
+void ConcurrentMarket::addSymbol(uint32_t symbol_id, const std::string &symbol_name, const OrderBookConfig &config)
 {
+    std::lock_guard<std::mutex> lk(routing_mutex);
     auto it = id_to_symbol.find(symbol_id);
     assert(it == id_to_symbol.end() && "Symbol already exists!");
     id_to_symbol.insert({symbol_id, std::make_unique<Symbol>(symbol_id, symbol_name)});
-    id_to_submission_index.insert({symbol_id, symbol_submission_index});
-    OrderBookHandler *orderbook_handler = orderbook_handlers[symbol_submission_index].get();
-    thread_pool.submitTask(symbol_submission_index, [=] { orderbook_handler->addOrderBook(symbol_id, symbol_name); });
+    std::atomic<uint64_t> *load = &id_to_load.emplace(symbol_id, 0).first->second;
+    uint32_t submission_index = symbol_submission_index;
+    // The orderbook is created before the symbol is routed, so that every order for the symbol is queued after it.
+    OrderBookHandler *orderbook_handler = orderbook_handlers[submission_index].get();
+    thread_pool.submit(submission_index, Command::callback([=] { orderbook_handler->addOrderBook(symbol_id, symbol_name, config); }));
+    routes.modify([&](RoutingTable &routing_table) { routing_table.insert({symbol_id, SymbolRoute{submission_index, false, load}}); });
     updateSymbolSubmissionIndex();
 }
 
 void ConcurrentMarket::deleteSymbol(uint32_t symbol_id)
 {
+    std::lock_guard<std::mutex> lk(routing_mutex);
     auto it = id_to_symbol.find(symbol_id);
     assert(it != id_to_symbol.end() && "Symbol does not exist!");
-    uint32_t submission_index = getSubmissionIndex(symbol_id);
-    OrderBookHandler *orderbook_handler = orderbook_handlers[symbol_submission_index].get();
-    thread_pool.submitTask(submission_index, [=] { orderbook_handler->deleteOrderBook(symbol_id, it->second->name); });
+    uint32_t submission_index = routes.read()->at(symbol_id).submission_index;
+    // Once the route is removed, every order that was routed to the symbol has been queued before the deletion.
+    routes.modify([&](RoutingTable &routing_table) { routing_table.erase(symbol_id); });
+    OrderBookHandler *orderbook_handler = orderbook_handlers[submission_index].get();
+    thread_pool.submit(submission_index, Command::callback([=, symbol_name = it->second->name] { orderbook_handler->deleteOrderBook(symbol_id, symbol_name); }));
     id_to_symbol.erase(symbol_id);
-    id_to_submission_index.erase(symbol_id);
+    id_to_load.erase(symbol_id);
 }
 
 void ConcurrentMarket::addOrder(const Order &order)
 {
-    uint32_t submission_index = getSubmissionIndex(order.getSymbolID());
-    OrderBookHandler *orderbook_handler = orderbook_handlers[submission_index].get();
-    thread_pool.submitTask(submission_index, [=] { orderbook_handler->addOrder(order); });
+    submitCommand(Command::addOrder(nullptr, order));
 }
 
 void ConcurrentMarket::deleteOrder(uint32_t symbol_id, uint64_t order_id)
 {
-    uint32_t submission_index = getSubmissionIndex(symbol_id);
-    OrderBookHandler *orderbook_handler = orderbook_handlers[submission_index].get();
-    thread_pool.submitTask(submission_index, [=] { orderbook_handler->deleteOrder(symbol_id, order_id); });
+    submitCommand(Command::deleteOrder(nullptr, symbol_id, order_id));
 }
 
 void ConcurrentMarket::cancelOrder(uint32_t symbol_id, uint64_t order_id, uint64_t cancelled_quantity)
 {
-    uint32_t submission_index = getSubmissionIndex(symbol_id);
-    OrderBookHandler *orderbook_handler = orderbook_handlers[submission_index].get();
-    thread_pool.submitTask(submission_index, [=] { orderbook_handler->cancelOrder(symbol_id, order_id, cancelled_quantity); });
+    submitCommand(Command::cancelOrder(nullptr, symbol_id, order_id, cancelled_quantity));
 }
 
 void ConcurrentMarket::replaceOrder(uint32_t symbol_id, uint64_t order_id, uint64_t new_order_id, uint64_t new_price)
 {
-    uint32_t submission_index = getSubmissionIndex(symbol_id);
-    OrderBookHandler *orderbook_handler = orderbook_handlers[submission_index].get();
-    thread_pool.submitTask(submission_index, [=] { orderbook_handler->replaceOrder(symbol_id, order_id, new_order_id, new_price); });
+    submitCommand(Command::replaceOrder(nullptr, symbol_id, order_id, new_order_id, new_price));
 }
 
 void ConcurrentMarket::executeOrder(uint32_t symbol_id, uint64_t order_id, uint64_t quantity, uint64_t price)
 {
-    uint32_t submission_index = getSubmissionIndex(symbol_id);
-    OrderBookHandler *orderbook_handler = orderbook_handlers[submission_index].get();
-    thread_pool.submitTask(submission_index, [=] { orderbook_handler->executeOrder(symbol_id, order_id, quantity, price); });
+    submitCommand(Command::executeOrder(nullptr, symbol_id, order_id, quantity, price));
 }
 
 void ConcurrentMarket::executeOrder(uint32_t symbol_id, uint64_t order_id, uint64_t quantity)
 {
-    uint32_t submission_index = getSubmissionIndex(symbol_id);
-    OrderBookHandler *orderbook_handler = orderbook_handlers[submission_index].get();
-    thread_pool.submitTask(submission_index, [=] { orderbook_handler->executeOrder(symbol_id, order_id, quantity); });
+    submitCommand(Command::executeOrder(nullptr, symbol_id, order_id, quantity));
+}
+
+void ConcurrentMarket::submitBatch(const Command *commands, size_t num_commands)
+{
+    // Each submitting thread groups its batches in its own buffers, which are kept between
+    // batches so that submitting a batch does not allocate once the groups have grown.
+    static thread_local std::vector<std::vector<Command>> batch_groups;
+    batch_groups.resize(orderbook_handlers.size());
+    size_t i = 0;
+    while (i < num_commands)
+    {
+        {
+            auto routing_table = routes.read();
+            uint32_t submission_index;
+            for (; i < num_commands && getSubmissionIndex(*routing_table, commands[i].symbol_id, submission_index); ++i)
+            {
+                assert(commands[i].type != CommandType::Callback && "Batches must only contain order commands!");
+                Command &command = batch_groups[submission_index].emplace_back(commands[i]);
+                command.orderbook_handler = orderbook_handlers[submission_index].get();
+            }
+            for (uint32_t j = 0; j < batch_groups.size(); ++j)
+            {
+                if (batch_groups[j].empty())
+                    continue;
+                thread_pool.submitBatch(j, batch_groups[j].data(), batch_groups[j].size());
+                batch_groups[j].clear();
+            }
+        }
+        // The next command is for a migrating symbol. Wait outside of the read-side critical
+        // section, the migration cannot complete until the critical section ends.
+        if (i < num_commands)
+            std::this_thread::yield();
+    }
+}
+
+void ConcurrentMarket::migrateSymbol(uint32_t symbol_id, uint32_t worker_index)
+{
+    std::lock_guard<std::mutex> lk(routing_mutex);
+    moveSymbol(symbol_id, worker_index);
+}
+
+void ConcurrentMarket::rebalance()
+{
+    std::lock_guard<std::mutex> lk(routing_mutex);
+    std::vector<uint64_t> worker_loads(orderbook_handlers.size(), 0);
+    std::vector<std::pair<uint32_t, SymbolRoute>> symbol_routes;
+    {
+        auto routing_table = routes.read();
+        for (const auto &[symbol_id, route] : *routing_table)
+            symbol_routes.emplace_back(symbol_id, route);
+    }
+    for (const auto &[symbol_id, route] : symbol_routes)
+        worker_loads[route.submission_index] += route.load->load(std::memory_order_relaxed);
+    auto busiest = static_cast<uint32_t>(std::max_element(worker_loads.begin(), worker_loads.end()) - worker_loads.begin());
+    auto idlest = static_cast<uint32_t>(std::min_element(worker_loads.begin(), worker_loads.end()) - worker_loads.begin());
+    uint64_t imbalance = worker_loads[busiest] - worker_loads[idlest];
+    // Moving a symbol with load l changes the imbalance to |imbalance - 2l|, so the best
+    // candidate is the symbol on the busiest worker whose load is closest to half of the imbalance.
+    uint32_t candidate_id = 0;
+    uint64_t best_imbalance = imbalance;
+    for (const auto &[symbol_id, route] : symbol_routes)
+    {
+        uint64_t load = route.load->load(std::memory_order_relaxed);
+        if (route.submission_index != busiest || load == 0 || load >= imbalance)
+            continue;
+        uint64_t new_imbalance = imbalance > 2 * load ? imbalance - 2 * load : 2 * load - imbalance;
+        if (new_imbalance < best_imbalance)
+        {
+            best_imbalance = new_imbalance;
+            candidate_id = symbol_id;
+        }
+    }
+    if (best_imbalance < imbalance)
+        moveSymbol(candidate_id, idlest);
+    for (auto &[symbol_id, load] : id_to_load)
+        load.fetch_sub(load.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+}
+
+uint32_t ConcurrentMarket::getWorkerIndex(uint32_t symbol_id) const
+{
+    auto routing_table = routes.read();
+    auto it = routing_table->find(symbol_id);
+    assert(it != routing_table->end() && "Symbol does not exist!");
+    return it->second.submission_index;
+}
+
+bool ConcurrentMarket::getSubmissionIndex(const RoutingTable &routing_table, uint32_t symbol_id, uint32_t &submission_index)
+{
+    auto it = routing_table.find(symbol_id);
+    if (it == routing_table.end())
+    {
+        submission_index = 0;
+        return true;
+    }
+    if (it->second.migrating)
+        return false;
+    it->second.load->fetch_add(1, std::memory_order_relaxed);
+    submission_index = it->second.submission_index;
+    return true;
+}
+
+void ConcurrentMarket::submitCommand(Command command)
+{
+    while (true)
+    {
+        {
+            auto routing_table = routes.read();
+            uint32_t submission_index;
+            if (getSubmissionIndex(*routing_table, command.symbol_id, submission_index))
+            {
+                command.orderbook_handler = orderbook_handlers[submission_index].get();
+                thread_pool.submit(submission_index, command);
+                return;
+            }
+        }
+        // The symbol is migrating. Wait outside of the read-side critical section,
+        // the migration cannot complete until the critical section ends.
+        std::this_thread::yield();
+    }
 }
 
-uint32_t ConcurrentMarket::getSubmissionIndex(uint32_t symbol_id)
+void ConcurrentMarket::moveSymbol(uint32_t symbol_id, uint32_t worker_index)
 {
-    auto it = id_to_submission_index.find(symbol_id);
-    return it == id_to_submission_index.end() ? 0 : it->second;
+    assert(worker_index < orderbook_handlers.size() && "Worker index is out of range!");
+    assert(id_to_symbol.find(symbol_id) != id_to_symbol.end() && "Symbol does not exist!");
+    uint32_t submission_index = routes.read()->at(symbol_id).submission_index;
+    if (submission_index == worker_index)
+        return;
+    // Hold back new commands for the symbol. Once the table is replaced, every command that
+    // was routed to the old worker has been queued, so the old worker releases the book
+    // after it has processed all of them.
+    routes.modify([&](RoutingTable &routing_table) { routing_table.at(symbol_id).migrating = true; });
+    auto released = std::make_shared<std::promise<void>>();
+    std::future<void> release_future = released->get_future();
+    OrderBookHandler *source_handler = orderbook_handlers[submission_index].get();
+    OrderBookHandler *target_handler = orderbook_handlers[worker_index].get();
+    // The old worker hands the book to the new worker once it has processed every command
+    // routed to it, so the new worker never waits for the book. Commands for the symbol are
+    // held back until the route changes below, so they are queued behind the adopt.
+    thread_pool.submit(submission_index, Command::callback([=] {
+        auto orderbook = std::make_shared<std::unique_ptr<OrderBook>>(source_handler->releaseOrderBook(symbol_id));
+        thread_pool.submit(worker_index, Command::callback([=] { target_handler->adoptOrderBook(std::move(*orderbook)); }));
+        released->set_value();
+    }));
+    release_future.get();
+    routes.modify([&](RoutingTable &routing_table) {
+        SymbolRoute &route = routing_table.at(symbol_id);
+        route.submission_index = worker_index;
+        route.migrating = false;
+    });
 }
 
 void ConcurrentMarket::updateSymbolSubmissionIndex()
@@ -96,7 +225,9 @@ std::string ConcurrentMarket::toString()
     for (uint32_t i = 0; i < futures.size(); ++i)
     {
         OrderBookHandler *orderbook_handler = orderbook_handlers[i].get();
-        futures[i] = thread_pool.submitWaitableTask(i, [=] { return orderbook_handler->toString(); });
+        auto promise = std::make_shared<std::promise<std::string>>();
+        futures[i] = promise->get_future();
+        thread_pool.submit(i, Command::callback([=] { promise->set_value(orderbook_handler->toString()); }));
     }
     for (auto &future : futures)
         market_string += future.get();
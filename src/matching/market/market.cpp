@@ -1,101 +1,92 @@
 // //match_engine/src/matching/market/market.cpp
 #include "matching/market/market.h"
-#include "matching/orderbook/map_orderbook.h"
+#include "matching/market/command.h"
 
 namespace RapidTrader {
-OrderBookHandler::OrderBookHandler(std::unique_ptr<EventHandler> event_handler_)
-    : event_handler(std::move(event_handler_))
-{}
 
-void OrderBookHandler::addOrderBook(uint32_t symbol_id, std::string symbol_name)
+void OrderBookHandler::addOrderBook(uint32_t symbol_id, std::string symbol_name, const OrderBookConfig &config)
 {
-    auto it = id_to_book.find(symbol_id);
-    assert(it == id_to_book.end() && "Symbol already exists!");
-    id_to_book.insert({symbol_id, std::make_unique<MapOrderBook>(symbol_id, *event_handler)});
+    id_to_book.insert(symbol_id, make_orderbook(symbol_id, *event_handler, config));
     event_handler->handleSymbolAdded(SymbolAdded{symbol_id, std::move(symbol_name)});
 }
 
 void OrderBookHandler::deleteOrderBook(uint32_t symbol_id, std::string symbol_name)
 {
-    auto it = id_to_book.find(symbol_id);
-    assert(it != id_to_book.end() && "Symbol does not exist!");
-    id_to_book.erase(it);
+    id_to_book.remove(symbol_id);
     event_handler->handleSymbolDeleted(SymbolDeleted{symbol_id, std::move(symbol_name)});
 }
 
+std::unique_ptr<OrderBook> OrderBookHandler::releaseOrderBook(uint32_t symbol_id)
+{
+    return id_to_book.remove(symbol_id);
+}
+
+void OrderBookHandler::adoptOrderBook(std::unique_ptr<OrderBook> orderbook)
+{
+    uint32_t symbol_id = orderbook->getSymbolID();
+    orderbook->setEventHandler(*event_handler);
+    id_to_book.insert(symbol_id, std::move(orderbook));
+}
+
 void OrderBookHandler::addOrder(const Order &order)
 {
-    auto it = id_to_book.find(order.getSymbolID());
-    assert(it != id_to_book.end() && "Symbol does not exist!");
-    OrderBook *book = it->second.get();
+    OrderBook *book = id_to_book.find(order.getSymbolID());
+    assert(book && "Symbol does not exist!");
     book->addOrder(order);
 }
 
 void OrderBookHandler::deleteOrder(uint32_t symbol_id, uint64_t order_id)
 {
-    auto it = id_to_book.find(symbol_id);
-    assert(it != id_to_book.end() && "Symbol does not exist!");
-    OrderBook *book = it->second.get();
+    OrderBook *book = id_to_book.find(symbol_id);
+    assert(book && "Symbol does not exist!");
     book->deleteOrder(order_id);
 }
 
 void OrderBookHandler::cancelOrder(uint32_t symbol_id, uint64_t order_id, uint64_t cancelled_quantity)
 {
-    auto it = id_to_book.find(symbol_id);
-    assert(it != id_to_book.end() && "Symbol does not exist!");
+    OrderBook *book = id_to_book.find(symbol_id);
+    assert(book && "Symbol does not exist!");
     assert(cancelled_quantity > 0 && "Cancelled quantity must be positive!");
-    OrderBook *book = it->second.get();
     book->cancelOrder(order_id, cancelled_quantity);
 }
 
 void OrderBookHandler::replaceOrder(uint32_t symbol_id, uint64_t order_id, uint64_t new_order_id, uint64_t new_price)
 {
-    auto it = id_to_book.find(symbol_id);
-    assert(it != id_to_book.end() && "Symbol does not exist!");
+    OrderBook *book = id_to_book.find(symbol_id);
+    assert(book && "Symbol does not exist!");
     assert(new_order_id > 0 && "Order ID must be positive!");
     assert(new_price > 0 && "Price must be positive!");
-    OrderBook *book = it->second.get();
     book->replaceOrder(order_id, new_order_id, new_price);
 }
 
 void OrderBookHandler::executeOrder(uint32_t symbol_id, uint64_t order_id, uint64_t quantity, uint64_t price)
 {
-    auto it = id_to_book.find(symbol_id);
-    assert(it != id_to_book.end() && "Symbol does not exist!");
+    OrderBook *book = id_to_book.find(symbol_id);
+    assert(book && "Symbol does not exist!");
     assert(quantity > 0 && "Quantity must be positive!");
     assert(price > 0 && "Price must be positive!");
-    OrderBook *book = it->second.get();
     book->executeOrder(order_id, quantity, price);
 }
 void OrderBookHandler::executeOrder(uint32_t symbol_id, uint64_t order_id, uint64_t quantity)
 {
-    auto it = id_to_book.find(symbol_id);
-    assert(it != id_to_book.end() && "Symbol does not exist!");
+    OrderBook *book = id_to_book.find(symbol_id);
+    assert(book && "Symbol does not exist!");
     assert(order_id > 0 && "Order ID must be positive!");
     assert(quantity > 0 && "Quantity must be positive!");
-    OrderBook *book = it->second.get();
     book->executeOrder(order_id, quantity);
 }
 
 std::string OrderBookHandler::toString()
 {
     std::string book_handler_string;
-    for (const auto &[symbol_id, book_ptr] : id_to_book)
-    {
-        if (book_ptr)
-            book_handler_string += book_ptr->toString() + "\n";
-    }
+    id_to_book.forEach([&](uint32_t, const OrderBook &book) { book_handler_string += book.toString() + "\n"; });
     return book_handler_string;
 }
 
-Market::Market(std::unique_ptr<EventHandler> event_handler)
-    : orderbook_handler(std::make_unique<OrderBookHandler>(std::move(event_handler)))
-{}
-
-void Market::addSymbol(uint32_t symbol_id, const std::string &symbol_name)
+void Market::addSymbol(uint32_t symbol_id, const std::string &symbol_name, const OrderBookConfig &config)
 {
     id_to_symbol.insert({symbol_id, std::make_unique<Symbol>(symbol_id, symbol_name)});
-    orderbook_handler->addOrderBook(symbol_id, symbol_name);
+    orderbook_handler->addOrderBook(symbol_id, symbol_name, config);
 }
 
 void Market::deleteSymbol(uint32_t symbol_id)
@@ -140,6 +131,17 @@ void Market::executeOrder(uint32_t symbol_id, uint64_t order_id, uint64_t quanti
     orderbook_handler->executeOrder(symbol_id, order_id, quantity);
 }
 
+void Market::submitBatch(const Command *commands, size_t num_commands)
+{
+    for (size_t i = 0; i < num_commands; ++i)
+    {
+        assert(commands[i].type != CommandType::Callback && "Batches must only contain order commands!");
+        Command command = commands[i];
+        command.orderbook_handler = orderbook_handler.get();
+        command();
+    }
+}
+
 // LCOV_EXCL_START
 std::string Market::toString() const
 {
@@ -0,0 +1,7 @@
+// //match_engine/src/matching/orderbook/array_orderbook.cpp
+#include "matching/orderbook/array_orderbook_impl.h"
+
+namespace RapidTrader {
+template class BasicArrayOrderBook<EventHandler>;
+template class BasicArrayOrderBook<NullEventHandler>;
+} // namespace RapidTrader
@@ -3,7 +3,8 @@
 #include "matching/orderbook/level.h"
 
 namespace RapidTrader {
-Level::Level(uint64_t price_, LevelSide side_, uint32_t symbol_id_)
+template<typename Price, typename Quantity>
+BasicLevel<Price, Quantity>::BasicLevel(uint64_t price_, LevelSide side_, uint32_t symbol_id_)
     : price(price_)
     , side(side_)
     , symbol_id(symbol_id_)
@@ -11,17 +12,20 @@ Level::Level(uint64_t price_, LevelSide side_, uint32_t symbol_id_)
     volume = 0;
 }
 
-const list<Order> &Level::getOrders() const
+template<typename Price, typename Quantity>
+const list<typename BasicLevel<Price, Quantity>::LevelOrder> &BasicLevel<Price, Quantity>::getOrders() const
 {
     return orders;
 }
 
-list<Order> &Level::getOrders()
+template<typename Price, typename Quantity>
+list<typename BasicLevel<Price, Quantity>::LevelOrder> &BasicLevel<Price, Quantity>::getOrders()
 {
     return orders;
 }
 
-void Level::addOrder(Order &order)
+template<typename Price, typename Quantity>
+void BasicLevel<Price, Quantity>::addOrder(LevelOrder &order)
 {
     assert(order.isAsk() ? side == LevelSide::Ask : side == LevelSide::Bid && "Order is on different side than level!");
     assert(order.getSymbolID() == symbol_id && "Order does not have the same symbol ID as the level!");
@@ -30,78 +34,84 @@ void Level::addOrder(Order &order)
     VALIDATE_LEVEL;
 }
 
-void Level::popFront()
+template<typename Price, typename Quantity>
+void BasicLevel<Price, Quantity>::popFront()
 {
     assert(!orders.empty() && "Cannot pop from empty level!");
-    Order &order_to_remove = orders.front();
+    LevelOrder &order_to_remove = orders.front();
     volume -= order_to_remove.getOpenQuantity();
     orders.pop_front();
     VALIDATE_LEVEL;
 };
 
-void Level::popBack()
+template<typename Price, typename Quantity>
+void BasicLevel<Price, Quantity>::popBack()
 {
     assert(!orders.empty() && "Cannot pop from empty level!");
-    Order &order_to_remove = orders.back();
+    LevelOrder &order_to_remove = orders.back();
     volume -= order_to_remove.getOpenQuantity();
     orders.pop_back();
     VALIDATE_LEVEL;
 }
 
-void Level::deleteOrder(const Order &order)
+template<typename Price, typename Quantity>
+void BasicLevel<Price, Quantity>::deleteOrder(const LevelOrder &order)
 {
     volume -= order.getOpenQuantity();
-    orders.erase(boost::intrusive::list<Order>::s_iterator_to(order));
+    orders.erase(list<LevelOrder>::s_iterator_to(order));
     VALIDATE_LEVEL;
 }
 
-void Level::reduceVolume(uint64_t amount)
+template<typename Price, typename Quantity>
+void BasicLevel<Price, Quantity>::reduceVolume(uint64_t amount)
 {
     assert(volume >= amount && "Cannot reduce level volume by amount greater than its current volume!");
     volume -= amount;
     VALIDATE_LEVEL;
 }
 
-Order &Level::front()
+template<typename Price, typename Quantity>
+typename BasicLevel<Price, Quantity>::LevelOrder &BasicLevel<Price, Quantity>::front()
 {
     assert(!orders.empty() && "Level is empty!");
     return orders.front();
 }
 
-Order &Level::back()
+template<typename Price, typename Quantity>
+typename BasicLevel<Price, Quantity>::LevelOrder &BasicLevel<Price, Quantity>::back()
 {
     assert(!orders.empty() && "Level is empty!");
     return orders.back();
 }
 
 // LCOV_EXCL_START
-std::string Level::toString() const
+template<typename Price, typename Quantity>
+std::string BasicLevel<Price, Quantity>::toString() const
 {
     std::string level_string;
     level_string += std::to_string(price) + " X " + std::to_string(volume) + "\n";
     return level_string;
 }
 
-std::ostream &operator<<(std::ostream &os, const Level &level)
-{
-    os << level.toString();
-    return os;
-}
-
-void Level::validateLevel() const
+template<typename Price, typename Quantity>
+void BasicLevel<Price, Quantity>::validateLevel() const
 {
     uint64_t actual_volume = 0;
     for (const auto &order : orders)
     {
         assert(side == LevelSide::Ask ? order.isAsk() : order.isBid() && "Order side does not match level side!");
-        if (order.isStop() || order.isStopLimit() || order.isTrailingStop() || order.isTrailingStopLimit())
+        if (order.isStop() || order.isStopLimit())
             assert(order.getStopPrice() == price && "Order stop price does not match price of the level!");
-        else
+        // Trailing stop levels are keyed by offset from a reference price that only the book knows.
+        else if (!order.isTrailingStop() && !order.isTrailingStopLimit())
             assert(order.getPrice() == price && "Order price does not match price of the level!");
         assert(!order.isMarket() && "Level should never contain market orders!");
         actual_volume += order.getOpenQuantity();
     }
     assert(actual_volume == volume && "Level has incorrect volume!");
 }
+
+template class BasicLevel<uint64_t, uint64_t>;
+template class BasicLevel<uint32_t, uint32_t>;
 } // namespace RapidTrader
 // LCOV_EXCL_STOP
\ No newline at end of file
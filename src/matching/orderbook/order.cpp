@@ -3,83 +3,90 @@
 #include "matching/orderbook/order.h"
 
 namespace RapidTrader {
-Order::Order(OrderType type_, OrderSide side_, OrderTimeInForce time_in_force_, uint32_t symbol_id_, uint64_t price_, uint64_t stop_price_,
+template<typename Price, typename Quantity>
+BasicOrder<Price, Quantity>::BasicOrder(OrderType type_, OrderSide side_, OrderTimeInForce time_in_force_, uint32_t symbol_id_, uint64_t price_, uint64_t stop_price_,
     uint64_t trail_amount_, uint64_t quantity_, uint64_t id_)
-    : type(type_)
+    : id(id_)
+    , open_quantity(convertQuantity<Quantity>(quantity_))
+    , price(convertPrice<Price>(price_))
     , side(side_)
+    , type(type_)
     , time_in_force(time_in_force_)
     , symbol_id(symbol_id_)
-    , price(price_)
-    , stop_price(stop_price_)
-    , trail_amount(trail_amount_)
-    , quantity(quantity_)
-    , id(id_)
-{
-    last_executed_price = 0;
-    executed_quantity = 0;
-    open_quantity = quantity;
-    last_executed_price = 0;
-    last_executed_quantity = 0;
+    , quantity(convertQuantity<Quantity>(quantity_))
+    , executed_quantity(0)
+    , last_executed_price(0)
+    , last_executed_quantity(0)
+    , stop_price(convertPrice<Price>(stop_price_))
+    , trail_amount(convertPrice<Price>(trail_amount_))
+{
     VALIDATE_ORDER;
 }
 
-Order Order::marketAskOrder(uint64_t order_id, uint32_t symbol_id, uint64_t quantity, OrderTimeInForce time_in_force)
+template<typename Price, typename Quantity>
+BasicOrder<Price, Quantity> BasicOrder<Price, Quantity>::marketAskOrder(uint64_t order_id, uint32_t symbol_id, uint64_t quantity, OrderTimeInForce time_in_force)
 {
     assert(time_in_force != OrderTimeInForce::GTC && "Market orders cannot gave GTC time in force!");
     assert(order_id > 0 && "Order ID must be positive!");
     assert(symbol_id > 0 && "Symbol ID must be positive!");
     assert(quantity > 0 && "Quantity must be positive!");
-    return Order{OrderType::Market, OrderSide::Ask, time_in_force, symbol_id, 0, 0, 0, quantity, order_id};
+    return BasicOrder{OrderType::Market, OrderSide::Ask, time_in_force, symbol_id, 0, 0, 0, quantity, order_id};
 }
 
-Order Order::marketBidOrder(uint64_t order_id, uint32_t symbol_id, uint64_t quantity, OrderTimeInForce time_in_force)
+template<typename Price, typename Quantity>
+BasicOrder<Price, Quantity> BasicOrder<Price, Quantity>::marketBidOrder(uint64_t order_id, uint32_t symbol_id, uint64_t quantity, OrderTimeInForce time_in_force)
 {
     assert(time_in_force != OrderTimeInForce::GTC && "Market orders cannot gave GTC time in force!");
     assert(order_id > 0 && "Order ID must be positive!");
     assert(symbol_id > 0 && "Symbol ID must be positive!");
     assert(quantity > 0 && "Quantity must be positive!");
-    return Order{OrderType::Market, OrderSide::Bid, time_in_force, symbol_id, 0, 0, 0, quantity, order_id};
+    return BasicOrder{OrderType::Market, OrderSide::Bid, time_in_force, symbol_id, 0, 0, 0, quantity, order_id};
 }
 
-Order Order::limitAskOrder(uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t quantity, OrderTimeInForce time_in_force)
+template<typename Price, typename Quantity>
+BasicOrder<Price, Quantity> BasicOrder<Price, Quantity>::limitAskOrder(uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t quantity, OrderTimeInForce time_in_force)
 {
     assert(order_id > 0 && "Order ID must be positive!");
     assert(symbol_id > 0 && "Symbol ID must be positive!");
     assert(price > 0 && "Price must be positive!");
     assert(quantity > 0 && "Quantity must be positive!");
-    return Order{OrderType::Limit, OrderSide::Ask, time_in_force, symbol_id, price, 0, 0, quantity, order_id};
+    return BasicOrder{OrderType::Limit, OrderSide::Ask, time_in_force, symbol_id, price, 0, 0, quantity, order_id};
 }
 
-Order Order::limitBidOrder(uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t quantity, OrderTimeInForce time_in_force)
+template<typename Price, typename Quantity>
+BasicOrder<Price, Quantity> BasicOrder<Price, Quantity>::limitBidOrder(uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t quantity, OrderTimeInForce time_in_force)
 {
     assert(order_id > 0 && "Order ID must be positive!");
     assert(symbol_id > 0 && "Symbol ID must be positive!");
     assert(price > 0 && "Price must be positive!");
     assert(quantity > 0 && "Quantity must be positive!");
-    return Order{OrderType::Limit, OrderSide::Bid, time_in_force, symbol_id, price, 0, 0, quantity, order_id};
+    return BasicOrder{OrderType::Limit, OrderSide::Bid, time_in_force, symbol_id, price, 0, 0, quantity, order_id};
 }
 
-Order Order::stopAskOrder(uint64_t order_id, uint32_t symbol_id, uint64_t stop_price, uint64_t quantity, OrderTimeInForce time_in_force)
+template<typename Price, typename Quantity>
+BasicOrder<Price, Quantity> BasicOrder<Price, Quantity>::stopAskOrder(uint64_t order_id, uint32_t symbol_id, uint64_t stop_price, uint64_t quantity, OrderTimeInForce time_in_force)
 {
     assert(time_in_force != OrderTimeInForce::GTC && "Stop orders cannot gave GTC time in force!");
     assert(order_id > 0 && "Order ID must be positive!");
     assert(symbol_id > 0 && "Symbol ID must be positive!");
     assert(stop_price > 0 && "Price must be positive!");
     assert(quantity > 0 && "Quantity must be positive!");
-    return Order{OrderType::Stop, OrderSide::Ask, time_in_force, symbol_id, 0, stop_price, 0, quantity, order_id};
+    return BasicOrder{OrderType::Stop, OrderSide::Ask, time_in_force, symbol_id, 0, stop_price, 0, quantity, order_id};
 }
 
-Order Order::stopBidOrder(uint64_t order_id, uint32_t symbol_id, uint64_t stop_price, uint64_t quantity, OrderTimeInForce time_in_force)
+template<typename Price, typename Quantity>
+BasicOrder<Price, Quantity> BasicOrder<Price, Quantity>::stopBidOrder(uint64_t order_id, uint32_t symbol_id, uint64_t stop_price, uint64_t quantity, OrderTimeInForce time_in_force)
 {
     assert(time_in_force != OrderTimeInForce::GTC && "Stop orders cannot gave GTC time in force!");
     assert(order_id > 0 && "Order ID must be positive!");
     assert(symbol_id > 0 && "Symbol ID must be positive!");
     assert(stop_price > 0 && "Stop Price must be positive!");
     assert(quantity > 0 && "Quantity must be positive!");
-    return Order{OrderType::Stop, OrderSide::Bid, time_in_force, symbol_id, 0, stop_price, 0, quantity, order_id};
+    return BasicOrder{OrderType::Stop, OrderSide::Bid, time_in_force, symbol_id, 0, stop_price, 0, quantity, order_id};
 }
 
-Order Order::stopLimitAskOrder(
+template<typename Price, typename Quantity>
+BasicOrder<Price, Quantity> BasicOrder<Price, Quantity>::stopLimitAskOrder(
     uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t stop_price, uint64_t quantity, OrderTimeInForce time_in_force)
 {
     assert(order_id > 0 && "Order ID must be positive!");
@@ -87,10 +94,11 @@ Order Order::stopLimitAskOrder(
     assert(price > 0 && "Price must be positive!");
     assert(stop_price > 0 && "Stop Price must be positive!");
     assert(quantity > 0 && "Quantity must be positive!");
-    return Order{OrderType::StopLimit, OrderSide::Ask, time_in_force, symbol_id, price, stop_price, 0, quantity, order_id};
+    return BasicOrder{OrderType::StopLimit, OrderSide::Ask, time_in_force, symbol_id, price, stop_price, 0, quantity, order_id};
 }
 
-Order Order::stopLimitBidOrder(
+template<typename Price, typename Quantity>
+BasicOrder<Price, Quantity> BasicOrder<Price, Quantity>::stopLimitBidOrder(
     uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t stop_price, uint64_t quantity, OrderTimeInForce time_in_force)
 {
     assert(order_id > 0 && "Order ID must be positive!");
@@ -98,10 +106,11 @@ Order Order::stopLimitBidOrder(
     assert(price > 0 && "Price must be positive!");
     assert(stop_price > 0 && "Stop Price must be positive!");
     assert(quantity > 0 && "Quantity must be positive!");
-    return Order{OrderType::StopLimit, OrderSide::Bid, time_in_force, symbol_id, price, stop_price, 0, quantity, order_id};
+    return BasicOrder{OrderType::StopLimit, OrderSide::Bid, time_in_force, symbol_id, price, stop_price, 0, quantity, order_id};
 }
 
-Order Order::trailingStopAskOrder(
+template<typename Price, typename Quantity>
+BasicOrder<Price, Quantity> BasicOrder<Price, Quantity>::trailingStopAskOrder(
     uint64_t order_id, uint32_t symbol_id, uint64_t trail_amount, uint64_t quantity, OrderTimeInForce time_in_force)
 {
     assert(time_in_force != OrderTimeInForce::GTC && "Stop orders cannot gave GTC time in force!");
@@ -109,10 +118,11 @@ Order Order::trailingStopAskOrder(
     assert(symbol_id > 0 && "Symbol ID must be positive!");
     assert(trail_amount > 0 && "Stop Price must be positive!");
     assert(quantity > 0 && "Quantity must be positive!");
-    return Order{OrderType::TrailingStop, OrderSide::Ask, time_in_force, symbol_id, 0, 0, trail_amount, quantity, order_id};
+    return BasicOrder{OrderType::TrailingStop, OrderSide::Ask, time_in_force, symbol_id, 0, 0, trail_amount, quantity, order_id};
 }
 
-Order Order::trailingStopBidOrder(
+template<typename Price, typename Quantity>
+BasicOrder<Price, Quantity> BasicOrder<Price, Quantity>::trailingStopBidOrder(
     uint64_t order_id, uint32_t symbol_id, uint64_t trail_amount, uint64_t quantity, OrderTimeInForce time_in_force)
 {
     assert(time_in_force != OrderTimeInForce::GTC && "Stop orders cannot gave GTC time in force!");
@@ -120,10 +130,11 @@ Order Order::trailingStopBidOrder(
     assert(symbol_id > 0 && "Symbol ID must be positive!");
     assert(trail_amount > 0 && "Stop Price must be positive!");
     assert(quantity > 0 && "Quantity must be positive!");
-    return Order{OrderType::TrailingStop, OrderSide::Bid, time_in_force, symbol_id, 0, 0, trail_amount, quantity, order_id};
+    return BasicOrder{OrderType::TrailingStop, OrderSide::Bid, time_in_force, symbol_id, 0, 0, trail_amount, quantity, order_id};
 }
 
-Order Order::trailingStopLimitAskOrder(
+template<typename Price, typename Quantity>
+BasicOrder<Price, Quantity> BasicOrder<Price, Quantity>::trailingStopLimitAskOrder(
     uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t trail_amount, uint64_t quantity, OrderTimeInForce time_in_force)
 {
     assert(order_id > 0 && "Order ID must be positive!");
@@ -131,10 +142,11 @@ Order Order::trailingStopLimitAskOrder(
     assert(price > 0 && "Price must be positive!");
     assert(trail_amount > 0 && "Trail amount must be positive!");
     assert(quantity > 0 && "Quantity must be positive!");
-    return Order{OrderType::TrailingStopLimit, OrderSide::Ask, time_in_force, symbol_id, price, 0, trail_amount, quantity, order_id};
+    return BasicOrder{OrderType::TrailingStopLimit, OrderSide::Ask, time_in_force, symbol_id, price, 0, trail_amount, quantity, order_id};
 }
 
-Order Order::trailingStopLimitBidOrder(
+template<typename Price, typename Quantity>
+BasicOrder<Price, Quantity> BasicOrder<Price, Quantity>::trailingStopLimitBidOrder(
     uint64_t order_id, uint32_t symbol_id, uint64_t price, uint64_t trail_amount, uint64_t quantity, OrderTimeInForce time_in_force)
 {
     assert(order_id > 0 && "Order ID must be positive!");
@@ -142,7 +154,7 @@ Order Order::trailingStopLimitBidOrder(
     assert(price > 0 && "Price must be positive!");
     assert(trail_amount > 0 && "Trail amount must be positive!");
     assert(quantity > 0 && "Quantity must be positive!");
-    return Order{OrderType::TrailingStopLimit, OrderSide::Bid, time_in_force, symbol_id, price, 0, trail_amount, quantity, order_id};
+    return BasicOrder{OrderType::TrailingStopLimit, OrderSide::Bid, time_in_force, symbol_id, price, 0, trail_amount, quantity, order_id};
 }
 
 // LCOV_EXCL_START
@@ -198,7 +210,8 @@ static std::string timeInForceToString(OrderTimeInForce tof)
     return "";
 }
 
-std::string Order::toString() const
+template<typename Price, typename Quantity>
+std::string BasicOrder<Price, Quantity>::toString() const
 {
     std::string order_string;
     order_string += "Symbol ID: " + std::to_string(symbol_id) + "\n";
@@ -212,13 +225,8 @@ std::string Order::toString() const
     return order_string;
 }
 
-std::ostream &operator<<(std::ostream &os, const Order &order)
-{
-    os << order.toString();
-    return os;
-}
-
-void Order::validateOrder() const
+template<typename Price, typename Quantity>
+void BasicOrder<Price, Quantity>::validateOrder() const
 {
     // Price should always be positive for limit, stop limit, and trailing stop limit orders.
     if (type == OrderType::Limit || type == OrderType::StopLimit || type == OrderType::TrailingStopLimit)
@@ -234,5 +242,8 @@ void Order::validateOrder() const
     // All orders must have a positive ID.
     assert(id > 0 && "Order ID must be positive!");
 }
+
+template struct BasicOrder<uint64_t, uint64_t>;
+template struct BasicOrder<uint32_t, uint32_t>;
 } // namespace RapidTrader
 // LCOV_EXCL_STOP
\ No newline at end of file
@@ -2,13 +2,29 @@
 #include <gtest/gtest.h>
 #include <memory>
 #include <queue>
+#include <stdexcept>
+#include <thread>
 
+#include "concurrent/ring_queue.h"
+#include "concurrent/thread_pool.h"
+#include "event_handler/async_event_handler.h"
+#include "event_handler/batching_event_handler.h"
 #include "event_handler/event.h"
 #include "event_handler/event_handler.h"
+#include "event_handler/event_serializer.h"
+#include "event_handler/message_producer.h"
+#include "matching/market/binary_command.h"
+#include "matching/market/command.h"
+#include "matching/market/concurrent_market.h"
 #include "matching/market/market.h"
+#include "matching/orderbook/array_orderbook.h"
+#include "matching/orderbook/level_bitmap.h"
+#include "matching/orderbook/map_orderbook.h"
 #include "matching/orderbook/order.h"
+#include "matching/orderbook/order_index.h"
 
 using namespace RapidTrader;
+using namespace RapidTrader::Concurrent;
 
 // A simple event handler for testing purposes that stores events in queues.
 class TestEventHandler : public EventHandler
@@ -34,6 +50,21 @@ protected:
     }
 };
 
+// A test event handler that opts in to trade events.
+class TradeEventHandler : public TestEventHandler
+{
+public:
+    std::queue<Trade> trade_events;
+
+protected:
+    [[nodiscard]] bool handlesTrades() const override {
+        return true;
+    }
+    void handleTrade(const Trade &event) override {
+        trade_events.push(event);
+    }
+};
+
 // Test fixture for setting up a Market with our TestEventHandler
 class MarketTest : public ::testing::Test {
 protected:
@@ -117,4 +148,1186 @@ TEST_F(MarketTest, SimpleLimitOrderMatch) {
     EXPECT_EQ(executed_ask.order.isFilled(), true);
     EXPECT_EQ(executed_ask.order.getLastExecutedPrice(), 50000);
     EXPECT_EQ(executed_ask.order.getLastExecutedQuantity(), 10);
-}
\ No newline at end of file
+}
+
+// Test case 4: Test a simple match in a symbol backed by an array orderbook
+TEST_F(MarketTest, ArrayOrderBookSimpleMatch) {
+    const uint32_t symbol_id = 1;
+    market->addSymbol(symbol_id, "BTC-USDT", OrderBookConfig{OrderBookType::Array, 49000, 51000, 10});
+
+    market->addOrder(Order::limitBidOrder(101, symbol_id, 50000, 10, OrderTimeInForce::GTC));
+    market->addOrder(Order::limitAskOrder(102, symbol_id, 50000, 10, OrderTimeInForce::GTC));
+
+    ASSERT_EQ(event_handler_ptr->order_executed_events.size(), 2);
+    ASSERT_EQ(event_handler_ptr->order_deleted_events.size(), 2);
+    EXPECT_EQ(event_handler_ptr->order_executed_events.front().order.getOrderID(), 101);
+    EXPECT_EQ(event_handler_ptr->order_executed_events.back().order.getOrderID(), 102);
+}
+
+// Test case 5: Test that the best price cursors follow the book as levels are swept
+TEST(ArrayOrderBookTest, SweepUpdatesBestPrices) {
+    TestEventHandler event_handler;
+    ArrayOrderBook book{1, event_handler, 100, 200, 5};
+    EXPECT_EQ(book.bestBid(), 0);
+    EXPECT_EQ(book.bestAsk(), std::numeric_limits<uint64_t>::max());
+
+    book.addOrder(Order::limitAskOrder(1, 1, 150, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(2, 1, 160, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(3, 1, 170, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitBidOrder(4, 1, 120, 10, OrderTimeInForce::GTC));
+    EXPECT_EQ(book.bestAsk(), 150);
+    EXPECT_EQ(book.bestBid(), 120);
+
+    // Sweep the first two ask levels and rest the remainder at 165.
+    book.addOrder(Order::limitBidOrder(5, 1, 165, 25, OrderTimeInForce::GTC));
+    EXPECT_FALSE(book.hasOrder(1));
+    EXPECT_FALSE(book.hasOrder(2));
+    EXPECT_EQ(book.bestAsk(), 170);
+    EXPECT_EQ(book.bestBid(), 165);
+    EXPECT_EQ(book.getOrder(5).getOpenQuantity(), 5);
+
+    book.deleteOrder(5);
+    EXPECT_EQ(book.bestBid(), 120);
+    book.deleteOrder(3);
+    EXPECT_EQ(book.bestAsk(), std::numeric_limits<uint64_t>::max());
+}
+
+// Test case 6: Test that limit orders priced outside of the band never rest in an array orderbook
+TEST(ArrayOrderBookTest, OutOfBandOrdersDoNotRest) {
+    TestEventHandler event_handler;
+    ArrayOrderBook book{1, event_handler, 100, 200, 5};
+
+    book.addOrder(Order::limitBidOrder(1, 1, 250, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitBidOrder(2, 1, 152, 10, OrderTimeInForce::GTC));
+    EXPECT_TRUE(book.empty());
+    EXPECT_EQ(event_handler.order_deleted_events.size(), 2);
+}
+
+// Test case 7: Test that the level bitmap finds occupied levels across words and layers
+TEST(LevelBitmapTest, FindNextAndPrev) {
+    LevelBitmap bitmap{300000};
+    EXPECT_EQ(bitmap.findNext(0), LevelBitmap::NOT_FOUND);
+    EXPECT_EQ(bitmap.findPrev(299999), LevelBitmap::NOT_FOUND);
+
+    bitmap.set(5);
+    bitmap.set(4200);
+    bitmap.set(299999);
+    EXPECT_EQ(bitmap.findNext(0), 5);
+    EXPECT_EQ(bitmap.findNext(6), 4200);
+    EXPECT_EQ(bitmap.findNext(4201), 299999);
+    EXPECT_EQ(bitmap.findPrev(299998), 4200);
+    EXPECT_EQ(bitmap.findPrev(4199), 5);
+    EXPECT_EQ(bitmap.findPrev(4), LevelBitmap::NOT_FOUND);
+
+    bitmap.clear(4200);
+    EXPECT_FALSE(bitmap.test(4200));
+    EXPECT_EQ(bitmap.findNext(6), 299999);
+    EXPECT_EQ(bitmap.findPrev(299998), 5);
+
+    // Levels of pages that were never occupied read as empty.
+    EXPECT_FALSE(bitmap.test(100000));
+    bitmap.clear(100000);
+    EXPECT_EQ(bitmap.findNext(6), 299999);
+
+    LevelBitmap small_bitmap{10};
+    small_bitmap.set(9);
+    EXPECT_EQ(small_bitmap.findNext(0), 9);
+    EXPECT_EQ(small_bitmap.findPrev(8), LevelBitmap::NOT_FOUND);
+    EXPECT_EQ(small_bitmap.findNext(10), LevelBitmap::NOT_FOUND);
+}
+
+// Test case 8: Test that best prices are found in a wide, sparsely populated price band
+TEST(ArrayOrderBookTest, SparseWideBand) {
+    TestEventHandler event_handler;
+    ArrayOrderBook book{1, event_handler, 1, 10000000, 1};
+
+    book.addOrder(Order::limitBidOrder(1, 1, 10, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitBidOrder(2, 1, 5000000, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(3, 1, 9000000, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(4, 1, 9999999, 10, OrderTimeInForce::GTC));
+    EXPECT_EQ(book.bestBid(), 5000000);
+    EXPECT_EQ(book.bestAsk(), 9000000);
+
+    book.deleteOrder(2);
+    EXPECT_EQ(book.bestBid(), 10);
+    book.addOrder(Order::limitBidOrder(5, 1, 9999999, 20, OrderTimeInForce::GTC));
+    EXPECT_FALSE(book.hasOrder(3));
+    EXPECT_FALSE(book.hasOrder(4));
+    EXPECT_EQ(book.bestAsk(), std::numeric_limits<uint64_t>::max());
+    EXPECT_EQ(book.bestBid(), 10);
+}
+
+// Test case 9: Test that best prices are tracked across the pages of the price ladder
+TEST(ArrayOrderBookTest, BestPricesAcrossPages) {
+    TestEventHandler event_handler;
+    // Ladder pages hold 1024 levels, so prices 1024 and 1025 are on either side of the first page boundary.
+    ArrayOrderBook book{1, event_handler, 1, 4096, 1};
+
+    book.addOrder(Order::limitBidOrder(1, 1, 1024, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitBidOrder(2, 1, 1025, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitBidOrder(3, 1, 2048, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(4, 1, 3072, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(5, 1, 3073, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(6, 1, 4096, 10, OrderTimeInForce::GTC));
+    EXPECT_EQ(book.bestBid(), 2048);
+    EXPECT_EQ(book.bestAsk(), 3072);
+
+    book.deleteOrder(3);
+    EXPECT_EQ(book.bestBid(), 1025);
+    book.deleteOrder(2);
+    EXPECT_EQ(book.bestBid(), 1024);
+    book.deleteOrder(4);
+    EXPECT_EQ(book.bestAsk(), 3073);
+
+    // Sweep the asks of two pages, leaving part of the last level.
+    book.addOrder(Order::limitBidOrder(7, 1, 4096, 15, OrderTimeInForce::IOC));
+    EXPECT_FALSE(book.hasOrder(5));
+    EXPECT_EQ(book.bestAsk(), 4096);
+    EXPECT_EQ(book.getOrder(6).getOpenQuantity(), 5);
+    book.deleteOrder(6);
+    EXPECT_EQ(book.bestAsk(), std::numeric_limits<uint64_t>::max());
+    book.deleteOrder(1);
+    EXPECT_EQ(book.bestBid(), 0);
+}
+
+// Test case 10: Test that trailing stop prices follow the market and trigger at the derived price
+TEST(MapOrderBookTest, TrailingStopFollowsMarket) {
+    TestEventHandler event_handler;
+    MapOrderBook book{1, event_handler};
+
+    book.addOrder(Order::limitBidOrder(1, 1, 100, 1, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(2, 1, 100, 1, OrderTimeInForce::GTC));
+    book.addOrder(Order::trailingStopAskOrder(3, 1, 5, 1, OrderTimeInForce::IOC));
+    EXPECT_EQ(book.getOrder(3).getStopPrice(), 95);
+
+    // The market rises, so the stop price rises with it.
+    book.addOrder(Order::limitBidOrder(4, 1, 110, 1, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(5, 1, 110, 1, OrderTimeInForce::GTC));
+    EXPECT_EQ(book.getOrder(3).getStopPrice(), 105);
+
+    // A trade at 104 crosses the stop price and activates the order.
+    book.addOrder(Order::limitBidOrder(6, 1, 104, 1, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(7, 1, 104, 1, OrderTimeInForce::GTC));
+    EXPECT_FALSE(book.hasOrder(3));
+}
+
+// Test case 11: Test that a trade triggering a stop order cascades through stop orders it triggers
+TEST(MapOrderBookTest, StopOrderCascade) {
+    TestEventHandler event_handler;
+    MapOrderBook book{1, event_handler};
+
+    book.addOrder(Order::limitBidOrder(1, 1, 101, 1, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(2, 1, 101, 1, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitBidOrder(3, 1, 100, 1, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitBidOrder(4, 1, 99, 1, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitBidOrder(5, 1, 98, 1, OrderTimeInForce::GTC));
+    book.addOrder(Order::stopAskOrder(6, 1, 100, 1, OrderTimeInForce::IOC));
+    book.addOrder(Order::stopAskOrder(7, 1, 99, 1, OrderTimeInForce::IOC));
+    EXPECT_TRUE(book.hasOrder(6));
+    EXPECT_TRUE(book.hasOrder(7));
+
+    // Trading at 100 triggers the first stop order, which trades at 99 and triggers the second.
+    book.addOrder(Order::marketAskOrder(8, 1, 1, OrderTimeInForce::IOC));
+    EXPECT_FALSE(book.hasOrder(6));
+    EXPECT_FALSE(book.hasOrder(7));
+    EXPECT_EQ(book.lastTradedPrice(), 98);
+    EXPECT_EQ(book.bestBid(), 0);
+}
+
+// A test event handler that records order events in the order they were raised.
+class SequenceEventHandler : public EventHandler
+{
+public:
+    std::vector<std::string> events;
+
+protected:
+    void handleOrderAdded(const OrderAdded &event) override {
+        events.push_back("added " + std::to_string(event.order.getOrderID()));
+    }
+    void handleOrderDeleted(const OrderDeleted &event) override {
+        events.push_back("deleted " + std::to_string(event.order.getOrderID()));
+    }
+    void handleOrderUpdated(const OrderUpdated &event) override {
+        events.push_back("updated " + std::to_string(event.order.getOrderID()));
+    }
+    void handleOrderExecuted(const ExecutedOrder &event) override {
+        events.push_back("executed " + std::to_string(event.order.getOrderID()) + " at " + std::to_string(event.order.getLastExecutedPrice()));
+    }
+};
+
+// Test case 12: Test the exact events raised by a chain of stop orders that trigger each other
+TEST(MapOrderBookTest, StopOrderChainEvents) {
+    auto submit_orders = [](auto &book, SequenceEventHandler &event_handler) {
+        book.addOrder(Order::limitBidOrder(1, 1, 101, 1, OrderTimeInForce::GTC));
+        book.addOrder(Order::limitAskOrder(2, 1, 101, 1, OrderTimeInForce::GTC));
+        book.addOrder(Order::limitBidOrder(3, 1, 100, 1, OrderTimeInForce::GTC));
+        book.addOrder(Order::limitBidOrder(4, 1, 99, 1, OrderTimeInForce::GTC));
+        book.addOrder(Order::limitBidOrder(5, 1, 98, 1, OrderTimeInForce::GTC));
+        book.addOrder(Order::limitBidOrder(9, 1, 97, 1, OrderTimeInForce::GTC));
+        book.addOrder(Order::stopAskOrder(6, 1, 100, 1, OrderTimeInForce::IOC));
+        book.addOrder(Order::stopAskOrder(10, 1, 100, 1, OrderTimeInForce::IOC));
+        book.addOrder(Order::stopAskOrder(7, 1, 98, 1, OrderTimeInForce::IOC));
+        event_handler.events.clear();
+        book.addOrder(Order::marketAskOrder(8, 1, 1, OrderTimeInForce::IOC));
+    };
+    // Trading at 100 triggers both stop orders at 100 in time priority, and the second one
+    // trades at 98 and triggers the stop order at 98.
+    const std::vector<std::string> expected_events = {"added 8", "executed 3 at 100", "executed 8 at 100", "deleted 3", "deleted 8",
+        "updated 6", "executed 4 at 99", "executed 6 at 99", "deleted 4", "deleted 6",
+        "updated 10", "executed 5 at 98", "executed 10 at 98", "deleted 5", "deleted 10",
+        "updated 7", "executed 9 at 97", "executed 7 at 97", "deleted 9", "deleted 7"};
+
+    SequenceEventHandler map_handler;
+    MapOrderBook map_book{1, map_handler};
+    submit_orders(map_book, map_handler);
+    EXPECT_EQ(map_handler.events, expected_events);
+
+    SequenceEventHandler array_handler;
+    ArrayOrderBook array_book{1, array_handler, 1, 200, 1};
+    submit_orders(array_book, array_handler);
+    EXPECT_EQ(array_handler.events, expected_events);
+}
+
+// Test case 13: Test depth queries and FOK admission against the depth index of an array orderbook
+TEST(ArrayOrderBookTest, DepthQueries) {
+    TestEventHandler event_handler;
+    ArrayOrderBook book{1, event_handler, 100, 200, 5};
+
+    book.addOrder(Order::limitBidOrder(1, 1, 120, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitBidOrder(2, 1, 150, 5, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(3, 1, 170, 7, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(4, 1, 190, 3, OrderTimeInForce::GTC));
+    EXPECT_EQ(book.volumeAtOrBetter(OrderSide::Bid, 121), 5);
+    EXPECT_EQ(book.volumeAtOrBetter(OrderSide::Bid, 120), 15);
+    EXPECT_EQ(book.volumeAtOrBetter(OrderSide::Bid, 50), 15);
+    EXPECT_EQ(book.volumeAtOrBetter(OrderSide::Bid, 201), 0);
+    EXPECT_EQ(book.volumeAtOrBetter(OrderSide::Ask, 189), 7);
+    EXPECT_EQ(book.volumeAtOrBetter(OrderSide::Ask, 190), 10);
+    EXPECT_EQ(book.volumeAtOrBetter(OrderSide::Ask, 99), 0);
+
+    // Only 7 shares are offered at or below 180, so the FOK order is rejected.
+    book.addOrder(Order::limitBidOrder(5, 1, 180, 8, OrderTimeInForce::FOK));
+    EXPECT_EQ(book.volumeAtOrBetter(OrderSide::Ask, 250), 10);
+    book.addOrder(Order::limitBidOrder(6, 1, 190, 8, OrderTimeInForce::FOK));
+    EXPECT_EQ(book.volumeAtOrBetter(OrderSide::Ask, 250), 2);
+}
+
+// Test case 14: Test FOK admission and depth queries of a map orderbook across several levels
+TEST(MapOrderBookTest, FillOrKillAcrossLevels) {
+    TestEventHandler event_handler;
+    MapOrderBook book{1, event_handler};
+
+    book.addOrder(Order::limitAskOrder(1, 1, 100, 2, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(2, 1, 101, 2, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(3, 1, 102, 2, OrderTimeInForce::GTC));
+    EXPECT_EQ(book.volumeAtOrBetter(OrderSide::Ask, 101), 4);
+    EXPECT_EQ(book.volumeAtOrBetter(OrderSide::Ask, 99), 0);
+
+    // Only 6 shares are offered at or below 102, so the FOK order is rejected without trading.
+    book.addOrder(Order::limitBidOrder(4, 1, 102, 7, OrderTimeInForce::FOK));
+    EXPECT_TRUE(event_handler.order_executed_events.empty());
+    EXPECT_EQ(book.volumeAtOrBetter(OrderSide::Ask, 102), 6);
+    ASSERT_EQ(event_handler.order_deleted_events.size(), 1);
+    EXPECT_EQ(event_handler.order_deleted_events.front().order.getOrderID(), 4);
+
+    // The next FOK order fits in the three levels and fills across them.
+    book.addOrder(Order::limitBidOrder(5, 1, 102, 5, OrderTimeInForce::FOK));
+    EXPECT_FALSE(book.hasOrder(1));
+    EXPECT_FALSE(book.hasOrder(2));
+    EXPECT_EQ(book.getOrder(3).getOpenQuantity(), 1);
+    EXPECT_EQ(book.lastTradedPrice(), 102);
+    EXPECT_EQ(book.volumeAtOrBetter(OrderSide::Ask, 102), 1);
+    EXPECT_EQ(book.volumeAtOrBetter(OrderSide::Bid, 1), 0);
+}
+
+// Test case 15: Test that orderbooks with 32-bit prices and quantities match and report 64-bit orders
+TEST(MapOrderBookTest, CompactOrders) {
+    TestEventHandler event_handler;
+    BasicMapOrderBook<EventHandler, uint32_t, uint32_t> book{1, event_handler};
+
+    book.addOrder(Order::limitAskOrder(1, 1, 4000000000, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(2, 1, 4000000001, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::marketBidOrder(3, 1, 15, OrderTimeInForce::IOC));
+    EXPECT_FALSE(book.hasOrder(1));
+    EXPECT_EQ(book.bestAsk(), 4000000001);
+    EXPECT_EQ(book.lastTradedPrice(), 4000000001);
+    EXPECT_EQ(book.getOrder(2).getOpenQuantity(), 5);
+    EXPECT_EQ(book.getOrder(2).getLastExecutedPrice(), 4000000001);
+
+    // Events carry 64-bit orders, and the unbounded price of the market order stays unbounded.
+    ASSERT_EQ(event_handler.order_deleted_events.size(), 2);
+    event_handler.order_deleted_events.pop();
+    const Order &market_order = event_handler.order_deleted_events.front().order;
+    EXPECT_EQ(market_order.getOrderID(), 3);
+    EXPECT_EQ(market_order.getPrice(), std::numeric_limits<uint64_t>::max());
+    EXPECT_EQ(market_order.getExecutedQuantity(), 15);
+
+    // Stop prices derived from the market that do not fit in 32 bits are unbounded.
+    book.addOrder(Order::trailingStopBidOrder(4, 1, 1000000000, 5, OrderTimeInForce::IOC));
+    ASSERT_TRUE(book.hasOrder(4));
+    EXPECT_EQ(book.getOrder(4).getStopPrice(), std::numeric_limits<uint64_t>::max());
+}
+
+// Test case 16: Test that orderbooks with 32-bit prices and quantities reject values that do not fit instead of truncating them
+TEST(MapOrderBookTest, CompactOrdersRejectWideValues) {
+    // Values are checked before they are narrowed, so they are rejected even in builds without
+    // asserts, where narrowing would silently truncate them.
+    TestEventHandler event_handler;
+    BasicMapOrderBook<EventHandler, uint32_t, uint32_t> book{1, event_handler};
+    const uint64_t wide = uint64_t{1} << 32;
+    book.addOrder(Order::limitBidOrder(1, 1, 100, 10, OrderTimeInForce::GTC));
+    // Truncated, either order would match the bid.
+    book.addOrder(Order::limitAskOrder(2, 1, wide + 100, 5, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(3, 1, 100, wide + 5, OrderTimeInForce::GTC));
+    EXPECT_FALSE(book.hasOrder(2));
+    EXPECT_FALSE(book.hasOrder(3));
+    EXPECT_EQ(event_handler.order_added_events.size(), 3);
+    EXPECT_EQ(event_handler.order_deleted_events.size(), 2);
+    EXPECT_EQ(event_handler.order_executed_events.size(), 0);
+
+    // Replacing or executing an order at a price that does not fit leaves it untouched.
+    book.replaceOrder(1, 4, wide + 100);
+    book.executeOrder(1, 5, wide + 100);
+    ASSERT_TRUE(book.hasOrder(1));
+    EXPECT_EQ(book.getOrder(1).getPrice(), 100);
+    EXPECT_EQ(book.getOrder(1).getOpenQuantity(), 10);
+    EXPECT_EQ(event_handler.order_executed_events.size(), 0);
+
+    // A cancelled quantity that does not fit exceeds the open quantity, so the order is deleted.
+    book.cancelOrder(1, wide);
+    EXPECT_FALSE(book.hasOrder(1));
+    EXPECT_EQ(event_handler.order_deleted_events.size(), 3);
+}
+
+// Test case 17: Test that handlers that opt in to trade events receive one trade per fill
+TEST(MapOrderBookTest, TradeEvents) {
+    TradeEventHandler event_handler;
+    MapOrderBook book{1, event_handler};
+
+    book.addOrder(Order::limitAskOrder(1, 1, 100, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(2, 1, 101, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitBidOrder(3, 1, 101, 15, OrderTimeInForce::GTC));
+    EXPECT_TRUE(event_handler.order_executed_events.empty());
+    ASSERT_EQ(event_handler.trade_events.size(), 2);
+
+    Trade first = event_handler.trade_events.front();
+    event_handler.trade_events.pop();
+    EXPECT_EQ(first.symbol_id, 1);
+    EXPECT_EQ(first.trade_seq, 1);
+    EXPECT_EQ(first.aggressor_id, 3);
+    EXPECT_EQ(first.passive_id, 1);
+    EXPECT_EQ(first.price, 100);
+    EXPECT_EQ(first.quantity, 10);
+    EXPECT_EQ(first.aggressor_open_quantity, 5);
+    EXPECT_EQ(first.passive_open_quantity, 0);
+    EXPECT_EQ(first.aggressor_side, OrderSide::Bid);
+
+    Trade second = event_handler.trade_events.front();
+    EXPECT_EQ(second.trade_seq, 2);
+    EXPECT_EQ(second.passive_id, 2);
+    EXPECT_EQ(second.price, 101);
+    EXPECT_EQ(second.quantity, 5);
+    EXPECT_EQ(second.aggressor_open_quantity, 0);
+    EXPECT_EQ(second.passive_open_quantity, 5);
+}
+
+// Test case 18: Test that the ring queues preserve each producer's order when they wrap around
+TEST(RingQueueTest, ProducersWrapAround) {
+    SPSCQueue<uint64_t> spsc_queue{3};
+    uint64_t value = 1;
+    for (uint64_t i = 0; i < 4; ++i)
+        EXPECT_TRUE(spsc_queue.tryPush(value));
+    EXPECT_FALSE(spsc_queue.tryPush(value));
+    EXPECT_TRUE(spsc_queue.tryPop(value));
+    EXPECT_TRUE(spsc_queue.tryPush(value));
+
+    // A multi-producer ring has at least two slots, so a freed slot is never mistaken for a full one.
+    MPSCQueue<uint64_t> small_queue{1};
+    EXPECT_TRUE(small_queue.tryPush(value));
+    EXPECT_TRUE(small_queue.tryPush(value));
+    EXPECT_FALSE(small_queue.tryPush(value));
+    EXPECT_TRUE(small_queue.tryPop(value));
+    EXPECT_TRUE(small_queue.tryPop(value));
+    EXPECT_FALSE(small_queue.tryPop(value));
+
+    const uint64_t num_producers = 4;
+    const uint64_t values_per_producer = 100000;
+    MPSCQueue<uint64_t> mpsc_queue{64};
+    std::vector<std::thread> producers;
+    for (uint64_t producer = 0; producer < num_producers; ++producer)
+    {
+        producers.emplace_back([&mpsc_queue, producer] {
+            for (uint64_t i = 0; i < values_per_producer; ++i)
+                mpsc_queue.push(producer * values_per_producer + i);
+        });
+    }
+    std::vector<uint64_t> next_values(num_producers);
+    for (uint64_t i = 0; i < num_producers * values_per_producer; ++i)
+    {
+        while (!mpsc_queue.tryPop(value))
+            std::this_thread::yield();
+        uint64_t producer = value / values_per_producer;
+        ASSERT_EQ(value % values_per_producer, next_values[producer]++);
+    }
+    for (auto &producer : producers)
+        producer.join();
+    EXPECT_TRUE(mpsc_queue.empty());
+}
+
+// Test case 19: Test that the worker queues of a thread pool hold the capacity they are given
+TEST(ThreadPoolTest, QueueCapacity) {
+    ThreadPool pool{1, WaitStrategy::Backoff, {}, 4};
+    std::atomic<bool> started{false};
+    std::atomic<bool> release{false};
+    std::atomic<uint32_t> executed{0};
+    pool.submitTask(0, [&] {
+        started = true;
+        while (!release)
+            std::this_thread::yield();
+    });
+    while (!started)
+        std::this_thread::yield();
+    // The worker is busy, so four tasks fill its queue and the fifth waits for space.
+    std::atomic<uint32_t> submitted{0};
+    std::thread submitter{[&] {
+        for (int i = 0; i < 5; ++i)
+        {
+            pool.submitTask(0, [&] { ++executed; });
+            ++submitted;
+        }
+    }};
+    while (submitted < 4)
+        std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(submitted, 4);
+    release = true;
+    submitter.join();
+    while (executed < 5)
+        std::this_thread::yield();
+    EXPECT_EQ(submitted, 5);
+}
+
+// Test case 20: Test that a callback command frees its function once it has run, even if the function throws
+TEST(CommandTest, CallbackFreesFunction) {
+    auto token = std::make_shared<int>(0);
+    Command command = Command::callback([token] { throw std::runtime_error("Callback failed!"); });
+    EXPECT_EQ(token.use_count(), 2);
+    EXPECT_THROW(command(), std::runtime_error);
+    EXPECT_EQ(token.use_count(), 1);
+
+    Command order_command = Command::deleteOrder(nullptr, 1, 2);
+    EXPECT_EQ(order_command.type, CommandType::DeleteOrder);
+    EXPECT_EQ(order_command.price, 0);
+    EXPECT_EQ(order_command.new_order_id, 0);
+}
+
+// Test case 21: Test that order commands submitted to a concurrent market reach the orderbook
+TEST(ConcurrentMarketTest, CommandsReachOrderBook) {
+    std::vector<std::unique_ptr<EventHandler>> event_handlers;
+    event_handlers.push_back(std::make_unique<TestEventHandler>());
+    auto *event_handler = static_cast<TestEventHandler *>(event_handlers.front().get());
+    ConcurrentMarket market{event_handlers, 1};
+    market.addSymbol(1, "BTC-USDT");
+    market.addOrder(Order::limitBidOrder(101, 1, 50000, 10, OrderTimeInForce::GTC));
+    market.addOrder(Order::stopLimitBidOrder(102, 1, 60000, 59900, 5, OrderTimeInForce::GTC));
+    market.addOrder(Order::limitAskOrder(103, 1, 50000, 4, OrderTimeInForce::GTC));
+    market.deleteOrder(1, 101);
+    // toString waits for the worker to process every command submitted before it.
+    std::string market_string = market.toString();
+
+    EXPECT_EQ(event_handler->symbol_added_events.size(), 1);
+    ASSERT_EQ(event_handler->order_added_events.size(), 3);
+    EXPECT_EQ(event_handler->order_added_events.front().order.getOrderID(), 101);
+    event_handler->order_added_events.pop();
+    EXPECT_EQ(event_handler->order_added_events.front().order.getType(), OrderType::StopLimit);
+    EXPECT_EQ(event_handler->order_added_events.front().order.getStopPrice(), 59900);
+    EXPECT_EQ(event_handler->order_executed_events.size(), 2);
+    ASSERT_EQ(event_handler->order_deleted_events.size(), 2);
+    EXPECT_EQ(event_handler->order_deleted_events.back().order.getOrderID(), 101);
+}
+
+// Test case 22: Test that a symbol migrated to another worker keeps its resting orders
+TEST(ConcurrentMarketTest, MigratedSymbolKeepsOrders) {
+    std::vector<std::unique_ptr<EventHandler>> event_handlers;
+    event_handlers.push_back(std::make_unique<TestEventHandler>());
+    event_handlers.push_back(std::make_unique<TestEventHandler>());
+    auto *first_handler = static_cast<TestEventHandler *>(event_handlers[0].get());
+    auto *second_handler = static_cast<TestEventHandler *>(event_handlers[1].get());
+    ConcurrentMarket market{event_handlers, 2};
+    market.addSymbol(1, "BTC-USDT");
+    market.addSymbol(2, "ETH-USDT");
+    market.addSymbol(3, "SOL-USDT");
+    ASSERT_EQ(market.getWorkerIndex(1), 0);
+    ASSERT_EQ(market.getWorkerIndex(3), 0);
+    for (uint64_t i = 0; i < 6; ++i)
+        market.addOrder(Order::limitBidOrder(100 + i, 1, 50000 - i, 1, OrderTimeInForce::GTC));
+    market.addOrder(Order::limitBidOrder(200, 3, 100, 1, OrderTimeInForce::GTC));
+    // Moving symbol 1 narrows the gap between the workers the most.
+    market.rebalance();
+    EXPECT_EQ(market.getWorkerIndex(1), 1);
+    EXPECT_EQ(market.getWorkerIndex(3), 0);
+    market.addOrder(Order::limitAskOrder(110, 1, 49997, 5, OrderTimeInForce::GTC));
+    market.migrateSymbol(3, 1);
+    market.addOrder(Order::limitAskOrder(201, 3, 100, 1, OrderTimeInForce::GTC));
+    std::string market_string = market.toString();
+
+    EXPECT_EQ(first_handler->order_added_events.size(), 7);
+    EXPECT_EQ(first_handler->order_executed_events.size(), 0);
+    EXPECT_EQ(second_handler->order_added_events.size(), 2);
+    EXPECT_EQ(second_handler->order_executed_events.size(), 5 * 2);
+    ASSERT_NE(market_string.find("SYMBOL ID : 1\n"), std::string::npos);
+    EXPECT_EQ(market_string.find("SYMBOL ID : 1\n"), market_string.rfind("SYMBOL ID : 1\n"));
+}
+
+// Test case 23: Test that a batch of commands submitted to a concurrent market matches the same commands on a market
+TEST(ConcurrentMarketTest, BatchMatchesMarket) {
+    std::vector<Command> batch;
+    for (uint32_t symbol_id = 1; symbol_id <= 3; ++symbol_id)
+    {
+        batch.push_back(Command::addOrder(nullptr, Order::limitBidOrder(symbol_id * 10, symbol_id, 100, 5, OrderTimeInForce::GTC)));
+        batch.push_back(Command::addOrder(nullptr, Order::limitAskOrder(symbol_id * 10 + 1, symbol_id, 101, 2, OrderTimeInForce::GTC)));
+        batch.push_back(Command::cancelOrder(nullptr, symbol_id, symbol_id * 10, 4));
+        batch.push_back(Command::replaceOrder(nullptr, symbol_id, symbol_id * 10 + 1, symbol_id * 10 + 2, 100));
+    }
+
+    auto market_handler = std::make_unique<TestEventHandler>();
+    auto *market_events = market_handler.get();
+    Market market{std::move(market_handler)};
+    std::vector<std::unique_ptr<EventHandler>> event_handlers;
+    event_handlers.push_back(std::make_unique<TestEventHandler>());
+    event_handlers.push_back(std::make_unique<TestEventHandler>());
+    auto *first_events = static_cast<TestEventHandler *>(event_handlers[0].get());
+    auto *second_events = static_cast<TestEventHandler *>(event_handlers[1].get());
+    ConcurrentMarket concurrent_market{event_handlers, 2};
+    for (uint32_t symbol_id = 1; symbol_id <= 3; ++symbol_id)
+    {
+        market.addSymbol(symbol_id, "SYMBOL" + std::to_string(symbol_id));
+        concurrent_market.addSymbol(symbol_id, "SYMBOL" + std::to_string(symbol_id));
+    }
+    market.submitBatch(batch.data(), batch.size());
+    concurrent_market.submitBatch(batch.data(), batch.size());
+    std::string concurrent_market_string = concurrent_market.toString();
+
+    EXPECT_EQ(market_events->order_added_events.size(), 9);
+    EXPECT_EQ(market_events->order_executed_events.size(), 6);
+    EXPECT_EQ(first_events->order_added_events.size() + second_events->order_added_events.size(), 9);
+    EXPECT_EQ(first_events->order_executed_events.size() + second_events->order_executed_events.size(), 6);
+    EXPECT_EQ(first_events->order_added_events.size(), 6);
+    EXPECT_EQ(market.toString().size(), concurrent_market_string.size());
+}
+
+// Test case 24: Test that orders submitted to a concurrent market from many threads all reach their orderbooks
+TEST(ConcurrentMarketTest, SubmitFromManyThreads) {
+    constexpr uint32_t num_ingress_threads = 4;
+    constexpr uint64_t orders_per_thread = 2000;
+    std::vector<std::unique_ptr<EventHandler>> event_handlers;
+    event_handlers.push_back(std::make_unique<TestEventHandler>());
+    event_handlers.push_back(std::make_unique<TestEventHandler>());
+    auto *first_handler = static_cast<TestEventHandler *>(event_handlers[0].get());
+    auto *second_handler = static_cast<TestEventHandler *>(event_handlers[1].get());
+    ConcurrentMarket market{event_handlers, 2};
+    for (uint32_t symbol_id = 1; symbol_id <= num_ingress_threads; ++symbol_id)
+        market.addSymbol(symbol_id, "SYMBOL" + std::to_string(symbol_id));
+
+    std::vector<std::thread> ingress_threads;
+    for (uint32_t symbol_id = 1; symbol_id <= num_ingress_threads; ++symbol_id)
+    {
+        ingress_threads.emplace_back([&market, symbol_id] {
+            for (uint64_t i = 0; i < orders_per_thread; ++i)
+                market.addOrder(Order::limitBidOrder(symbol_id * orders_per_thread + i, symbol_id, 100, 1, OrderTimeInForce::GTC));
+        });
+    }
+    // Symbol operations and migrations run while orders are being submitted.
+    for (uint32_t i = 0; i < 20; ++i)
+    {
+        market.addSymbol(100 + i, "EXTRA");
+        market.migrateSymbol(1 + i % num_ingress_threads, i % 2);
+        market.rebalance();
+        market.deleteSymbol(100 + i);
+    }
+    for (auto &ingress_thread : ingress_threads)
+        ingress_thread.join();
+    std::string market_string = market.toString();
+
+    EXPECT_EQ(first_handler->order_added_events.size() + second_handler->order_added_events.size(), num_ingress_threads * orders_per_thread);
+    EXPECT_EQ(first_handler->symbol_added_events.size() + second_handler->symbol_added_events.size(), num_ingress_threads + 20);
+    for (uint32_t symbol_id = 1; symbol_id <= num_ingress_threads; ++symbol_id)
+        EXPECT_EQ(market_string.find("SYMBOL ID : " + std::to_string(symbol_id) + "\n"), market_string.rfind("SYMBOL ID : " + std::to_string(symbol_id) + "\n"));
+}
+
+// An event handler that holds the thread that raises its events in the first event until it is opened.
+class GatedEventHandler final : public EventHandler
+{
+    template<typename Handler, typename Price, typename Quantity>
+    friend class RapidTrader::BasicMapOrderBook;
+    template<typename Handler>
+    friend class RapidTrader::BasicArrayOrderBook;
+
+public:
+    std::atomic_bool entered{false};
+    std::atomic_bool open{false};
+    std::vector<uint64_t> order_ids;
+
+protected:
+    void handleOrderAdded(const OrderAdded &event) override {
+        entered = true;
+        while (!open)
+            std::this_thread::yield();
+        order_ids.push_back(event.order.getOrderID());
+    }
+};
+
+// Test case 25: Test that symbols on the target worker of a migration keep trading while the old worker is busy
+TEST(ConcurrentMarketTest, MigrationDoesNotStopTargetWorker) {
+    // The handlers are final, so the orderbooks are bound to them at compile time.
+    std::vector<std::unique_ptr<GatedEventHandler>> event_handlers;
+    event_handlers.push_back(std::make_unique<GatedEventHandler>());
+    event_handlers.push_back(std::make_unique<GatedEventHandler>());
+    GatedEventHandler *source_handler = event_handlers[0].get();
+    GatedEventHandler *target_handler = event_handlers[1].get();
+    target_handler->open = true;
+    ConcurrentMarket market{event_handlers, 2};
+    market.addSymbol(1, "BTC-USDT");
+    market.addSymbol(2, "ETH-USDT");
+    ASSERT_EQ(market.getWorkerIndex(1), 0);
+    ASSERT_EQ(market.getWorkerIndex(2), 1);
+    // The old worker is held in the first order, so it cannot release the orderbook yet.
+    market.addOrder(Order::limitBidOrder(1, 1, 100, 1, OrderTimeInForce::GTC));
+    while (!source_handler->entered)
+        std::this_thread::yield();
+    std::thread migration{[&market] { market.migrateSymbol(1, 1); }};
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    market.addOrder(Order::limitBidOrder(2, 2, 100, 1, OrderTimeInForce::GTC));
+    for (int i = 0; i < 5000 && !target_handler->entered; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_TRUE(target_handler->entered);
+    source_handler->open = true;
+    migration.join();
+    market.addOrder(Order::limitBidOrder(3, 1, 99, 1, OrderTimeInForce::GTC));
+    std::string market_string = market.toString();
+
+    EXPECT_EQ(market.getWorkerIndex(1), 1);
+    EXPECT_EQ(source_handler->order_ids, std::vector<uint64_t>{1});
+    EXPECT_EQ(target_handler->order_ids, (std::vector<uint64_t>{2, 3}));
+}
+
+// Test case 26: Test that the symbol table finds symbols with both dense and sparse IDs
+TEST(SymbolTableTest, DenseAndSparseIds) {
+    SymbolTable<std::string> symbol_table;
+    symbol_table.insert(3, std::make_unique<std::string>("DENSE"));
+    symbol_table.insert(MAX_DENSE_SYMBOL_ID + 7, std::make_unique<std::string>("SPARSE"));
+    EXPECT_EQ(symbol_table.size(), 2);
+    EXPECT_EQ(*symbol_table.find(3), "DENSE");
+    EXPECT_EQ(*symbol_table.find(MAX_DENSE_SYMBOL_ID + 7), "SPARSE");
+    EXPECT_EQ(symbol_table.find(2), nullptr);
+    EXPECT_EQ(symbol_table.find(1000), nullptr);
+    EXPECT_EQ(symbol_table.find(MAX_DENSE_SYMBOL_ID + 8), nullptr);
+
+    std::vector<uint32_t> symbol_ids;
+    symbol_table.forEach([&](uint32_t symbol_id, const std::string &) { symbol_ids.push_back(symbol_id); });
+    EXPECT_EQ(symbol_ids, (std::vector<uint32_t>{3, MAX_DENSE_SYMBOL_ID + 7}));
+
+    EXPECT_EQ(*symbol_table.remove(3), "DENSE");
+    EXPECT_EQ(*symbol_table.remove(MAX_DENSE_SYMBOL_ID + 7), "SPARSE");
+    EXPECT_EQ(symbol_table.find(3), nullptr);
+    EXPECT_EQ(symbol_table.size(), 0);
+}
+
+// Test case 27: Test that the order index slides its window of pages and hashes IDs outside of it
+TEST(OrderIndexTest, WindowSlidesAndFallsBack) {
+    using Index = OrderIndex<uint64_t>;
+    Index order_index{true};
+    std::vector<uint64_t> objects(3 * Index::PAGE_SIZE);
+    // Fill three pages, then drain the oldest one so that the window slides past it.
+    for (uint64_t i = 0; i < objects.size(); ++i)
+        order_index.insert(i + 1, &objects[i]);
+    for (uint64_t i = 0; i < Index::PAGE_SIZE; ++i)
+        order_index.erase(i + 1);
+    EXPECT_EQ(order_index.size(), 2 * Index::PAGE_SIZE);
+    EXPECT_EQ(order_index.find(1), nullptr);
+    EXPECT_EQ(order_index.find(Index::PAGE_SIZE + 1), &objects[Index::PAGE_SIZE]);
+
+    // IDs too far from the window are hashed, and are still found once the window covers them.
+    uint64_t far_id = (Index::MAX_WINDOW_PAGES + 4) * Index::PAGE_SIZE;
+    order_index.insert(far_id, &objects[0]);
+    EXPECT_EQ(order_index.find(far_id), &objects[0]);
+    for (uint64_t i = Index::PAGE_SIZE; i < objects.size(); ++i)
+        order_index.erase(i + 1);
+    order_index.insert(far_id + 1, &objects[1]);
+    EXPECT_EQ(order_index.find(far_id), &objects[0]);
+    EXPECT_EQ(order_index.find(far_id + 1), &objects[1]);
+    uint64_t num_objects = 0;
+    order_index.forEach([&](uint64_t *) { ++num_objects; });
+    EXPECT_EQ(num_objects, 2);
+
+    order_index.erase(far_id);
+    order_index.erase(far_id + 1);
+    EXPECT_TRUE(order_index.empty());
+    EXPECT_EQ(order_index.find(far_id), nullptr);
+}
+
+// Test case 28: Test that the order index finds and erases IDs in a drained page in the middle of its window
+TEST(OrderIndexTest, DrainedMiddlePage) {
+    using Index = OrderIndex<uint64_t>;
+    Index order_index{true};
+    std::vector<uint64_t> objects(3);
+    // Drain the middle page of three, which leaves a released page inside the window.
+    order_index.insert(1, &objects[0]);
+    order_index.insert(Index::PAGE_SIZE + 1, &objects[1]);
+    order_index.insert(2 * Index::PAGE_SIZE + 1, &objects[2]);
+    order_index.erase(Index::PAGE_SIZE + 1);
+    EXPECT_EQ(order_index.find(Index::PAGE_SIZE + 1), nullptr);
+    EXPECT_EQ(order_index.find(Index::PAGE_SIZE + 2), nullptr);
+
+    // IDs in the released page are found and erased once they are inserted again.
+    order_index.insert(Index::PAGE_SIZE + 2, &objects[1]);
+    EXPECT_EQ(order_index.find(Index::PAGE_SIZE + 2), &objects[1]);
+    order_index.erase(Index::PAGE_SIZE + 2);
+    EXPECT_EQ(order_index.find(Index::PAGE_SIZE + 2), nullptr);
+    EXPECT_EQ(order_index.find(1), &objects[0]);
+    EXPECT_EQ(order_index.find(2 * Index::PAGE_SIZE + 1), &objects[2]);
+    EXPECT_EQ(order_index.size(), 2);
+}
+
+// Test case 29: Test that the order hash table finds and erases orders while it moves them to a larger table
+TEST(OrderHashTableTest, GrowsWhileErasing) {
+    OrderHashTable<uint64_t> table;
+    std::vector<uint64_t> objects(100000);
+    // Erase older orders as the table grows, so that erases land on entries in both tables
+    // while entries are being moved between them.
+    auto erased = [&](uint64_t i) { return i % 2 == 0 && i < objects.size() / 2; };
+    for (uint64_t i = 0; i < objects.size(); ++i)
+    {
+        table.insert(i * 7919, &objects[i]);
+        if (i % 4 == 1)
+        {
+            table.erase((i / 2) * 7919);
+            EXPECT_EQ(table.find((i / 2) * 7919), nullptr);
+        }
+    }
+    EXPECT_EQ(table.size(), objects.size() - objects.size() / 4);
+    for (uint64_t i = 0; i < objects.size(); ++i)
+        EXPECT_EQ(table.find(i * 7919), erased(i) ? nullptr : &objects[i]);
+    uint64_t num_objects = 0;
+    table.forEach([&](uint64_t *) { ++num_objects; });
+    EXPECT_EQ(num_objects, table.size());
+
+    for (uint64_t i = 0; i < objects.size(); ++i)
+    {
+        if (!erased(i))
+            table.erase(i * 7919);
+    }
+    EXPECT_TRUE(table.empty());
+    table.insert(1, &objects[0]);
+    EXPECT_EQ(table.find(1), &objects[0]);
+}
+
+// Test case 30: Test that an asynchronous event handler publishes events in the order they were raised
+TEST(AsyncEventHandlerTest, PublishesInOrder) {
+    auto trade_handler = std::make_unique<TradeEventHandler>();
+    TradeEventHandler *downstream = trade_handler.get();
+    auto async_handler = std::make_unique<AsyncEventHandler>(std::move(trade_handler), EventRingConfig{4});
+    AsyncEventHandler *event_handler = async_handler.get();
+    Market market{std::move(async_handler)};
+    market.addSymbol(1, "BTC-USDT");
+    for (uint64_t order_id = 1; order_id <= 8; ++order_id)
+        market.addOrder(Order::limitAskOrder(order_id, 1, 100 + order_id, 10, OrderTimeInForce::GTC));
+    market.addOrder(Order::marketBidOrder(9, 1, 25, OrderTimeInForce::IOC));
+    event_handler->flush();
+
+    ASSERT_EQ(downstream->symbol_added_events.size(), 1);
+    EXPECT_EQ(downstream->symbol_added_events.front().name, "BTC-USDT");
+    ASSERT_EQ(downstream->order_added_events.size(), 9);
+    for (uint64_t order_id = 1; order_id <= 8; ++order_id)
+    {
+        EXPECT_EQ(downstream->order_added_events.front().order, Order::limitAskOrder(order_id, 1, 100 + order_id, 10, OrderTimeInForce::GTC));
+        downstream->order_added_events.pop();
+    }
+    EXPECT_EQ(downstream->order_added_events.front().order.getOrderID(), 9);
+    ASSERT_EQ(downstream->trade_events.size(), 3);
+    downstream->trade_events.pop();
+    downstream->trade_events.pop();
+    EXPECT_EQ(downstream->trade_events.front().passive_id, 3);
+    EXPECT_EQ(downstream->trade_events.front().quantity, 5);
+    EXPECT_EQ(downstream->trade_events.front().passive_open_quantity, 5);
+    ASSERT_EQ(downstream->order_deleted_events.size(), 3);
+    EXPECT_EQ(downstream->order_deleted_events.back().order.getOrderID(), 9);
+    EXPECT_EQ(downstream->order_deleted_events.back().order.getExecutedQuantity(), 25);
+
+    EventRingMetrics metrics = event_handler->getMetrics();
+    EXPECT_EQ(metrics.capacity, 4);
+    EXPECT_EQ(metrics.published_events, 16);
+    EXPECT_EQ(metrics.overflowed_events + metrics.shed_events, 0);
+}
+
+// Test case 31: Test the overflow and shed policies of an asynchronous event handler whose ring is full
+TEST(AsyncEventHandlerTest, FullRingPolicies) {
+    for (FullRingPolicy policy : {FullRingPolicy::Overflow, FullRingPolicy::Shed})
+    {
+        auto gated_handler = std::make_unique<GatedEventHandler>();
+        GatedEventHandler *downstream = gated_handler.get();
+        AsyncEventHandler event_handler{std::move(gated_handler), EventRingConfig{4, policy}};
+        MapOrderBook book{1, event_handler};
+        book.addOrder(Order::limitBidOrder(1, 1, 100, 10, OrderTimeInForce::GTC));
+        while (!downstream->entered)
+            std::this_thread::yield();
+        // The publisher is holding the first event, so four events fill the ring and the
+        // rest find it full.
+        for (uint64_t order_id = 2; order_id <= 9; ++order_id)
+            book.addOrder(Order::limitBidOrder(order_id, 1, 100, 10, OrderTimeInForce::GTC));
+        EventRingMetrics metrics = event_handler.getMetrics();
+        EXPECT_EQ(metrics.occupancy, 4);
+        EXPECT_EQ(metrics.blocked_events, 0);
+        downstream->open = true;
+        event_handler.flush();
+
+        metrics = event_handler.getMetrics();
+        EXPECT_EQ(metrics.max_occupancy, 4);
+        std::vector<uint64_t> expected_ids;
+        if (policy == FullRingPolicy::Overflow)
+        {
+            expected_ids = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+            EXPECT_EQ(metrics.overflowed_events, 4);
+            EXPECT_EQ(metrics.shed_events, 0);
+        }
+        else
+        {
+            expected_ids = {1, 2, 3, 4, 5};
+            EXPECT_EQ(metrics.overflowed_events, 0);
+            EXPECT_EQ(metrics.shed_events, 4);
+        }
+        EXPECT_EQ(downstream->order_ids, expected_ids);
+        EXPECT_EQ(metrics.published_events, expected_ids.size());
+    }
+}
+
+// An event handler that records the IDs of added orders, yielding to the thread that raises them.
+class YieldingEventHandler : public EventHandler
+{
+public:
+    std::vector<uint64_t> order_ids;
+
+protected:
+    void handleOrderAdded(const OrderAdded &event) override {
+        order_ids.push_back(event.order.getOrderID());
+        std::this_thread::yield();
+    }
+};
+
+// Test case 32: Test that the overflow policy keeps events in order while the publisher drains the overflow buffer
+TEST(AsyncEventHandlerTest, OverflowKeepsOrderWhileDraining) {
+    constexpr uint64_t NUM_ORDERS = 2000;
+    for (int run = 0; run < 20; ++run)
+    {
+        auto yielding_handler = std::make_unique<YieldingEventHandler>();
+        YieldingEventHandler *downstream = yielding_handler.get();
+        AsyncEventHandler event_handler{std::move(yielding_handler), EventRingConfig{2, FullRingPolicy::Overflow}};
+        MapOrderBook book{1, event_handler};
+        for (uint64_t order_id = 1; order_id <= NUM_ORDERS; ++order_id)
+        {
+            book.addOrder(Order::limitBidOrder(order_id, 1, 100, 10, OrderTimeInForce::GTC));
+            if (order_id % 3 == 0)
+                std::this_thread::yield();
+        }
+        event_handler.flush();
+
+        ASSERT_EQ(downstream->order_ids.size(), NUM_ORDERS);
+        for (uint64_t i = 0; i < NUM_ORDERS; ++i)
+            ASSERT_EQ(downstream->order_ids[i], i + 1) << "run " << run;
+    }
+}
+
+// Test case 33: Test that events serialize to the JSON schema the Kafka event handler publishes
+TEST(EventSerializerTest, JsonAndBinary) {
+    TradeEventHandler event_handler;
+    MapOrderBook book{7, event_handler};
+    book.addOrder(Order::limitAskOrder(1, 7, 18446744073709551614ULL, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitAskOrder(2, 7, 100, 10, OrderTimeInForce::GTC));
+    book.addOrder(Order::limitBidOrder(3, 7, 90, 4, OrderTimeInForce::GTC));
+    book.addOrder(Order::marketBidOrder(12345678901, 7, 6, OrderTimeInForce::IOC));
+
+    EventSerializer serializer;
+    EXPECT_EQ(serializer.serialize(event_handler.order_added_events.front()),
+        "{\"data\":{\"executed_quantity\":0,\"last_executed_price\":0,\"last_executed_quantity\":0,\"open_quantity\":10,"
+        "\"order_id\":1,\"price\":18446744073709551614,\"quantity\":10,\"side\":\"Ask\",\"symbol_id\":7,\"type\":\"Limit\"},"
+        "\"event_type\":\"OrderAdded\"}");
+    event_handler.order_added_events.pop();
+    event_handler.order_added_events.pop();
+    EXPECT_EQ(serializer.serialize(OrderUpdated{event_handler.order_added_events.front().order}),
+        "{\"data\":{\"executed_quantity\":0,\"last_executed_price\":0,\"last_executed_quantity\":0,\"open_quantity\":4,"
+        "\"order_id\":3,\"price\":90,\"quantity\":4,\"side\":\"Bid\",\"symbol_id\":7,\"type\":\"Limit\"},"
+        "\"event_type\":\"OrderUpdated\"}");
+    ASSERT_EQ(event_handler.order_deleted_events.size(), 1);
+    EXPECT_EQ(serializer.serialize(event_handler.order_deleted_events.front()),
+        "{\"data\":{\"executed_quantity\":6,\"last_executed_price\":100,\"last_executed_quantity\":6,\"open_quantity\":0,"
+        "\"order_id\":12345678901,\"price\":18446744073709551615,\"quantity\":6,\"side\":\"Bid\",\"symbol_id\":7,"
+        "\"type\":\"Market\"},\"event_type\":\"OrderDeleted\"}");
+    ASSERT_EQ(event_handler.trade_events.size(), 1);
+    const Trade &trade = event_handler.trade_events.front();
+    EXPECT_EQ(serializer.serialize(trade),
+        "{\"data\":{\"aggressor_id\":12345678901,\"aggressor_open_quantity\":0,\"aggressor_side\":\"Bid\",\"passive_id\":2,"
+        "\"passive_open_quantity\":4,\"price\":100,\"quantity\":6,\"symbol_id\":7,\"trade_seq\":1},\"event_type\":\"Trade\"}");
+    EXPECT_EQ(serializer.key(12345678901), "12345678901");
+    EXPECT_EQ(serializer.key(0), "0");
+
+    EventSerializer binary_serializer{EventFormat::Binary};
+    std::string_view binary = binary_serializer.serialize(trade);
+    ASSERT_EQ(binary.size(), BINARY_EVENT_SIZE);
+    EXPECT_EQ(static_cast<uint8_t>(binary[0]), BINARY_EVENT_MAGIC);
+    EXPECT_EQ(static_cast<EventType>(binary[1]), EventType::Trade);
+    EXPECT_EQ(static_cast<OrderSide>(binary[2]), OrderSide::Bid);
+    EXPECT_EQ(binary.substr(4, 4), std::string_view("\x07\x00\x00\x00", 4));
+    // The aggressor ID follows the symbol ID and the trade sequence number.
+    EXPECT_EQ(binary.substr(16, 8), std::string_view("\x35\x1c\xdc\xdf\x02\x00\x00\x00", 8));
+    EXPECT_EQ(binary.substr(56, 8), std::string_view("\x04\x00\x00\x00\x00\x00\x00\x00", 8));
+}
+
+// Test case 34: Test that a file message producer waits in poll until there is a delivery to report
+TEST(FileMessageProducerTest, PollWaitsForDeliveries) {
+    const std::string path = ::testing::TempDir() + "file_message_producer_test";
+    FileMessageProducer producer{path};
+    int delivered = 0;
+    producer.setDeliveryCallback([&delivered](void *, bool success) { delivered += success; });
+    auto start = std::chrono::steady_clock::now();
+    producer.poll(20);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    EXPECT_EQ(delivered, 0);
+
+    std::thread writer{[&producer] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        producer.produce("key", "payload", nullptr);
+    }};
+    // Poll returns as soon as the message is written instead of waiting for the timeout.
+    start = std::chrono::steady_clock::now();
+    producer.poll(60000);
+    writer.join();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(30));
+    EXPECT_EQ(delivered, 1);
+    start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(producer.flush(60000));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(30));
+}
+
+// Test case 35: Test that a batching event handler batches events and recycles the buffers of delivered batches
+TEST(BatchingEventHandlerTest, BatchesAndRecyclesBuffers) {
+    const std::string path = ::testing::TempDir() + "batching_event_handler_test";
+    BatchConfig config;
+    config.max_batch_events = 3;
+    config.max_batch_delay = std::chrono::hours(1);
+    // Fewer buffers than batches, so that batches can only be sent once buffers are recycled.
+    config.max_in_flight_batches = 2;
+    config.batch_key = "worker-0";
+    {
+        auto batching_handler = std::make_unique<BatchingEventHandler>(std::make_unique<FileMessageProducer>(path), config);
+        BatchingEventHandler *event_handler = batching_handler.get();
+        Market market{std::move(batching_handler)};
+        market.addSymbol(1, "BTC-USDT");
+        for (uint64_t order_id = 1; order_id <= 20; ++order_id)
+            market.addOrder(Order::limitAskOrder(order_id, 1, 100 + order_id, 10, OrderTimeInForce::GTC));
+        EXPECT_EQ(event_handler->getMetrics().produced_messages, 6);
+        event_handler->flush();
+        BatchMetrics metrics = event_handler->getMetrics();
+        EXPECT_EQ(metrics.batched_events, 20);
+        EXPECT_EQ(metrics.produced_messages, 7);
+        EXPECT_EQ(metrics.failed_messages, 0);
+    }
+
+    auto messages = FileMessageProducer::readMessages(path);
+    ASSERT_EQ(messages.size(), 7);
+    EventSerializer serializer;
+    uint64_t order_id = 1;
+    for (const auto &[key, payload] : messages)
+    {
+        EXPECT_EQ(key, "worker-0");
+        std::string expected;
+        for (size_t i = 0; i < config.max_batch_events && order_id <= 20; ++i, ++order_id)
+        {
+            if (!expected.empty())
+                expected += '\n';
+            expected += serializer.serialize(OrderAdded{Order::limitAskOrder(order_id, 1, 100 + order_id, 10, OrderTimeInForce::GTC)});
+        }
+        EXPECT_EQ(payload, expected);
+    }
+}
+
+// Test case 36: Test that a batching event handler sends single events keyed by order ID and sends batches that are due
+TEST(BatchingEventHandlerTest, SingleEventsAndDelayedBatches) {
+    const std::string path = ::testing::TempDir() + "batching_event_handler_test";
+    BatchConfig config;
+    config.max_batch_events = 1;
+    config.trade_events = true;
+    {
+        BatchingEventHandler event_handler{std::make_unique<FileMessageProducer>(path), config};
+        MapOrderBook book{1, event_handler};
+        book.addOrder(Order::limitAskOrder(42, 1, 100, 10, OrderTimeInForce::GTC));
+        book.addOrder(Order::limitBidOrder(43, 1, 100, 4, OrderTimeInForce::GTC));
+    }
+    // Every event is sent on its own, keyed by its order ID, and trades by the ID of the aggressor.
+    auto messages = FileMessageProducer::readMessages(path);
+    ASSERT_EQ(messages.size(), 4);
+    EXPECT_EQ(messages[0].first, "42");
+    EXPECT_EQ(messages[0].second.find('\n'), std::string::npos);
+    for (size_t i = 1; i < messages.size(); ++i)
+        EXPECT_EQ(messages[i].first, "43");
+
+    config.max_batch_events = 64;
+    config.max_batch_delay = std::chrono::milliseconds(1);
+    config.batch_key = "worker-1";
+    {
+        BatchingEventHandler event_handler{std::make_unique<FileMessageProducer>(path), config};
+        MapOrderBook book{1, event_handler};
+        book.addOrder(Order::limitAskOrder(44, 1, 100, 10, OrderTimeInForce::GTC));
+        // The batch is not full, so it is only sent once it has waited long enough.
+        for (int i = 0; i < 1000 && event_handler.getMetrics().produced_messages == 0; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        EXPECT_EQ(event_handler.getMetrics().produced_messages, 1);
+    }
+    messages = FileMessageProducer::readMessages(path);
+    ASSERT_EQ(messages.size(), 1);
+    EXPECT_EQ(messages[0].first, "worker-1");
+}
+
+// A test event handler that opts in to execution reports.
+class ReportEventHandler : public TradeEventHandler
+{
+public:
+    std::vector<ExecutionReport> reports;
+
+protected:
+    [[nodiscard]] bool handlesExecutionReports() const override {
+        return true;
+    }
+    void handleExecutionReport(const ExecutionReport &event) override {
+        reports.push_back(event);
+    }
+};
+
+// Test case 37: Test that orderbooks raise a single execution report for each command
+TEST(ExecutionReportTest, CoalescesCommands) {
+    auto submit_orders = [](auto &target) {
+        target.addOrder(Order::limitBidOrder(1, 1, 101, 1, OrderTimeInForce::GTC));
+        target.addOrder(Order::limitAskOrder(2, 1, 101, 1, OrderTimeInForce::GTC));
+        target.addOrder(Order::limitBidOrder(3, 1, 100, 1, OrderTimeInForce::GTC));
+        target.addOrder(Order::limitBidOrder(4, 1, 99, 1, OrderTimeInForce::GTC));
+        target.addOrder(Order::limitBidOrder(5, 1, 98, 1, OrderTimeInForce::GTC));
+        target.addOrder(Order::stopAskOrder(6, 1, 100, 1, OrderTimeInForce::IOC));
+        target.addOrder(Order::stopAskOrder(7, 1, 99, 1, OrderTimeInForce::IOC));
+        target.addOrder(Order::marketAskOrder(8, 1, 1, OrderTimeInForce::IOC));
+        target.addOrder(Order::limitAskOrder(10, 1, 105, 1, OrderTimeInForce::GTC));
+        target.addOrder(Order::limitBidOrder(11, 1, 106, 3, OrderTimeInForce::GTC));
+    };
+    ReportEventHandler event_handler;
+    MapOrderBook book{1, event_handler};
+    submit_orders(book);
+    EXPECT_TRUE(event_handler.order_added_events.empty());
+    EXPECT_TRUE(event_handler.order_deleted_events.empty());
+    EXPECT_TRUE(event_handler.trade_events.empty());
+    ASSERT_EQ(event_handler.reports.size(), 10);
+
+    // The filled resting order is described by the fill alone.
+    const ExecutionReport &crossing_report = event_handler.reports[1];
+    ASSERT_EQ(crossing_report.orders.size(), 1);
+    EXPECT_EQ(crossing_report.orders[0].order.getOrderID(), 2);
+    EXPECT_FALSE(crossing_report.orders[0].resting);
+    ASSERT_EQ(crossing_report.fills.size(), 1);
+    EXPECT_EQ(crossing_report.fills[0].passive_id, 1);
+    EXPECT_TRUE(event_handler.reports[5].orders[0].resting);
+
+    // The market order and the stop orders it triggers are reported together.
+    const ExecutionReport &cascade_report = event_handler.reports[7];
+    ASSERT_EQ(cascade_report.orders.size(), 3);
+    ASSERT_EQ(cascade_report.fills.size(), 3);
+    for (size_t i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(cascade_report.orders[i].order.getOrderID(), std::vector<uint64_t>({8, 6, 7})[i]);
+        EXPECT_FALSE(cascade_report.orders[i].resting);
+        EXPECT_EQ(cascade_report.orders[i].order.getExecutedQuantity(), 1);
+        EXPECT_EQ(cascade_report.fills[i].aggressor_id, cascade_report.orders[i].order.getOrderID());
+        EXPECT_EQ(cascade_report.fills[i].passive_id, 3 + i);
+        EXPECT_EQ(cascade_report.fills[i].price, 100 - i);
+    }
+    EXPECT_EQ(cascade_report.orders[1].order.getType(), OrderType::Market);
+
+    // The residual of a partly filled order is reported once it rests.
+    EventSerializer serializer;
+    EXPECT_EQ(serializer.serialize(event_handler.reports[9]),
+        "{\"data\":{\"fills\":[{\"aggressor_id\":11,\"aggressor_open_quantity\":2,\"aggressor_side\":\"Bid\",\"passive_id\":10,"
+        "\"passive_open_quantity\":0,\"price\":105,\"quantity\":1,\"symbol_id\":1,\"trade_seq\":5}],\"orders\":[{\"order\":"
+        "{\"executed_quantity\":1,\"last_executed_price\":105,\"last_executed_quantity\":1,\"open_quantity\":2,\"order_id\":11,"
+        "\"price\":106,\"quantity\":3,\"side\":\"Bid\",\"symbol_id\":1,\"type\":\"Limit\"},\"resting\":true}],\"symbol_id\":1},"
+        "\"event_type\":\"ExecutionReport\"}");
+
+    // Reports are reassembled in order after crossing the ring of an asynchronous handler.
+    auto report_handler = std::make_unique<ReportEventHandler>();
+    ReportEventHandler *downstream = report_handler.get();
+    auto async_handler = std::make_unique<AsyncEventHandler>(std::move(report_handler), EventRingConfig{4});
+    AsyncEventHandler *publisher = async_handler.get();
+    Market market{std::move(async_handler)};
+    market.addSymbol(1, "BTC-USDT");
+    submit_orders(market);
+    publisher->flush();
+    ASSERT_EQ(downstream->symbol_added_events.size(), 1);
+    ASSERT_EQ(downstream->reports.size(), event_handler.reports.size());
+    EventSerializer async_serializer;
+    for (size_t i = 0; i < downstream->reports.size(); ++i)
+        EXPECT_EQ(async_serializer.serialize(downstream->reports[i]), serializer.serialize(event_handler.reports[i]));
+}
+
+// Test case 38: Test that a batching event handler sends execution reports that do not fit in a buffer
+TEST(BatchingEventHandlerTest, OversizedExecutionReports) {
+    const std::string path = ::testing::TempDir() + "batching_event_handler_test";
+    BatchConfig config;
+    config.max_batch_events = 1;
+    config.execution_reports = true;
+    {
+        BatchingEventHandler event_handler{std::make_unique<FileMessageProducer>(path), config};
+        MapOrderBook book{1, event_handler};
+        book.addOrder(Order::limitBidOrder(1, 1, 101, 1, OrderTimeInForce::GTC));
+        book.addOrder(Order::limitAskOrder(2, 1, 101, 1, OrderTimeInForce::GTC));
+        book.addOrder(Order::limitBidOrder(3, 1, 100, 1, OrderTimeInForce::GTC));
+        book.addOrder(Order::limitBidOrder(4, 1, 99, 1, OrderTimeInForce::GTC));
+        book.addOrder(Order::stopAskOrder(5, 1, 100, 1, OrderTimeInForce::IOC));
+        book.addOrder(Order::marketAskOrder(6, 1, 1, OrderTimeInForce::IOC));
+    }
+    // The last report does not fit in a buffer, so it is sent from a copy of its own.
+    auto messages = FileMessageProducer::readMessages(path);
+    ASSERT_EQ(messages.size(), 6);
+    EXPECT_EQ(messages[5].first, "6");
+    EXPECT_GT(messages[5].second.size(), EventSerializer::MAX_EVENT_SIZE + 1);
+    EventSerializer serializer;
+    ExecutionReport report{1};
+    report.orders.push_back(OrderReport{Order::limitBidOrder(1, 1, 101, 1, OrderTimeInForce::GTC), true});
+    EXPECT_EQ(messages[0].second, serializer.serialize(report));
+}
+
+// Test case 39: Test that binary commands encode and decode, and that malformed commands are rejected
+TEST(BinaryCommandTest, EncodeAndDecode) {
+    BinaryCommand command{BinaryOperation::AddOrder, OrderSide::Ask, OrderType::Limit, OrderTimeInForce::IOC, 3, 0x0102030405060708, 1005, 200};
+    char buffer[BINARY_COMMAND_SIZE];
+    command.encode(buffer);
+    EXPECT_EQ(static_cast<uint8_t>(buffer[0]), BINARY_COMMAND_MAGIC);
+    // Fields are little-endian.
+    EXPECT_EQ(buffer[16], 0x08);
+    EXPECT_EQ(buffer[23], 0x01);
+    ASSERT_TRUE(BinaryCommand::isBinary(buffer, sizeof(buffer)));
+    EXPECT_FALSE(BinaryCommand::isBinary("{\"operation\":\"ADD_ORDER\"}", 25));
+
+    BinaryCommand decoded{};
+    ASSERT_TRUE(BinaryCommand::decode(buffer, sizeof(buffer), decoded));
+    EXPECT_EQ(decoded.operation, BinaryOperation::AddOrder);
+    EXPECT_EQ(decoded.side, OrderSide::Ask);
+    EXPECT_EQ(decoded.order_type, OrderType::Limit);
+    EXPECT_EQ(decoded.time_in_force, OrderTimeInForce::IOC);
+    EXPECT_EQ(decoded.symbol_id, 3);
+    EXPECT_EQ(decoded.order_id, 0x0102030405060708);
+    EXPECT_EQ(decoded.price, 1005);
+    EXPECT_EQ(decoded.quantity, 200);
+
+    // Truncated commands and out of range enumerations are rejected.
+    EXPECT_FALSE(BinaryCommand::decode(buffer, sizeof(buffer) - 1, decoded));
+    buffer[1] = 3;
+    EXPECT_FALSE(BinaryCommand::decode(buffer, sizeof(buffer), decoded));
+    buffer[1] = static_cast<char>(BinaryOperation::CancelOrder);
+    buffer[2] = 2;
+    EXPECT_FALSE(BinaryCommand::decode(buffer, sizeof(buffer), decoded));
+}